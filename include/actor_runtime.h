@@ -0,0 +1,185 @@
+#pragma once
+
+// Requires C++20; only the env_actors target is built with it (see CMakeLists.txt)
+#include "eval_broker.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Coroutine runtime for running thousands of games on a few threads.
+//
+// Each game loop is written as an Actor coroutine (observe, co_await an action,
+// step). A fixed pool of scheduler threads resumes actors from a shared ready
+// queue. An actor that awaits a batched network evaluation or an LLM reply is
+// suspended and costs no thread until the result arrives. Then whichever thread
+// delivers it puts the actor back on the queue.
+//
+//   Actor play(ActorRuntime& rt, EvaluationBroker& broker, ...) {
+//       while (!done) {
+//           float value = co_await rt.evaluate(broker, obs, mask, logits);
+//           ...
+//       }
+//   }
+//   rt.spawn(play(rt, broker, ...));
+//   rt.wait();
+
+class ActorRuntime;
+
+// Coroutine type of an actor. Actors start when spawned and their frames are freed when
+// they finish. An exception escaping an actor is rethrown by ActorRuntime::wait().
+class Actor {
+public:
+    struct promise_type {
+        ActorRuntime* runtime = nullptr;
+        std::exception_ptr error;
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            void await_suspend(std::coroutine_handle<promise_type> handle) noexcept;
+            void await_resume() noexcept {}
+        };
+
+        Actor get_return_object() { return Actor(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    Actor(Actor&& other) noexcept : handle(other.handle) { other.handle = nullptr; }
+    Actor& operator=(Actor&&) = delete;
+    ~Actor() {
+        if (handle) handle.destroy();  // never spawned
+    }
+
+private:
+    explicit Actor(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+    std::coroutine_handle<promise_type> handle;
+    friend class ActorRuntime;
+};
+
+struct ActorRuntimeConfig {
+    int num_threads = 0;  // scheduler threads; 0 = std::thread::hardware_concurrency()
+    int poll_us = 200;    // how often pending futures are checked
+};
+
+struct ActorRuntimeStats {
+    uint64_t spawned = 0;
+    uint64_t finished = 0;
+    uint64_t resumes = 0;  // times an actor was run by a scheduler thread
+};
+
+class ActorRuntime {
+public:
+    explicit ActorRuntime(const ActorRuntimeConfig& config = ActorRuntimeConfig{});
+    // Stops the threads. Call wait() first: actors still suspended are not resumed.
+    ~ActorRuntime();
+    ActorRuntime(const ActorRuntime&) = delete;
+    ActorRuntime& operator=(const ActorRuntime&) = delete;
+
+    // Queues an actor to start on a scheduler thread. Thread-safe, also from actors.
+    void spawn(Actor actor);
+
+    // Blocks until every spawned actor has finished, then rethrows the first exception
+    // an actor raised (if any)
+    void wait();
+
+    // Puts a suspended coroutine back on the ready queue. Callable from any thread.
+    void schedule(std::coroutine_handle<> handle);
+
+    int get_num_threads() const { return static_cast<int>(threads.size()); }
+    ActorRuntimeStats get_stats() const;
+
+    // co_await rt.yield(): lets other ready actors run first
+    auto yield() {
+        struct Awaiter {
+            ActorRuntime& runtime;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { runtime.schedule(handle); }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{*this};
+    }
+
+    // co_await rt.evaluate(broker, observation, mask, logits) -> value. The request joins
+    // the broker's next batch; the actor resumes once the batch has been evaluated.
+    auto evaluate(EvaluationBroker& broker, const float* observation, const uint8_t* mask, float* logits) {
+        struct Awaiter {
+            ActorRuntime& runtime;
+            EvaluationBroker& broker;
+            const float* observation;
+            const uint8_t* mask;
+            float* logits;
+            float value = 0.0f;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) {
+                // The actor may resume on another thread before submit() returns, so the
+                // awaiter is not touched afterwards
+                ActorRuntime* rt = &runtime;
+                broker.submit(observation, mask, logits, &value, [rt, handle] { rt->schedule(handle); });
+            }
+            float await_resume() const noexcept { return value; }
+        };
+        return Awaiter{*this, broker, observation, mask, logits};
+    }
+
+    // co_await rt.await_future(future) -> the future's value, e.g. an
+    // AsyncLLMConnector::suggest_move reply. Ready futures do not suspend; pending ones
+    // are polled every poll_us by a watcher thread.
+    template <typename T>
+    auto await_future(std::future<T>& future) {
+        struct Awaiter {
+            ActorRuntime& runtime;
+            std::future<T>& future;
+            bool await_ready() const {
+                return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+            }
+            void await_suspend(std::coroutine_handle<> handle) {
+                std::future<T>* f = &future;
+                runtime.watch([f] { return f->wait_for(std::chrono::seconds(0)) == std::future_status::ready; },
+                              handle);
+            }
+            T await_resume() { return future.get(); }
+        };
+        return Awaiter{*this, future};
+    }
+
+private:
+    struct Watch {
+        std::function<bool()> ready;
+        std::coroutine_handle<> handle;
+    };
+
+    ActorRuntimeConfig config;
+
+    mutable std::mutex mutex;
+    std::condition_variable ready_cv;  // wakes scheduler threads
+    std::condition_variable idle_cv;   // wakes wait()
+    std::deque<std::coroutine_handle<>> ready;
+    uint64_t live = 0;
+    bool stopping = false;
+    std::exception_ptr first_error;
+    ActorRuntimeStats stats;
+    std::vector<std::thread> threads;
+
+    std::mutex watch_mutex;
+    std::condition_variable watch_cv;
+    std::vector<Watch> watches;
+    bool stop_watching = false;
+    std::thread watcher;
+
+    void watch(std::function<bool()> ready_fn, std::coroutine_handle<> handle);
+    void finished(std::exception_ptr error);
+    void run_scheduler();
+    void run_watcher();
+
+    friend struct Actor::promise_type;
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "environment.h"
+#include "inference.h"
+#include "line_evaluator.h"
+#include "rng.h"
+#include "tablebase.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+// A move-selection policy used by the league and evaluation code.
+//
+// act() decides for a group of games at once, so network-backed agents can batch
+// their forward pass. Every environment passed in has this agent to move. Agents may
+// keep scratch state and are not thread-safe; each worker thread plays with its own
+// clone().
+class Agent {
+public:
+    virtual ~Agent() = default;
+
+    // rngs[i] is the random stream for envs[i]'s current decision
+    virtual void act(const Environment* const* envs, RngStream* rngs, int count, int32_t* actions) = 0;
+    virtual std::unique_ptr<Agent> clone() const = 0;
+};
+
+// Uniformly random legal moves
+class RandomAgent : public Agent {
+public:
+    void act(const Environment* const* envs, RngStream* rngs, int count, int32_t* actions) override;
+    std::unique_ptr<Agent> clone() const override { return std::make_unique<RandomAgent>(); }
+};
+
+// Moves from a PolicyNetwork, either sampled from the masked softmax or greedy
+class PolicyAgent : public Agent {
+public:
+    PolicyAgent(std::shared_ptr<const PolicyNetwork> network, bool greedy = false);
+
+    void act(const Environment* const* envs, RngStream* rngs, int count, int32_t* actions) override;
+    std::unique_ptr<Agent> clone() const override;
+
+private:
+    std::shared_ptr<const PolicyNetwork> network;
+    PolicyNetwork local;  // private copy: forward() uses scratch buffers
+    bool greedy;
+
+    std::vector<float> observations;
+    std::vector<uint8_t> masks;
+    std::vector<float> logits;
+    std::vector<float> values;
+};
+
+// Depth-limited negamax with alpha-beta pruning. With max_depth < 0 the search is
+// exhaustive and results are memoised per position, which is practical up to 4x4.
+// At the depth limit positions are scored by open lines, kept up to date move by move
+// in a LineEvaluator rather than recounted at every leaf. Equal-valued moves are
+// chosen at random so repeated games differ.
+class SolverAgent : public Agent {
+public:
+    explicit SolverAgent(int max_depth = -1) : max_depth(max_depth) {}
+
+    void act(const Environment* const* envs, RngStream* rngs, int count, int32_t* actions) override;
+    std::unique_ptr<Agent> clone() const override { return std::make_unique<SolverAgent>(max_depth); }
+
+private:
+    int max_depth;
+    std::unordered_map<std::string, int> memo;  // exact values of solved positions, by board
+    std::unique_ptr<LineEvaluator> lines;        // depth-limited searches only, follows `board`
+
+    int negamax(std::vector<int8_t>& board, int N, int player, int empty, int depth, int alpha, int beta);
+};
+
+// Perfect play from a precomputed tablebase: wins fastest, otherwise draws, otherwise
+// loses slowest. Each legal reply is looked up, and equally good moves are chosen at
+// random so repeated games differ. The table is shared read-only between clones.
+class TablebaseAgent : public Agent {
+public:
+    explicit TablebaseAgent(std::shared_ptr<const MappedTablebase> table);
+
+    void act(const Environment* const* envs, RngStream* rngs, int count, int32_t* actions) override;
+    std::unique_ptr<Agent> clone() const override { return std::make_unique<TablebaseAgent>(table); }
+
+private:
+    std::shared_ptr<const MappedTablebase> table;
+};
+
+// Monte Carlo tree search (UCT) with uniformly random rollouts
+class MCTSAgent : public Agent {
+public:
+    explicit MCTSAgent(int iterations = 400, float exploration = 1.4f)
+        : iterations(iterations), exploration(exploration) {}
+
+    void act(const Environment* const* envs, RngStream* rngs, int count, int32_t* actions) override;
+    std::unique_ptr<Agent> clone() const override { return std::make_unique<MCTSAgent>(iterations, exploration); }
+
+private:
+    struct Node {
+        int move;         // move that led here (-1 at the root)
+        int parent;
+        int first_child;  // children are contiguous once expanded
+        int num_children;
+        int visits;
+        float value;      // summed results from the view of the player who made `move`
+        int8_t terminal;  // 0 ongoing, 1 `move` won the game, 2 draw
+    };
+
+    int iterations;
+    float exploration;
+    std::vector<Node> nodes;  // reused across decisions
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Bump-pointer arena. Allocation is a pointer increment inside the current block;
+// memory is released all at once by reset(), which keeps the blocks for reuse so a
+// recorder that is reset every batch stops allocating after the first few batches.
+class Arena {
+public:
+    explicit Arena(size_t block_size = 1 << 16) : block_size(block_size), block(0), offset(0), used(0) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // `align` must be a power of two
+    void* allocate(size_t bytes, size_t align = alignof(std::max_align_t)) {
+        while (block < blocks.size()) {
+            if (void* p = bump(blocks[block], bytes, align)) {
+                return p;
+            }
+            ++block;  // try the next retained block
+            offset = 0;
+        }
+        // Oversized requests get a block of their own
+        const size_t size = bytes + align > block_size ? bytes + align : block_size;
+        blocks.push_back(Block{std::unique_ptr<uint8_t[]>(new uint8_t[size]), size});
+        block = blocks.size() - 1;
+        offset = 0;
+        return bump(blocks[block], bytes, align);
+    }
+
+    template <typename T>
+    T* allocate_array(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void reset() {
+        block = 0;
+        offset = 0;
+        used = 0;
+    }
+
+    size_t bytes_used() const { return used; }
+    size_t bytes_reserved() const {
+        size_t total = 0;
+        for (const Block& b : blocks) total += b.size;
+        return total;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<uint8_t[]> data;
+        size_t size;
+    };
+
+    size_t block_size;
+    std::vector<Block> blocks;
+    size_t block;   // index of the block being filled
+    size_t offset;  // first free byte in that block
+    size_t used;    // bytes handed out since the last reset
+
+    void* bump(const Block& b, size_t bytes, size_t align) {
+        const uintptr_t base = reinterpret_cast<uintptr_t>(b.data.get());
+        const size_t start = ((base + offset + align - 1) & ~(static_cast<uintptr_t>(align) - 1)) - base;
+        if (start + bytes > b.size) {
+            return nullptr;
+        }
+        offset = start + bytes;
+        used += bytes;
+        return b.data.get() + start;
+    }
+};
@@ -0,0 +1,243 @@
+#pragma once
+
+#include "environment.h"
+#include "feature_planes.h"
+#include "rng.h"
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+
+// Outcome codes written per environment after each step
+enum : int8_t {
+    OUTCOME_ONGOING = 0,
+    OUTCOME_PLAYER1_WIN = 1,
+    OUTCOME_PLAYER2_WIN = -1,
+    OUTCOME_DRAW = 2
+};
+
+// What BatchedEnvironment::try_step does with an invalid action
+enum class InvalidActionPolicy {
+    Reject,          // leave the environment as it was: reward 0, not done
+    PenalizeAndEnd,  // end the episode as a loss for the mover with the penalty reward
+    Resample         // play a uniformly random legal move instead (recorded in get_actions());
+                     // rejected if the board has no empty cell
+};
+
+// get_actions() entry of an environment where try_step played no move (Reject,
+// PenalizeAndEnd, or Resample on a full board) instead of the invalid action
+constexpr int32_t kNoAction = -1;
+
+// Reward hook invoked once per batch step instead of once per environment.
+// Called after every action has been applied and before finished environments are
+// reset, so boards still show the terminal positions.
+class BatchRewardCallback {
+public:
+    // boards:   [B, N*N] cells after the move (0 empty, 1 player1, -1 player2)
+    // actions:  [B] actions just applied, kNoAction where try_step played no move
+    // outcomes: [B] OUTCOME_* codes
+    // rewards:  [B] prefilled with the per-environment RewardCallback values; overwrite in place
+    virtual void operator()(const int8_t* boards, const int32_t* actions, const int8_t* outcomes,
+                            int num_envs, int N, float* rewards) = 0;
+    virtual ~BatchRewardCallback() = default;
+};
+
+// A fixed-size batch of Environments that share one set of contiguous output buffers.
+// The buffers are owned here and stay at the same address for the lifetime of the
+// object, so callers (e.g. the Python bindings) can hold views on them.
+class BatchedEnvironment {
+public:
+    BatchedEnvironment(int num_envs, int N, std::shared_ptr<RewardCallback> reward_fn);
+
+    // Resets every environment and refreshes all buffers
+    void reset();
+
+    // Applies actions[i] to environment i. Rewards and dones describe the step just
+    // taken; environments that finished are reset immediately, so their observation
+    // and mask already show the fresh board for the next step. Every action is checked
+    // before any environment moves: an out-of-bounds or occupied cell throws
+    // std::invalid_argument and leaves the whole batch untouched. If the batch reward
+    // hook throws, finished environments are still reset before the exception propagates.
+    void step(const int32_t* actions);
+
+    // Non-throwing step: invalid actions are handled by the configured policy instead
+    // of raising, and statuses[i] reports what happened to action i (StepStatus codes;
+    // a resampled action keeps the status of the original). Returns the number of
+    // invalid actions. Exceptions from reward callbacks still propagate.
+    int try_step(const int32_t* actions);
+
+    // Policy for try_step. seed keys the resampling draws, which depend only on
+    // (seed, env, try_step call count).
+    void set_invalid_action_policy(InvalidActionPolicy policy, float penalty = -1.0f, uint64_t seed = 0);
+    InvalidActionPolicy get_invalid_action_policy() const { return invalid_policy; }
+
+    // Optional batch-level reward hook (nullptr to disable)
+    void set_batch_reward(std::shared_ptr<BatchRewardCallback> fn) { batch_reward = std::move(fn); }
+
+    // Symmetry augmentation: each time the observation and mask rows are written, every
+    // environment draws one of the 8 board symmetries and its rows are written already
+    // transformed (get_symmetries() reports the choice). Boards, actions and the
+    // environments themselves stay untransformed. Draws depend only on (seed, env,
+    // number of resets and steps). Takes effect at the next reset or step.
+    void set_symmetry_augmentation(bool enabled, uint64_t seed = 0);
+    bool get_symmetry_augmentation() const { return augment; }
+
+    // Adds a [B, P, N, N] feature-plane buffer (see feature_planes.h), written alongside the
+    // observations on every reset and step and under the same symmetry when augmenting.
+    // Reallocates the feature buffer, so set it before taking pointers to it.
+    void set_feature_config(const FeatureConfig& config);
+    int get_num_feature_planes() const { return num_planes; }  // 0 until configured
+
+    // Checkpointing. A snapshot holds the complete state of the batch: every environment
+    // (see Environment::write_snapshot), the reward, done, board, action, outcome, status
+    // and symmetry buffers, the try_step and symmetry counters with their RNG seeds, the
+    // invalid-action policy and the feature config. Observation, mask and feature rows
+    // are rebuilt on load rather than stored. Loading into a batch with the same number
+    // of environments and board size resumes bit-identically, and the buffers keep their
+    // addresses unless the number of feature planes changes. Reward callbacks are not
+    // included, nor are episodes recorded from the batch: save an EpisodeRecorder with
+    // its own save_snapshot() alongside.
+    std::vector<uint8_t> save_snapshot() const;
+    // Throws std::invalid_argument for a snapshot of a different batch or board size and
+    // std::runtime_error for a corrupt one; a failed load leaves the batch unchanged
+    void load_snapshot(const uint8_t* data, size_t size);
+    // The same snapshot as a file; std::runtime_error on IO errors
+    void save_checkpoint(const std::string& path) const;
+    void load_checkpoint(const std::string& path);
+
+    // Map [B, N*N] rows between the augmented frame of the current observations and the
+    // environments' own frame: transform_policies takes environment-frame targets (e.g.
+    // search visit counts) to the augmented frame, inverse_transform_policies takes
+    // network outputs back. Identity rows when augmentation is off.
+    void transform_policies(const float* in, float* out) const;
+    void inverse_transform_policies(const float* in, float* out) const;
+    // Actions chosen on the augmented observations, mapped to environment cells for step()
+    void inverse_transform_actions(const int32_t* in, int32_t* out) const;
+
+    int get_num_envs() const { return num_envs; }
+    int get_board_size() const { return N; }
+    const Environment& get_env(int i) const { return envs[i]; }
+
+    const float* get_observations() const { return observations.data(); }  // [B, 2, N, N]
+    const uint8_t* get_action_masks() const { return action_masks.data(); } // [B, N*N]
+    const float* get_rewards() const { return rewards.data(); }             // [B]
+    const uint8_t* get_dones() const { return dones.data(); }               // [B]
+    const int8_t* get_boards() const { return boards.data(); }              // [B, N*N] after the last move
+    const int32_t* get_actions() const { return actions.data(); }           // [B] last applied actions, or kNoAction
+    const int8_t* get_outcomes() const { return outcomes.data(); }          // [B] OUTCOME_* codes
+    const uint8_t* get_statuses() const { return statuses.data(); }         // [B] StepStatus codes from try_step
+    const uint8_t* get_symmetries() const { return symmetries.data(); }     // [B] transform of the current observations
+    const float* get_features() const { return features.data(); }           // [B, P, N, N] once configured
+
+private:
+    int num_envs;
+    int N;
+    std::vector<Environment> envs;
+
+    std::vector<float> observations;
+    std::vector<uint8_t> action_masks;
+    std::vector<float> rewards;
+    std::vector<uint8_t> dones;
+    std::vector<int8_t> boards;
+    std::vector<int32_t> actions;
+    std::vector<int8_t> outcomes;
+    std::vector<uint8_t> statuses;
+
+    std::shared_ptr<BatchRewardCallback> batch_reward;
+
+    InvalidActionPolicy invalid_policy = InvalidActionPolicy::Reject;
+    float invalid_penalty = -1.0f;
+    CounterRng resample_rng;
+    uint64_t try_step_count = 0;
+
+    bool augment = false;
+    CounterRng symmetry_rng;
+    uint64_t encode_count = 0;           // resets and steps, keys the symmetry draws
+    std::vector<uint8_t> symmetries;
+    std::vector<int32_t> permutations;   // [kNumSymmetries, N*N] transform_cell tables
+
+    FeatureConfig feature_config;
+    int num_planes = 0;
+    std::vector<float> features;
+
+    // Fills the reward, done, action, outcome and board entries for environment i
+    void record_step(int i, int32_t action, float reward, bool done);
+    // Handles an invalid action for environment i according to the policy
+    void handle_invalid(int i);
+    // Batch reward hook, then resets and buffer refresh for every environment
+    void finish_step();
+    // Writes observation, mask and feature rows for environment i (under a fresh
+    // symmetry draw when augmenting)
+    void write_env_buffers(int i);
+    // Same rows under the symmetry already recorded in symmetries[i]
+    void write_env_rows(int i);
+};
+
+// A batch whose environments have different board sizes (e.g. 3, 5 and 10) in one
+// padded layout, so they share a single inference batch. Every buffer is laid out for
+// max_N: board n sits in the top-left n x n corner of each max_N x max_N plane, and
+// padding cells are 0 in the observations, action masks and boards. Actions use the
+// padded indexing too (row * max_N + col).
+//
+// Board sizes can change between iterations without touching the buffers: a new size
+// takes effect when that environment next resets. Each environment keeps one
+// Environment per size it has used, so after the first episode at a size, switching
+// back to it allocates nothing.
+class MixedBatchedEnvironment {
+public:
+    // Every environment starts at max_N
+    MixedBatchedEnvironment(int num_envs, int max_N, std::shared_ptr<RewardCallback> reward_fn);
+
+    // Requests board sizes (1..max_N, one per environment). Unfinished episodes keep
+    // their size; call reset() to apply the whole mix at once.
+    void set_board_sizes(const int32_t* sizes);
+
+    // Resets every environment at its requested size and refreshes all buffers
+    void reset();
+
+    // Applies actions[i] to environment i, then resets finished environments (switching
+    // them to their requested size). Every action is checked before any environment
+    // moves: a cell outside an environment's board or already occupied throws
+    // std::invalid_argument and leaves the whole batch untouched.
+    void step(const int32_t* actions);
+
+    int get_num_envs() const { return num_envs; }
+    int get_max_board_size() const { return max_N; }
+    const Environment& get_env(int i) const { return *envs[i]; }
+
+    const int32_t* get_board_sizes() const { return sizes.data(); }        // [B] sizes of the current boards
+    const uint8_t* get_cell_masks() const { return cell_masks.data(); }    // [B, max_N*max_N] 1 on the board
+    const float* get_observations() const { return observations.data(); } // [B, 2, max_N, max_N]
+    const uint8_t* get_action_masks() const { return action_masks.data(); } // [B, max_N*max_N]
+    const float* get_rewards() const { return rewards.data(); }             // [B]
+    const uint8_t* get_dones() const { return dones.data(); }               // [B]
+    const int8_t* get_boards() const { return boards.data(); }              // [B, max_N*max_N] after the last move
+    const int32_t* get_actions() const { return actions.data(); }           // [B] last applied actions, padded
+    const int8_t* get_outcomes() const { return outcomes.data(); }          // [B] OUTCOME_* codes
+
+private:
+    int num_envs;
+    int max_N;
+    std::shared_ptr<RewardCallback> reward_fn;
+    std::vector<std::unique_ptr<Environment>> pool;  // [B, max_N], size n at i * max_N + n - 1
+    std::vector<Environment*> envs;                  // the current Environment of each slot
+
+    std::vector<int32_t> sizes;
+    std::vector<int32_t> requested;
+    std::vector<int32_t> local_actions;  // actions in each environment's own indexing
+
+    std::vector<uint8_t> cell_masks;
+    std::vector<float> observations;
+    std::vector<uint8_t> action_masks;
+    std::vector<float> rewards;
+    std::vector<uint8_t> dones;
+    std::vector<int8_t> boards;
+    std::vector<int32_t> actions;
+    std::vector<int8_t> outcomes;
+
+    // Resets environment i at its requested size
+    void reset_env(int i);
+    // Writes observation and mask rows for environment i
+    void write_env_buffers(int i);
+};
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "environment.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Differential fuzzing of game engines against the reference Environment::step.
+//
+// Every engine under test plays the same random games in lockstep with the reference.
+// After each step the board (before any auto-reset), done flag, reward and the action
+// mask for the next move are compared game by game. A diverging game is replayed alone
+// and shrunk to a short action sequence that still diverges. Since engines keep state
+// across episodes, a sequence runs from a freshly built engine and may span several
+// games.
+//
+//   DifferentialFuzzer fuzzer;
+//   fuzzer.add_builtin_targets();
+//   DiffFuzzReport report = fuzzer.run();
+//   for (const Divergence& d : report.divergences) std::cerr << d.describe() << "\n";
+
+// Engine under test: num_games games stepped together, with auto-reset of finished
+// games as in BatchedEnvironment
+class FuzzEngine {
+public:
+    virtual ~FuzzEngine() = default;
+    // Starts every game from an empty board
+    virtual void reset() = 0;
+    // Applies actions[i] to game i; every action is legal in the reference
+    virtual void step(const int32_t* actions) = 0;
+    virtual const int8_t* boards() const = 0;   // [B, N*N] after the last move
+    virtual const uint8_t* dones() const = 0;   // [B]
+    virtual const float* rewards() const = 0;   // [B]
+    virtual const uint8_t* masks() const = 0;   // [B, N*N] legal moves for the next step
+};
+
+using FuzzEngineFactory =
+    std::function<std::unique_ptr<FuzzEngine>(int num_games, int N, std::shared_ptr<RewardCallback> reward_fn)>;
+
+struct FuzzTarget {
+    std::string name;
+    FuzzEngineFactory make;
+};
+
+// Every fast path in the tree: the allocation-free Environment variants and the batched,
+// mixed-size and sharded environments
+std::vector<FuzzTarget> builtin_fuzz_targets();
+
+// The reference engine, Environment::step on one Environment per game
+std::unique_ptr<FuzzEngine> make_reference_engine(int num_games, int N, std::shared_ptr<RewardCallback> reward_fn);
+
+// Stateless reward that hashes the board and the action, so an engine that calls the
+// callback with the wrong board or at the wrong time shows up as a reward mismatch.
+// Safe to call from several threads.
+class FuzzReward : public RewardCallback {
+public:
+    float operator()(const BoardState& state, const Action& action) override;
+};
+
+struct Divergence {
+    std::string engine;
+    int N = 0;
+    std::vector<int32_t> actions;  // one game slot from a fresh engine; the last move diverges
+    int original_length = 0;       // moves before minimization
+    std::string field;             // "board", "done", "reward", "mask" or "exception"
+    int cell = -1;                 // first differing cell for board and mask
+    std::string expected;
+    std::string actual;
+
+    std::string describe() const;
+};
+
+struct DiffFuzzConfig {
+    std::vector<int> board_sizes = {3, 4, 5};  // cycled round by round
+    int num_games = 256;                      // games per engine, stepped in lockstep
+    int steps_per_round = 256;                // engines are rebuilt every round, bounding replays
+    int rounds = 6;
+    uint64_t seed = 0;
+    bool minimize = true;
+    int max_replays = 20000;  // replay budget per minimization
+};
+
+struct DiffFuzzReport {
+    uint64_t steps = 0;        // game steps compared, summed over engines
+    uint64_t games = 0;        // games finished by the reference
+    double seconds = 0.0;
+    std::vector<Divergence> divergences;  // at most one per engine; a diverged engine is dropped
+
+    double steps_per_second() const { return seconds > 0.0 ? steps / seconds : 0.0; }
+    double games_per_second() const { return seconds > 0.0 ? games / seconds : 0.0; }
+};
+
+class DifferentialFuzzer {
+public:
+    explicit DifferentialFuzzer(const DiffFuzzConfig& config = DiffFuzzConfig{});
+
+    void add_target(FuzzTarget target);
+    void add_builtin_targets();
+    int get_num_targets() const { return static_cast<int>(targets.size()); }
+
+    // Plays config.rounds rounds of random games through every target. Actions depend
+    // only on (seed, round, step, game), so a run is reproducible.
+    DiffFuzzReport run();
+
+    // Replays one game slot on a fresh engine and the reference and returns the first
+    // divergence, if any. Throws std::invalid_argument if an action is illegal in the
+    // reference.
+    std::optional<Divergence> replay(const FuzzTarget& target, int N, const std::vector<int32_t>& actions) const;
+
+    // Shrinks a divergence by deleting chunks of moves (delta debugging) while the
+    // remaining sequence is legal and still diverges
+    Divergence minimize(const FuzzTarget& target, const Divergence& divergence) const;
+
+private:
+    DiffFuzzConfig config;
+    std::vector<FuzzTarget> targets;
+    std::shared_ptr<RewardCallback> reward_fn;
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "batched_environment.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+// Local environment server for multi-process actors (Linux).
+//
+// A server process hosts one BatchedEnvironment per channel and exchanges actions and
+// results with client processes through a POSIX shared-memory segment. Each channel
+// has a ring of request/response slots; clients write actions straight into a slot and
+// read observations, masks, rewards and dones straight out of it. Signalling uses
+// futexes on counters in the shared segment, so an exchange is a few atomic operations
+// plus, when one side is idle, a single wake-up.
+
+struct ShmSegmentHeader;
+struct ShmChannelHeader;
+
+// Results of one request, pointing into the shared segment. Valid until the client
+// submits ring_slots further requests on the same channel.
+struct EnvStepView {
+    const float* observations;   // [B, 2, N, N]
+    const uint8_t* action_masks; // [B, N*N]
+    const float* rewards;        // [B]
+    const uint8_t* dones;        // [B]
+};
+
+class EnvServer {
+public:
+    // Creates the segment "/<name>". One channel per client process. Throws
+    // std::runtime_error if the segment already exists, so a second server cannot take
+    // over a live one's name. force unlinks an existing segment first, for clearing one
+    // left behind by a crashed server; clients still attached to it keep the old mapping.
+    EnvServer(const std::string& name, int num_channels, int envs_per_channel, int N, int ring_slots = 2,
+              bool force = false);
+    ~EnvServer();
+
+    EnvServer(const EnvServer&) = delete;
+    EnvServer& operator=(const EnvServer&) = delete;
+
+    // Processes requests until stop() is called (from another thread or a signal handler)
+    void serve();
+    // Processes every pending request once; returns the number handled
+    int poll();
+    void stop();
+
+private:
+    std::string name;
+    size_t segment_size;
+    uint8_t* base;
+    ShmSegmentHeader* header;
+    std::vector<std::unique_ptr<BatchedEnvironment>> envs;
+    std::vector<uint32_t> handled;  // requests completed per channel
+
+    void handle(int channel, uint32_t request);
+};
+
+class EnvClient {
+public:
+    // Attaches to the segment created by an EnvServer and claims `channel`
+    EnvClient(const std::string& name, int channel);
+    ~EnvClient();
+
+    EnvClient(const EnvClient&) = delete;
+    EnvClient& operator=(const EnvClient&) = delete;
+
+    int get_num_envs() const { return num_envs; }
+    int get_board_size() const { return N; }
+
+    // Pipelined interface: up to ring_slots requests may be in flight.
+    // submit_* returns a ticket; wait() blocks until that request is done and throws
+    // std::invalid_argument if it was rejected. A request's status is only reported by
+    // wait() on its own ticket, and only until ring_slots further submits reuse its slot.
+    uint32_t submit_step(const int32_t* actions);
+    uint32_t submit_reset();
+    EnvStepView wait(uint32_t ticket);
+
+    // Synchronous helpers. If any action in the row is invalid, wait() throws
+    // std::invalid_argument and none of the channel's environments were stepped.
+    EnvStepView step(const int32_t* actions) { return wait(submit_step(actions)); }
+    EnvStepView reset() { return wait(submit_reset()); }
+
+private:
+    size_t segment_size;
+    uint8_t* base;
+    ShmSegmentHeader* header;
+    ShmChannelHeader* channel_header;
+    int channel;
+    int num_envs;
+    int N;
+    int ring_slots;
+    uint32_t submitted;
+
+    uint32_t submit(uint32_t op, const int32_t* actions);
+    // Blocks until request `ticket` is done, whatever its status
+    void wait_done(uint32_t ticket);
+};
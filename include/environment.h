@@ -1,8 +1,10 @@
 #pragma once
 
+#include <array>
 #include <vector>
 #include <memory>
 #include <stdexcept>
+#include <cstdint>
 
 struct BoardState {
     std::vector<int> cells;
@@ -22,6 +24,13 @@ struct StepResult {
     bool done;
 };
 
+// Result of Environment::try_step
+enum class StepStatus : uint8_t {
+    Ok = 0,
+    OutOfBounds = 1,  // action index outside [0, N*N)
+    Occupied = 2      // target cell already taken
+};
+
 class RewardCallback {
 public:
     virtual float operator()(const BoardState& state, const Action& action) = 0;
@@ -40,16 +49,60 @@ public:
     Environment(int N, std::shared_ptr<RewardCallback> reward_fn);
     BoardState reset();
     StepResult step(const Action& action);
+    
+    // Allocation-free variants for steady-state loops: reset without returning a copy,
+    // and step into a caller-owned StepResult whose cell storage is reused
+    void reset_in_place();
+    void step(const Action& action, StepResult& out);
     std::vector<bool> get_action_mask() const;
     std::vector<float> get_flattened_state() const;
     
     // US2.2: One-Hot Encoding Option
     std::vector<float> get_one_hot_state() const;
     
+    // Read access for batched wrappers and bindings
+    const BoardState& get_state() const { return current_state; }
+    int get_current_player() const { return current_player; }
+    int get_winner() const { return winner; }  // 1 or -1 once a player has won, else 0
+    
+    // Recent moves, kept in a ring buffer of the last kMoveHistory cells for feature encoders
+    static constexpr int kMoveHistory = 8;
+    int get_move_count() const { return move_count; }
+    // Cell of the k-th most recent move (0 = the last one), or -1 if there is none
+    int get_recent_move(int k) const {
+        if (k < 0 || k >= kMoveHistory || k >= move_count) return -1;
+        return recent_moves[(move_count - 1 - k) % kMoveHistory];
+    }
+    
+    // Same transition as step() without building a StepResult; read the board via get_state()
+    void step_in_place(const Action& action, float& reward, bool& done);
+    
+    // Non-throwing variant: an invalid action leaves the environment untouched and is
+    // reported through the status (reward and done are then not written). Exceptions
+    // from the reward callback still propagate.
+    StepStatus try_step(const Action& action, float& reward, bool& done);
+    
+    // Buffer-writing variants of the state accessors for batched layouts
+    void write_action_mask(uint8_t* out) const;        // N*N bytes, 1 for empty cells
+    void write_one_hot_state(float* out) const;        // 2*N*N floats, [2, N, N]
+    void write_flattened_state(float* out) const;      // N*N floats, cell values
+    
+    // Checkpointing: everything the environment carries between steps (board, player to
+    // move, winner and recent moves) as kSnapshotHeaderBytes + N*N bytes in host byte
+    // order. The reward callback is not part of it.
+    static constexpr size_t kSnapshotHeaderBytes = 8 + 4 * kMoveHistory;
+    size_t snapshot_size() const { return kSnapshotHeaderBytes + current_state.cells.size(); }
+    void write_snapshot(uint8_t* out) const;
+    // Throws std::runtime_error if the bytes are not a valid snapshot for this board size
+    void read_snapshot(const uint8_t* in);
+    
 private:
     BoardState current_state;
     std::shared_ptr<RewardCallback> reward_fn;
     int current_player;  // 1 for player1, -1 for player2
+    int winner;          // 0 until a player completes a line
+    std::array<int, kMoveHistory> recent_moves;  // the next move goes to slot move_count % kMoveHistory
+    int move_count;      // moves since the last reset
     
     // Terminal detection helper methods
     bool check_win(const BoardState& state, int player) const;
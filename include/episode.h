@@ -0,0 +1,114 @@
+#pragma once
+
+#include "environment.h"
+#include "arena.h"
+
+#include <vector>
+#include <cstdint>
+
+// Compact episode storage. An episode is kept as its move sequence plus the reward of
+// each step: boards are not stored, since each one differs from the previous board by
+// exactly the move just played. Any intermediate BoardState is rebuilt on demand by
+// replaying moves, and ObservationIterator walks an episode producing observations
+// incrementally (one cell update per step).
+//
+// Storage per step is a uint16 move and a float reward; a 10x10 episode of 40 moves
+// takes 240 bytes instead of 40 BoardState copies.
+//
+// A game cut by EpisodeRecorder::flush() continues in the next batch as an episode that
+// starts mid-game: its history holds the moves stored in earlier batches, and replay
+// starts from the board they leave.
+
+// View of a recorded episode; points into the recorder's arena and stays valid until
+// the recorder is reset
+struct Episode {
+    int N;
+    int length;              // number of steps
+    bool finished;           // last step ended the game (its done flag is set)
+    const uint16_t* moves;   // [length] action indices
+    const float* rewards;    // [length]
+    int offset = 0;                      // moves played before this episode
+    const uint16_t* history = nullptr;   // [offset] those moves, replayed before moves
+
+    bool done_at(int t) const { return finished && t == length - 1; }
+
+    // Board after the history and the first t moves (0 <= t <= length)
+    BoardState state_at(int t) const;
+    // Same, written as cell values into out[N*N]
+    void write_state_at(int t, int* out) const;
+    // StepResult of step t, as Environment::step returned it
+    StepResult step_at(int t) const;
+    // Observations before every move, [length, 2, N, N] in get_one_hot_state() layout
+    void write_observations(float* out) const;
+};
+
+// Walks an episode's pre-move observations and action masks without replaying from
+// the start for each step
+class ObservationIterator {
+public:
+    explicit ObservationIterator(const Episode& episode);
+
+    bool at_end() const { return t >= episode.length; }
+    void next();
+    int step() const { return t; }
+    int action() const { return episode.moves[t]; }
+    const float* observation() const { return observation_buffer.data(); }  // [2, N, N]
+    const uint8_t* action_mask() const { return mask_buffer.data(); }      // [N*N]
+
+private:
+    const Episode& episode;
+    int t;
+    int player;
+    std::vector<float> observation_buffer;
+    std::vector<uint8_t> mask_buffer;
+};
+
+// Records episodes from num_envs parallel environments (e.g. one BatchedEnvironment).
+// Steps are staged per environment and copied into the arena, at their exact size,
+// when the episode ends. reset() rewinds the arena for the next batch; games still in
+// progress stay staged, so their next episode replays from the right board.
+class EpisodeRecorder {
+public:
+    EpisodeRecorder(int num_envs, int N, size_t arena_block_size = 1 << 16);
+
+    // One step of environment `env`; a done step completes its episode
+    void record(int env, int action, float reward, bool done);
+    // One step of every environment, from BatchedEnvironment buffers. A negative action
+    // (kNoAction, no move played) records nothing; if it is done, the game ends there and
+    // its moves are stored as an unfinished episode.
+    void record_batch(const int32_t* actions, const float* rewards, const uint8_t* dones);
+    // Stores the steps of every game still in progress since its last flush as an
+    // unfinished episode (e.g. at the end of a batch); the game continues from there
+    void flush();
+    // Drops all episodes but keeps games in progress; arena memory is kept for reuse
+    void reset();
+    // Same as reset() and also drops games in progress (e.g. after resetting the
+    // environments)
+    void clear();
+
+    // Checkpointing: the episodes stored so far and every game in progress, so a loaded
+    // recorder carries on where the saved one stopped (see BatchedEnvironment::save_snapshot
+    // for the environments themselves). Throws std::invalid_argument for a snapshot of a
+    // different batch or board size and std::runtime_error for a corrupt one; a failed
+    // load leaves the recorder unchanged. Loading invalidates earlier Episode views.
+    std::vector<uint8_t> save_snapshot() const;
+    void load_snapshot(const uint8_t* data, size_t size);
+
+    const std::vector<Episode>& get_episodes() const { return episodes; }
+    int get_num_envs() const { return num_envs; }
+    size_t get_arena_bytes() const { return arena.bytes_used(); }
+
+private:
+    int num_envs;
+    int N;
+    Arena arena;
+    std::vector<Episode> episodes;
+    std::vector<uint16_t> staged_moves;   // [num_envs, N*N]
+    std::vector<float> staged_rewards;    // [num_envs, N*N]
+    std::vector<int> staged_length;       // [num_envs]
+    std::vector<int> flushed_length;      // [num_envs] staged steps already stored by flush()
+
+    void commit(int env, bool finished);
+    // Copies an episode into the arena; moves holds its history followed by its own moves
+    void store(int offset, int length, bool finished, const uint16_t* moves, const float* rewards);
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "inference.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+// Gathers single-position network evaluations from many search threads (or coroutines)
+// into batched PolicyNetwork::forward calls.
+//
+// Requests queue up until max_batch of them are waiting or the oldest has waited
+// deadline_us, whichever comes first. A dedicated broker thread then copies them into
+// one [batch, 2, N, N] input, runs inference once, writes each result to its caller's
+// buffers and wakes the callers. Requests still queued when the broker is destroyed
+// are evaluated before it returns.
+
+struct EvalBrokerConfig {
+    int max_batch = 64;     // fire as soon as this many requests are queued
+    int deadline_us = 500;  // or when the oldest request has waited this long
+};
+
+struct EvalBrokerStats {
+    uint64_t requests = 0;
+    uint64_t batches = 0;
+    uint64_t full_batches = 0;  // fired by the size threshold rather than the deadline
+    double mean_batch() const { return batches ? static_cast<double>(requests) / batches : 0.0; }
+};
+
+class EvaluationBroker {
+public:
+    // The broker evaluates with its own copy of the network
+    EvaluationBroker(const PolicyNetwork& network, const EvalBrokerConfig& config = EvalBrokerConfig{});
+    ~EvaluationBroker();
+    EvaluationBroker(const EvaluationBroker&) = delete;
+    EvaluationBroker& operator=(const EvaluationBroker&) = delete;
+
+    // Blocks until the position has been evaluated in some batch.
+    // observation: [2, N, N]; mask: [N*N] legal moves, or nullptr to derive it from the
+    // observation; logits: [N*N] output. Returns the value. Thread-safe.
+    float evaluate(const float* observation, const uint8_t* mask, float* logits);
+
+    // Non-blocking variant: logits and *value are written later and on_done then runs on
+    // the broker thread, so it should only hand the result on (e.g. resume a coroutine).
+    // The observation and mask must stay valid until then.
+    void submit(const float* observation, const uint8_t* mask, float* logits, float* value,
+                std::function<void()> on_done);
+
+    int get_board_size() const { return N; }
+    const EvalBrokerConfig& get_config() const { return config; }
+    EvalBrokerStats get_stats() const;
+
+private:
+    struct Request {
+        const float* observation;
+        const uint8_t* mask;
+        float* logits;
+        float* value;
+        std::function<void()> on_done;  // asynchronous requests
+        bool* ready;                     // blocking requests, set under the lock
+        std::chrono::steady_clock::time_point queued;
+    };
+
+    PolicyNetwork network;
+    EvalBrokerConfig config;
+    int N;
+
+    mutable std::mutex mutex;
+    std::condition_variable queue_cv;  // wakes the broker thread
+    std::condition_variable done_cv;   // wakes blocking callers
+    std::deque<Request> pending;
+    bool stopping = false;
+    EvalBrokerStats stats;
+
+    // Broker-thread state: the batch being evaluated and its staging buffers
+    std::vector<Request> batch;
+    std::vector<float> inputs;
+    std::vector<uint8_t> masks;
+    std::vector<float> logits;
+    std::vector<float> values;
+    std::thread worker;
+
+    void enqueue(Request request);
+    void run();
+    void evaluate_batch();
+};
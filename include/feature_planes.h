@@ -0,0 +1,26 @@
+#pragma once
+
+#include "environment.h"
+
+#include <cstdint>
+
+// AlphaZero-style input planes, each N x N, in this order:
+//   own stones, opponent stones     relative to the player to move
+//   side to move (optional)         all 1 when Player 1 is to move, all 0 otherwise
+//   last-k moves (history planes)   plane j marks the (j+1)-th most recent move
+//   legal moves (optional)          1 on empty cells
+// History comes from the Environment's ring buffer of recent moves, so at most
+// Environment::kMoveHistory planes are available; missing moves leave planes empty.
+struct FeatureConfig {
+    bool side_to_move = true;
+    int history = 0;
+    bool legal_moves = true;
+};
+
+// Planes written per environment; throws std::invalid_argument for a bad history length
+int num_feature_planes(const FeatureConfig& config);
+
+// Writes num_feature_planes(config) planes for env to out ([P, N, N]). With a cell
+// permutation (see symmetry_permutation), cell c of every plane is written to perm[c].
+void write_feature_planes(const Environment& env, const FeatureConfig& config, float* out,
+                          const int32_t* perm = nullptr);
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <stdexcept>
+
+// Built-in CPU inference for the small policy/value networks used on these boards.
+// Observations use the [B, 2, N, N] layout produced by Environment::get_one_hot_state().
+
+enum class LayerType : uint32_t {
+    Dense = 0,    // fully connected: in_features -> out_features
+    Conv3x3 = 1   // 3x3 convolution, stride 1, zero padding 1, over the NxN board
+};
+
+enum class Activation : uint32_t {
+    None = 0,
+    ReLU = 1
+};
+
+// Weights are stored in PyTorch order so exported state_dicts can be written directly:
+//   Dense:   weights [out, in],          bias [out]
+//   Conv3x3: weights [out, in, 3, 3],    bias [out]
+// For Conv3x3, in/out are channel counts and activations are kept as [C, N, N].
+struct Layer {
+    LayerType type;
+    Activation activation;
+    int in;
+    int out;
+    std::vector<float> weights;
+    std::vector<float> bias;
+};
+
+// C[M, Ncols] (+)= A[M, K] * B[K, Ncols], all row-major and densely packed.
+// Cache-blocked over M/K/Ncols with a register-tiled micro-kernel.
+void sgemm(const float* A, const float* B, float* C, int M, int K, int Ncols, bool accumulate);
+
+class PolicyNetwork {
+public:
+    // trunk: any mix of Conv3x3 layers followed by Dense layers.
+    // policy_head: Dense -> N*N logits. value_head: Dense -> 1 (tanh applied).
+    PolicyNetwork(int N, std::vector<Layer> trunk, Layer policy_head, Layer value_head);
+
+    // Binary weight file, written and read in host byte order:
+    //   uint32 magic 'TTTN', uint32 version (1), uint32 N, uint32 trunk layer count,
+    //   then trunk layers, policy head and value head, each as
+    //   uint32 type, uint32 activation, uint32 in, uint32 out, float weights[], float bias[out]
+    static PolicyNetwork load(const std::string& path);
+    void save(const std::string& path) const;
+
+    int board_size() const { return N; }
+
+    // observations: [batch, 2, N, N]; mask: [batch, N*N] with 1 for legal moves,
+    // or nullptr to derive legality from the observation (both channels empty).
+    // logits: [batch, N*N], illegal moves set to -infinity; values: [batch].
+    void forward(const float* observations, const uint8_t* mask, int batch,
+                 float* logits, float* values);
+
+private:
+    struct PackedLayer {
+        LayerType type;
+        Activation activation;
+        int in;
+        int out;
+        std::vector<float> weights;  // [K, out] GEMM layout (K = in, or 9*in for Conv3x3)
+        std::vector<float> bias;
+    };
+
+    int N;
+    std::vector<Layer> trunk;
+    Layer policy_head;
+    Layer value_head;
+    std::vector<PackedLayer> packed;  // trunk + policy head + value head
+
+    // Scratch buffers reused across forward() calls
+    std::vector<float> act_a;
+    std::vector<float> act_b;
+    std::vector<float> columns;
+    std::vector<float> gemm_out;
+
+    void pack_layers();
+    void run_layer(const PackedLayer& layer, const float* input, int batch, float* output);
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "agent.h"
+#include "match_runner.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Self-play league: a pool of frozen policy snapshots and a scheduler that plays a
+// learner against opponents drawn from the pool, many games at a time on all cores.
+// Results are accumulated per ordered pair with atomic counters, so workers never
+// take a lock to record a game.
+
+enum class OpponentSampling {
+    Uniform,          // every other snapshot equally often
+    PrioritizedHard,  // weight (1 - p)^power, p = learner's win rate against the opponent
+    PrioritizedEven   // weight p * (1 - p): favours opponents of similar strength
+};
+
+struct LeagueConfig {
+    int N = 3;
+    int max_snapshots = 64;    // pool capacity; the result table is sized once for it
+    int num_threads = 0;       // 0 = hardware concurrency
+    int games_per_thread = 256;
+    OpponentSampling sampling = OpponentSampling::Uniform;
+    double pfsp_power = 2.0;   // exponent for PrioritizedHard
+    uint64_t seed = 0;
+};
+
+// Games between two snapshots, from the first one's point of view
+struct PairRecord {
+    uint64_t wins;
+    uint64_t losses;
+    uint64_t draws;
+
+    uint64_t games() const { return wins + losses + draws; }
+    // Draws count half; a (1, 2) prior keeps unplayed pairs at 0.5
+    double score() const { return (wins + 0.5 * draws + 1.0) / (games() + 2.0); }
+};
+
+class League {
+public:
+    explicit League(const LeagueConfig& config);
+
+    // Adds a frozen snapshot and returns its id. Not safe to call while run() is active.
+    int add_snapshot(std::shared_ptr<const Agent> agent, const std::string& name);
+    int get_num_snapshots() const { return static_cast<int>(snapshots.size()); }
+    const std::string& get_name(int id) const { return snapshots.at(id).name; }
+
+    // Plays num_games games of `learner` against sampled opponents, alternating who
+    // moves first. With no other snapshot in the pool the learner plays itself.
+    // Prioritized weights are taken once, from the results before the call, so a run's
+    // outcomes depend only on the seed and the earlier runs, not on the thread count;
+    // call run() in chunks to let priorities adapt.
+    void run(int learner, uint64_t num_games);
+
+    // Opponent for game `game` of `learner` under the configured scheme
+    int sample_opponent(int learner, uint64_t game) const;
+    // Sampling weight of each snapshot as an opponent for `learner` (sums to 1)
+    std::vector<double> opponent_distribution(int learner) const;
+
+    PairRecord get_record(int a, int b) const;
+    uint64_t get_total_games() const { return total_games.load(std::memory_order_relaxed); }
+
+private:
+    struct Snapshot {
+        std::string name;
+        std::shared_ptr<const Agent> agent;
+    };
+
+    // Counters for games with `row` as X and `col` as O, one cache line per pair
+    struct alignas(64) PairCounters {
+        std::atomic<uint64_t> first_wins{0};
+        std::atomic<uint64_t> second_wins{0};
+        std::atomic<uint64_t> draws{0};
+    };
+
+    LeagueConfig config;
+    CounterRng sampling_rng;
+    std::vector<Snapshot> snapshots;
+    std::unique_ptr<PairCounters[]> results;  // [max_snapshots, max_snapshots]
+    std::atomic<uint64_t> total_games{0};
+
+    int sample_from(const std::vector<double>& weights, int learner, uint64_t game) const;
+
+    PairCounters& counters(int first, int second) const {
+        return results[static_cast<size_t>(first) * config.max_snapshots + second];
+    }
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "environment.h"
+#include "batched_environment.h"
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+// Incremental open-line evaluation for large boards.
+//
+// Every run of K cells (rows, columns and diagonals; K = N is the Environment rule)
+// keeps the number of stones each player has in it. A line is open for a player while
+// the opponent has no stone in it. Placing or removing a stone touches only the lines
+// through that cell, and the score and per-count histograms are updated along the way,
+// so queries never rescan the board.
+//
+// The score matches SolverAgent's leaf evaluation: each line open for one side adds
+// (its stones)^2 for that side and subtracts the same for the other.
+class LineEvaluator {
+public:
+    explicit LineEvaluator(int N, int K = 0);
+
+    // Empty board
+    void reset();
+    // Rebuilds the counts from a board
+    void sync(const BoardState& state);
+
+    // A stone of `player` (1 or -1) arrives on / leaves an empty / occupied cell.
+    // O(lines through the cell); the caller guarantees the cell's state.
+    void place(int cell, int player);
+    void remove(int cell, int player);
+
+    // Open-line score from `player`'s point of view
+    int score(int player) const { return player == 1 ? balance : -balance; }
+    // Lines open for `player` holding exactly `stones` of its stones (0..K)
+    int open_lines(int player, int stones) const { return open[side(player)][stones]; }
+    // Lines one stone short of a win for `player`
+    int threats(int player) const { return open_lines(player, K - 1); }
+    bool has_line(int player) const { return open_lines(player, K) > 0; }
+    // Stones of `player` in line l
+    int line_stones(int l, int player) const { return counts[side(player)][l]; }
+
+    int get_board_size() const { return N; }
+    int get_win_length() const { return K; }
+    int get_num_lines() const { return num_lines; }
+    // Cells of line l
+    const int* line_cells(int l) const { return cells_of_line.data() + l * K; }
+
+private:
+    int N;
+    int K;
+    int num_lines;
+    std::vector<int> cells_of_line;     // [num_lines, K]
+    std::vector<int> line_offsets;      // lines through cell c: through[line_offsets[c] .. line_offsets[c+1])
+    std::vector<int> through;
+    std::vector<uint8_t> counts[2];     // stones per line for player 1 and player -1
+    std::vector<int> open[2];           // open-line histogram by stone count, [K + 1]
+    int balance;                        // score for player 1
+
+    static int side(int player) { return player == 1 ? 0 : 1; }
+    // Score contribution of a line holding x stones of player 1 and o of player -1
+    static int contribution(int x, int o) { return (o == 0 ? x * x : 0) - (x == 0 ? o * o : 0); }
+    void update(int cell, int player, int delta);
+};
+
+// Potential-based shaping for batched training: each environment's reward gets
+// scale * (score after the move - score before), both from the mover's point of view.
+// One LineEvaluator per environment follows the boards through the actions, so the
+// hook costs O(lines through the cell) per environment and step. Environments are
+// assumed to start empty after reset(); call reset() alongside the batch.
+class LineShapingReward : public BatchRewardCallback {
+public:
+    LineShapingReward(int num_envs, int N, float scale, int K = 0);
+
+    void reset();
+
+    void operator()(const int8_t* boards, const int32_t* actions, const int8_t* outcomes,
+                    int num_envs, int N, float* rewards) override;
+
+private:
+    float scale;
+    std::vector<LineEvaluator> evaluators;
+    std::vector<int8_t> known;  // [num_envs, N*N] stones the evaluators have seen
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "environment.h"
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// US5.1 / US5.3: Non-blocking LLM move-suggestion connector.
+//
+// suggest_move() returns a future immediately. Pending positions are coalesced into
+// batched HTTP requests by a small pool of sender threads; the pool size bounds the
+// number of requests in flight. Answers are cached under the canonical (symmetry-
+// reduced) board, so a position and its rotations/reflections reach the model once.
+//
+// Wire format (POST to the endpoint, one request per batch):
+//   {"requests": [{"prompt": "...", "state": {"cells": [...], "N": 3}}, ...]}
+// and the reply, one text per request in the same order:
+//   {"responses": ["I would play 4", ...]}
+// The first integer in each text is taken as the suggested cell index.
+
+// Log2-bucketed latency histogram (microseconds). Safe to record from any thread.
+class LatencyHistogram {
+public:
+    static constexpr int kNumBuckets = 40;
+
+    void record(std::chrono::microseconds latency);
+    uint64_t count() const;
+    // Upper bound of the bucket holding the q-quantile (0 < q <= 1), in microseconds
+    uint64_t percentile(double q) const;
+    uint64_t get_bucket(int b) const { return buckets[b].load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> buckets[kNumBuckets] = {};
+};
+
+struct LLMConnectorConfig {
+    std::string endpoint = "http://localhost:5000/llm";
+    std::string prompt = "Suggest the best move for the player to move. Answer with a cell index.";
+    int max_batch_size = 16;       // positions per HTTP request
+    int max_batch_delay_ms = 5;    // how long a partial batch waits for company
+    int max_in_flight = 2;         // concurrent HTTP requests
+    int timeout_ms = 10000;        // per-request socket timeout
+    size_t max_cache_entries = 1 << 16;
+};
+
+struct LLMConnectorStats {
+    uint64_t requests;      // suggest_move() calls
+    uint64_t cache_hits;    // answered from the cache or joined an identical pending position
+    uint64_t batches_sent;  // HTTP requests issued
+    uint64_t errors;        // failed requests or unusable answers (a fallback move was returned)
+};
+
+class AsyncLLMConnector {
+public:
+    explicit AsyncLLMConnector(const LLMConnectorConfig& config);
+    ~AsyncLLMConnector();
+
+    AsyncLLMConnector(const AsyncLLMConnector&) = delete;
+    AsyncLLMConnector& operator=(const AsyncLLMConnector&) = delete;
+
+    // Suggested action for the player to move. Never throws for network or model
+    // failures: the future then holds the first legal move and the error is counted.
+    std::future<Action> suggest_move(const BoardState& state);
+
+    // Blocking helper (US5.3)
+    Action query_llm(const BoardState& state) { return suggest_move(state).get(); }
+
+    LLMConnectorStats get_stats() const;
+    // Time from suggest_move() to the answer being available
+    const LatencyHistogram& get_request_latency() const { return request_latency; }
+    // Round trip of each batched HTTP request
+    const LatencyHistogram& get_http_latency() const { return http_latency; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Waiter {
+        std::promise<Action> promise;
+        int symmetry;  // transform from the caller's board to the canonical board
+        std::vector<int> cells;  // caller's board, for the fallback move
+        Clock::time_point submitted;
+    };
+
+    // One distinct canonical position, queued or in flight, with everyone waiting on it
+    struct Pending {
+        uint64_t hash;
+        std::vector<int> canonical;
+        int N;
+        Clock::time_point enqueued;
+        std::vector<Waiter> waiters;
+    };
+
+    struct CacheEntry {
+        std::vector<int> canonical;
+        int action;  // in the canonical frame
+    };
+
+    LLMConnectorConfig config;
+    std::string host;
+    std::string port;
+    std::string path;
+
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping;
+    std::deque<std::shared_ptr<Pending>> queue;
+    std::unordered_map<uint64_t, std::shared_ptr<Pending>> outstanding;  // queued or in flight
+    std::unordered_multimap<uint64_t, CacheEntry> cache;
+    std::vector<std::thread> senders;
+
+    std::atomic<uint64_t> num_requests;
+    std::atomic<uint64_t> num_cache_hits;
+    std::atomic<uint64_t> num_batches;
+    std::atomic<uint64_t> num_errors;
+    LatencyHistogram request_latency;
+    LatencyHistogram http_latency;
+
+    void sender_loop();
+    void send_batch(const std::vector<std::shared_ptr<Pending>>& batch);
+    void resolve(Waiter& waiter, int canonical_action, int N);
+    const CacheEntry* find_cached(uint64_t hash, const std::vector<int>& canonical) const;
+};
+
+// Minimal HTTP/1.1 POST over a plain TCP socket; returns the response body.
+// Throws std::runtime_error on connection failure, timeout or a non-2xx status.
+std::string http_post(const std::string& host, const std::string& port, const std::string& path,
+                      const std::string& body, int timeout_ms);
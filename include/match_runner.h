@@ -0,0 +1,39 @@
+#pragma once
+
+#include "agent.h"
+#include "batched_environment.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+// Parallel game runner shared by the league and the evaluation tournament.
+//
+// Each worker thread keeps games_per_thread games in progress. On every turn it groups
+// the games by the agent to move and calls that agent once for the whole group, then
+// steps each game; finished games are reported and replaced by the next scheduled one.
+
+struct Match {
+    int first;   // index of the agent playing X (moves first)
+    int second;  // index of the agent playing O
+};
+
+struct MatchRunnerConfig {
+    int N = 3;
+    int num_threads = 0;          // 0 = std::thread::hardware_concurrency()
+    int games_per_thread = 256;   // concurrent games per worker
+    uint64_t seed = 0;            // agents' decision for game g, move t uses RngStream(seed, g + game_offset, t)
+    uint64_t game_offset = 0;     // lets repeated runs draw fresh streams
+};
+
+// schedule(game) picks the agents for game number `game` (0 .. num_games-1).
+// report(worker, game, match, outcome) receives OUTCOME_PLAYER1_WIN (first won),
+// OUTCOME_PLAYER2_WIN (second won) or OUTCOME_DRAW. Both are called concurrently from
+// worker threads; worker is in [0, num_threads).
+using MatchSchedule = std::function<Match(uint64_t game)>;
+using MatchReport = std::function<void(int worker, uint64_t game, const Match& match, int8_t outcome)>;
+
+// Plays num_games games and returns when all are reported. Returns the thread count used.
+int run_matches(const std::vector<std::shared_ptr<const Agent>>& agents, uint64_t num_games,
+                const MatchRunnerConfig& config, const MatchSchedule& schedule, const MatchReport& report);
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <array>
+
+// Counter-based random numbers (Philox4x32-10). Every draw is a pure function of
+// (seed, env index, step, draw index), so results do not depend on which thread
+// produced them or in what order. No per-generator state needs to be stored or seeded.
+
+using PhiloxBlock = std::array<uint32_t, 4>;
+
+// Draw indices reserved per consumer so two subsystems never read the same
+// block for the same (env, step)
+constexpr uint32_t kSamplerDraw = 0;
+constexpr uint32_t kResampleDraw = 1;
+constexpr uint32_t kSymmetryDraw = 2;
+constexpr uint32_t kFuzzDraw = 3;
+// RngStream reads draws from here on, leaving room below for new single-draw consumers
+constexpr uint32_t kFirstStreamDraw = 16;
+
+// One Philox4x32 block with 10 rounds
+inline PhiloxBlock philox4x32(PhiloxBlock ctr, std::array<uint32_t, 2> key) {
+    for (int round = 0; round < 10; ++round) {
+        const uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * ctr[0];
+        const uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * ctr[2];
+        ctr = {static_cast<uint32_t>(p1 >> 32) ^ ctr[1] ^ key[0], static_cast<uint32_t>(p1),
+               static_cast<uint32_t>(p0 >> 32) ^ ctr[3] ^ key[1], static_cast<uint32_t>(p0)};
+        key[0] += 0x9E3779B9u;
+        key[1] += 0xBB67AE85u;
+    }
+    return ctr;
+}
+
+// Uniform float in [0, 1) from the top 24 bits of a word
+inline float uint_to_uniform(uint32_t x) {
+    return static_cast<float>(x >> 8) * (1.0f / 16777216.0f);
+}
+
+class CounterRng {
+public:
+    explicit CounterRng(uint64_t seed = 0) : seed(seed) {}
+
+    uint64_t get_seed() const { return seed; }
+
+    // Four independent 32-bit words for (env, step, draw). draw indexes blocks, not words.
+    PhiloxBlock block(uint32_t env, uint64_t step, uint32_t draw = 0) const {
+        return philox4x32({draw, env, static_cast<uint32_t>(step), static_cast<uint32_t>(step >> 32)},
+                          {static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)});
+    }
+
+    float uniform(uint32_t env, uint64_t step, uint32_t draw = 0) const {
+        return uint_to_uniform(block(env, step, draw)[0]);
+    }
+
+    // Uniform integer in [0, n) (Lemire's multiply-shift; bias below 2^-32 * n)
+    uint32_t below(uint32_t n, uint32_t env, uint64_t step, uint32_t draw = 0) const {
+        return static_cast<uint32_t>((static_cast<uint64_t>(block(env, step, draw)[0]) * n) >> 32);
+    }
+
+    // Batched generation: out[i] = uniform(env_begin + i, step, draw) for i in [0, count).
+    // Lanes are processed in fixed-width groups so the rounds vectorize.
+    void fill_uniform(uint32_t env_begin, int count, uint64_t step, uint32_t draw, float* out) const;
+
+    // Batched raw words: out[4*i .. 4*i+3] = block(env_begin + i, step, draw)
+    void fill_blocks(uint32_t env_begin, int count, uint64_t step, uint32_t draw, uint32_t* out) const;
+
+private:
+    uint64_t seed;
+};
+
+// Sequential view of one (env, step) stream for code that needs several draws,
+// e.g. a search or an opponent policy. Cheap to create, holds no shared state.
+// Starts at kFirstStreamDraw, so it never repeats a reserved draw of the same seed.
+class RngStream {
+public:
+    RngStream(const CounterRng& rng, uint32_t env, uint64_t step)
+        : rng(rng), env(env), step(step), draw(kFirstStreamDraw), used(4) {}
+
+    uint32_t next_u32() {
+        if (used == 4) {
+            buffer = rng.block(env, step, draw++);
+            used = 0;
+        }
+        return buffer[used++];
+    }
+
+    float next_uniform() { return uint_to_uniform(next_u32()); }
+
+    uint32_t next_below(uint32_t n) {
+        return static_cast<uint32_t>((static_cast<uint64_t>(next_u32()) * n) >> 32);
+    }
+
+private:
+    CounterRng rng;
+    uint32_t env;
+    uint64_t step;
+    uint32_t draw;
+    int used;
+    PhiloxBlock buffer;
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include "rng.h"
+
+// Batched masked categorical sampling over [B, A] logits (A = N*N actions).
+
+// Seeds one 64-bit generator state per row from a base seed
+void seed_sampler_states(uint64_t seed, uint64_t* rng_states, int batch);
+
+// Fused masked softmax + sample + log-prob + entropy, one pass group per row.
+//   logits:     [batch, num_actions]
+//   mask:       [batch, num_actions], 1 = legal; nullptr treats -inf logits as illegal.
+//               With a mask, a legal -inf logit gets zero probability.
+//   rng_states: [batch], advanced in place
+//   actions:    [batch] sampled action index, -1 if a row has no legal action
+//   log_probs:  [batch] log-probability of the sampled action (may be nullptr)
+//   entropy:    [batch] entropy of the masked distribution (may be nullptr)
+void sample_masked_categorical(const float* logits, const uint8_t* mask, int batch, int num_actions,
+                               uint64_t* rng_states, int32_t* actions, float* log_probs, float* entropy);
+
+// Counter-based variant: row b draws its uniform from rng at (env_begin + b, step, kSamplerDraw),
+// so the sampled actions are identical however the batch is split across threads.
+void sample_masked_categorical(const float* logits, const uint8_t* mask, int batch, int num_actions,
+                               const CounterRng& rng, uint32_t env_begin, uint64_t step,
+                               int32_t* actions, float* log_probs, float* entropy);
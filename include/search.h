@@ -0,0 +1,114 @@
+#pragma once
+
+#include "agent.h"
+#include "environment.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+// Alpha-beta negamax for boards too large to solve exhaustively (N = 4..8).
+//
+// Positions are two 64-bit stone masks. Each search iteratively deepens from depth 1,
+// ordering moves by the transposition-table move, two killer moves per ply and a
+// history table. Nodes first check for an immediate win, a forced block or a double
+// threat before generating moves. Leaves are scored by open lines, like SolverAgent.
+//
+// The transposition table is shared by all search threads and is lock-free. Each slot
+// stores key ^ data next to data, so a slot torn by two concurrent writers fails the
+// key check and is treated as a miss. With num_threads > 1 the engine runs Lazy SMP:
+// helper threads search the same root on odd and even depths and fill the shared table.
+
+constexpr int kSearchWinScore = 30000;  // a win at ply p scores kSearchWinScore - p
+
+struct SearchConfig {
+    int num_threads = 1;              // Lazy-SMP threads, including the caller's
+    size_t tt_entries = size_t(1) << 20;  // rounded down to a power of two; 16 bytes each
+    int K = 0;                        // stones in a row needed to win; 0 = N (the Environment rule)
+};
+
+// Whichever limit is reached first ends the search. The first iteration always completes.
+struct SearchLimits {
+    int max_depth = 64;
+    int time_ms = 0;         // 0 = no time limit
+    uint64_t max_nodes = 0;  // 0 = no node limit
+};
+
+struct SearchResult {
+    int move = -1;
+    int score = 0;           // for the player to move; |score| > kSearchWinScore - 100 is a forced result
+    int depth = 0;           // deepest completed iteration
+    uint64_t nodes = 0;      // all threads
+    double seconds = 0.0;
+};
+
+class AlphaBetaEngine {
+public:
+    explicit AlphaBetaEngine(const SearchConfig& config = SearchConfig{});
+    AlphaBetaEngine(const AlphaBetaEngine&) = delete;
+    AlphaBetaEngine& operator=(const AlphaBetaEngine&) = delete;
+
+    // Best move for the player to move. Throws std::invalid_argument for finished games
+    // and boards over 64 cells.
+    SearchResult search(const Environment& env, const SearchLimits& limits);
+    SearchResult search(const BoardState& state, int player, const SearchLimits& limits);
+
+    // Ends a running search from another thread; it returns its last completed iteration
+    void stop() { stop_flag.store(true, std::memory_order_relaxed); }
+
+    // Forgets the transposition table contents
+    void clear();
+
+    const SearchConfig& get_config() const { return config; }
+
+private:
+    struct TTSlot {
+        std::atomic<uint64_t> check;  // key ^ data
+        std::atomic<uint64_t> data;   // score, depth, bound, move, generation
+    };
+    struct Worker;  // per-thread search state (move ordering tables, node count)
+
+    SearchConfig config;
+    std::unique_ptr<TTSlot[]> table;
+    uint64_t table_mask;
+    uint8_t generation = 0;
+    uint64_t zobrist[64][2];
+
+    // Geometry of the board being searched
+    int N = 0;
+    int K = 0;
+    uint64_t board_mask = 0;
+    std::vector<uint64_t> lines;
+
+    SearchLimits limits;
+    std::atomic<bool> stop_flag{false};
+    std::atomic<uint64_t> total_nodes{0};
+    std::chrono::steady_clock::time_point deadline;
+
+    void set_geometry(int N);
+    bool probe_table(uint64_t key, int ply, int& depth, int& score, int& bound, int& move) const;
+    void store_table(uint64_t key, int ply, int depth, int score, int bound, int move);
+};
+
+// Scripted opponent backed by its own single-threaded engine (clones get fresh engines)
+class AlphaBetaAgent : public Agent {
+public:
+    explicit AlphaBetaAgent(const SearchLimits& limits, const SearchConfig& config = default_config());
+
+    void act(const Environment* const* envs, RngStream* rngs, int count, int32_t* actions) override;
+    std::unique_ptr<Agent> clone() const override { return std::make_unique<AlphaBetaAgent>(limits, config); }
+
+    // Small table and one thread: cheap enough to run inside rollouts
+    static SearchConfig default_config() {
+        SearchConfig c;
+        c.tt_entries = size_t(1) << 16;
+        return c;
+    }
+
+private:
+    SearchLimits limits;
+    SearchConfig config;
+    AlphaBetaEngine engine;
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "environment.h"
+#include "batched_environment.h"
+
+#include <condition_variable>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+// Batched environment stepped by one worker thread per shard, laid out for multi-socket
+// hosts.
+//
+// The buffers have the same dense [B, ...] layout as BatchedEnvironment, but every
+// array starts on a 64-byte cache line and shards are whole multiples of
+// kShardGranularity environments. That makes each shard's slice of every array (down
+// to the one-byte dones) start on a cache line of its own, so two shards never write
+// the same line. The arrays are not touched when allocated: each worker zeroes its
+// own slices and builds its own Environments, so under Linux's default first-touch
+// policy the pages land on that worker's NUMA node. Only the page straddling a shard
+// boundary can end up remote. Workers can be pinned to CPUs, which keeps them, and so
+// their memory, on one node.
+//
+// Shards are never smaller than kShardGranularity environments, so a batch of fewer
+// than 2 * kShardGranularity (128) environments runs on a single worker thread.
+//
+// The per-environment RewardCallback is called concurrently from the worker threads.
+
+constexpr size_t kCacheLine = 64;
+constexpr int kShardGranularity = 64;  // environments; keeps byte-sized rows line-aligned
+
+struct ShardedEnvConfig {
+    int num_shards = 0;        // 0 = std::thread::hardware_concurrency(); at most one per kShardGranularity envs
+    bool pin_threads = false;  // pin shard s to cpus[s], or to the s-th CPU this process may use
+    std::vector<int> cpus;     // optional explicit CPU per shard (Linux)
+};
+
+// Cache-line-aligned array that is deliberately left untouched until first written
+template <typename T>
+class AlignedArray {
+public:
+    AlignedArray() = default;
+    explicit AlignedArray(size_t count) : count(count) {
+        // aligned_alloc wants a size that is a multiple of the alignment
+        const size_t bytes = (count * sizeof(T) + kCacheLine - 1) / kCacheLine * kCacheLine;
+        data_.reset(static_cast<T*>(std::aligned_alloc(kCacheLine, bytes > 0 ? bytes : kCacheLine)));
+        if (!data_) throw std::bad_alloc();
+    }
+    T* data() { return data_.get(); }
+    const T* data() const { return data_.get(); }
+    size_t size() const { return count; }
+
+private:
+    struct Free {
+        void operator()(T* p) const { std::free(p); }
+    };
+    std::unique_ptr<T, Free> data_;
+    size_t count = 0;
+};
+
+class ShardedBatchedEnvironment {
+public:
+    ShardedBatchedEnvironment(int num_envs, int N, std::shared_ptr<RewardCallback> reward_fn,
+                              const ShardedEnvConfig& config = ShardedEnvConfig{});
+    ~ShardedBatchedEnvironment();
+    ShardedBatchedEnvironment(const ShardedBatchedEnvironment&) = delete;
+    ShardedBatchedEnvironment& operator=(const ShardedBatchedEnvironment&) = delete;
+
+    // Same semantics as BatchedEnvironment::reset/step, with the shards working in
+    // parallel. Every action is checked against the action masks before any shard
+    // moves: an out-of-bounds or occupied cell throws std::invalid_argument and leaves
+    // the whole batch untouched. The first error from a shard worker is rethrown here.
+    void reset();
+    void step(const int32_t* actions);
+
+    int get_num_envs() const { return num_envs; }
+    int get_board_size() const { return N; }
+    const Environment& get_env(int i) const;
+
+    int get_num_shards() const { return static_cast<int>(shards.size()); }
+    int get_shard_begin(int s) const { return shards[s]->begin; }
+    int get_shard_end(int s) const { return shards[s]->end; }
+    int get_shard_cpu(int s) const { return shards[s]->cpu; }    // CPU the worker ran on at start-up
+    int get_shard_node(int s) const { return shards[s]->node; }  // its NUMA node (0 off Linux)
+
+    const float* get_observations() const { return observations.data(); }  // [B, 2, N, N]
+    const uint8_t* get_action_masks() const { return action_masks.data(); } // [B, N*N]
+    const float* get_rewards() const { return rewards.data(); }             // [B]
+    const uint8_t* get_dones() const { return dones.data(); }               // [B]
+    const int8_t* get_boards() const { return boards.data(); }              // [B, N*N] after the last move
+    const int8_t* get_outcomes() const { return outcomes.data(); }          // [B] OUTCOME_* codes
+
+private:
+    enum class Command { None, Reset, Step, Exit };
+
+    struct Shard {
+        int begin;
+        int end;
+        int cpu = -1;
+        int node = 0;
+        std::vector<Environment> envs;  // built by the worker, so allocated on its node
+        std::exception_ptr error;
+        std::thread thread;
+    };
+
+    int num_envs;
+    int N;
+    std::shared_ptr<RewardCallback> reward_fn;
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    AlignedArray<float> observations;
+    AlignedArray<uint8_t> action_masks;
+    AlignedArray<float> rewards;
+    AlignedArray<uint8_t> dones;
+    AlignedArray<int8_t> boards;
+    AlignedArray<int8_t> outcomes;
+
+    // Fork-join handshake between step()/reset() and the workers
+    std::mutex mutex;
+    std::condition_variable command_cv;
+    std::condition_variable done_cv;
+    Command command = Command::None;
+    uint64_t generation = 0;
+    int remaining = 0;
+    const int32_t* actions = nullptr;
+
+    void run_worker(Shard& shard, int requested_cpu);
+    void dispatch(Command cmd);
+    void initialize_shard(Shard& shard);
+    void reset_shard(Shard& shard);
+    void step_shard(Shard& shard);
+    void write_env_buffers(Shard& shard, int i);
+};
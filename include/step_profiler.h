@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Optional phase timing for Environment::step (build with -DTICTACTOE_PROFILE_STEP=ON).
+//
+// Each phase of a step is wrapped in a scoped timer that reads the TSC (steady_clock
+// off x86) and adds the elapsed ticks to counters owned by the calling thread, so
+// timing never contends across threads. get_step_profile() sums every thread's
+// counters. Without the option the scopes expand to nothing and the API reports zeros.
+
+enum class StepPhase : int {
+    Validation = 0,      // bounds and occupancy checks
+    Apply,               // writing the move
+    CheckWinCurrent,     // check_win for the player who moved
+    CheckWinOther,       // check_win for the opponent
+    BoardFull,           // is_board_full
+    RewardCallback,      // the user RewardCallback
+    ResultCopy,          // building the StepResult returned by step()
+    Count
+};
+
+constexpr int kNumStepPhases = static_cast<int>(StepPhase::Count);
+
+const char* step_phase_name(StepPhase phase);
+
+struct StepPhaseStats {
+    uint64_t calls;
+    uint64_t ticks;
+    double nanoseconds;  // ticks converted with the measured tick rate
+};
+
+struct StepProfile {
+    uint64_t steps;  // calls to Environment::try_step, directly or through step/step_in_place,
+                     // including rejected actions (counted before validation)
+    StepPhaseStats phases[kNumStepPhases];
+};
+
+constexpr bool step_profiling_enabled() {
+#ifdef TICTACTOE_PROFILE_STEP
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Totals over all threads, live and exited
+StepProfile get_step_profile();
+void reset_step_profile();
+// Table of calls, total time, time per call and share of the step per phase
+void dump_step_profile(std::ostream& out);
+
+namespace step_profiler_detail {
+
+inline uint64_t read_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+void record(int phase, uint64_t ticks);
+void count_step();
+
+class ScopedTimer {
+public:
+    explicit ScopedTimer(StepPhase phase) : phase(static_cast<int>(phase)), start(read_ticks()) {}
+    ~ScopedTimer() { record(phase, read_ticks() - start); }
+
+private:
+    int phase;
+    uint64_t start;
+};
+
+}  // namespace step_profiler_detail
+
+#ifdef TICTACTOE_PROFILE_STEP
+
+#define TICTACTOE_STEP_CONCAT_INNER(a, b) a##b
+#define TICTACTOE_STEP_CONCAT(a, b) TICTACTOE_STEP_CONCAT_INNER(a, b)
+#define TICTACTOE_STEP_SCOPE(phase) \
+    step_profiler_detail::ScopedTimer TICTACTOE_STEP_CONCAT(step_timer_, __LINE__)(phase)
+#define TICTACTOE_STEP_COUNT() step_profiler_detail::count_step()
+
+#else
+
+#define TICTACTOE_STEP_SCOPE(phase) ((void)0)
+#define TICTACTOE_STEP_COUNT() ((void)0)
+
+#endif
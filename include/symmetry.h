@@ -0,0 +1,36 @@
+#pragma once
+
+#include "environment.h"
+
+#include <vector>
+#include <cstdint>
+
+// The 8 symmetries of the square board (dihedral group D4).
+// Transform t applies an optional horizontal flip (t & 4) followed by
+// (t & 3) clockwise quarter turns.
+constexpr int kNumSymmetries = 8;
+
+// Where cell `index` ends up under transform t on an NxN board
+int transform_cell(int N, int t, int index);
+
+// Transform that undoes t
+inline int inverse_symmetry(int t) {
+    return t < 4 ? (4 - t) % 4 : t;  // reflections are their own inverse
+}
+
+// Permutation table: perm[i] = transform_cell(N, t, i)
+std::vector<int> symmetry_permutation(int N, int t);
+
+// dst[transform_cell(N, t, i)] = src[i]
+template <typename T>
+void apply_symmetry(const T* src, T* dst, int N, int t) {
+    for (int i = 0; i < N * N; ++i) {
+        dst[transform_cell(N, t, i)] = src[i];
+    }
+}
+
+// Transform that maps the board to its canonical (lexicographically smallest) form
+int canonical_symmetry(const BoardState& state);
+
+// 64-bit hash of a cell vector (not symmetry-aware; hash the canonical form for that)
+uint64_t hash_cells(const std::vector<int>& cells);
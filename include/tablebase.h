@@ -0,0 +1,161 @@
+#pragma once
+
+#include "environment.h"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Exact game values for every reachable position of a small board, computed by
+// retrograde analysis and stored as a flat table indexed by PositionIndexer.
+//
+// Positions are grouped into layers by stone count. Within layer s (X has ceil(s/2)
+// stones, O has floor(s/2)) a position is ranked by its X cells among all cells and its
+// O cells among the cells X left free, both in the combinatorial number system. The
+// index is dense: every slot is a legal stone configuration, with no gaps for
+// impossible counts as a base-3 encoding would have. 4x4 needs 10.2M slots; 5x5 needs
+// 1.6e11, beyond what the table can hold in memory.
+
+constexpr int kTablebaseMaxCells = 36;  // boards up to 6x6 fit the 64-bit cell masks
+
+class PositionIndexer {
+public:
+    explicit PositionIndexer(int N);
+
+    int board_size() const { return N; }
+    uint64_t size() const { return layer_offset[cells + 1]; }
+    uint64_t layer_begin(int stones) const { return layer_offset[stones]; }
+    uint64_t layer_end(int stones) const { return layer_offset[stones + 1]; }
+
+    // Index of the position with X on `x` and O on `o` (bit i = cell i). The stone
+    // counts must be consistent with X moving first.
+    uint64_t index(uint64_t x, uint64_t o) const;
+    // Inverse of index()
+    void position(uint64_t index, uint64_t& x, uint64_t& o) const;
+
+    // Same for a cell array (1 X, -1 O, 0 empty); throws std::invalid_argument for
+    // stone counts that cannot occur in a game
+    uint64_t index(const int* cells) const;
+
+private:
+    int N;
+    int cells;
+    std::vector<uint64_t> layer_offset;  // cells + 2 entries
+    uint64_t binomial[kTablebaseMaxCells + 1][kTablebaseMaxCells + 1];
+
+    // Combinatorial-number-system rank of a k-subset and its inverse
+    uint64_t rank(uint64_t set) const;
+    uint64_t unrank(uint64_t rank, int k) const;
+};
+
+// Game-theoretic outcome for the player to move
+enum class TablebaseOutcome : uint8_t {
+    Draw = 0,
+    Win = 1,
+    Loss = 2,
+    Unreachable = 3  // cannot occur in a game started from the empty board
+};
+
+// One table slot: outcome in the low 2 bits, plies to the end of the game under
+// optimal play (the winner hurries, the loser delays) in the upper 6; best move or
+// kNoMove at terminal and unreachable positions
+struct TablebaseEntry {
+    static constexpr uint8_t kNoMove = 0xFF;
+
+    uint8_t packed;
+    uint8_t move;
+
+    TablebaseOutcome outcome() const { return static_cast<TablebaseOutcome>(packed & 3); }
+    int distance() const { return packed >> 2; }
+};
+
+struct TablebaseConfig {
+    int N = 4;
+    int K = 0;                          // stones in a row needed to win; 0 = N (the Environment rule)
+    int num_threads = 0;                // 0 = std::thread::hardware_concurrency()
+    uint64_t max_positions = 1ull << 32; // refuse boards whose index is larger than this
+};
+
+// On-disk layout: this 64-byte header, then size() TablebaseEntry slots in index order.
+// Written in host byte order.
+struct TablebaseHeader {
+    uint32_t magic;      // 'TTTB'
+    uint32_t version;    // 1
+    uint32_t N;
+    uint32_t K;
+    uint64_t num_positions;
+    uint64_t num_reachable;
+    uint8_t reserved[32];
+};
+static_assert(sizeof(TablebaseHeader) == 64, "tablebase header must stay 64 bytes");
+
+class Tablebase {
+public:
+    // Enumerates the reachable positions and solves them, one layer at a time from the
+    // full board back to the empty one, with the slots of each layer split over threads.
+    // Throws std::invalid_argument for bad sizes or more than max_positions slots.
+    static Tablebase build(const TablebaseConfig& config);
+
+    // Throws std::runtime_error on IO errors or a file that is not a tablebase
+    static Tablebase load(const std::string& path);
+    void save(const std::string& path) const;
+
+    int get_board_size() const { return indexer.board_size(); }
+    int get_win_length() const { return K; }
+    uint64_t size() const { return entries.size(); }
+    uint64_t get_num_reachable() const { return num_reachable; }
+    const PositionIndexer& get_indexer() const { return indexer; }
+
+    const TablebaseEntry& at(uint64_t index) const { return entries[index]; }
+    // Entry for the board; throws std::invalid_argument on a size mismatch
+    const TablebaseEntry& probe(const BoardState& state) const;
+
+private:
+    Tablebase(int N, int K) : indexer(N), K(K) {}
+
+    PositionIndexer indexer;
+    int K;
+    uint64_t num_reachable = 0;
+    std::vector<TablebaseEntry> entries;
+};
+
+// Read-only view of a saved table, mapped straight from the file. Nothing is read up
+// front: the kernel faults pages in on the first lookup that touches them, so opening
+// a multi-megabyte table is instant and only the visited part is ever loaded. The
+// mapping is shared, so every process that maps the same file (or inherits it across
+// fork) uses one copy in the page cache. Lookups are const and thread-safe.
+class MappedTablebase {
+public:
+    // Throws std::runtime_error if the file cannot be mapped or is not a tablebase
+    explicit MappedTablebase(const std::string& path);
+
+    MappedTablebase(const MappedTablebase&) = delete;
+    MappedTablebase& operator=(const MappedTablebase&) = delete;
+
+    int get_board_size() const { return indexer.board_size(); }
+    int get_win_length() const { return static_cast<int>(header->K); }
+    uint64_t size() const { return header->num_positions; }
+    uint64_t get_num_reachable() const { return header->num_reachable; }
+    const PositionIndexer& get_indexer() const { return indexer; }
+
+    TablebaseEntry at(uint64_t index) const { return entries[index]; }
+    // Entry for the board; throws std::invalid_argument on a size mismatch
+    TablebaseEntry probe(const BoardState& state) const;
+
+private:
+    // Owns the mapping, so it is released even if a later member fails to initialize
+    struct Mapping {
+        explicit Mapping(const std::string& path);
+        ~Mapping();
+        Mapping(const Mapping&) = delete;
+        Mapping& operator=(const Mapping&) = delete;
+
+        const uint8_t* data;
+        size_t size;
+    };
+
+    Mapping mapping;
+    const TablebaseHeader* header;
+    PositionIndexer indexer;
+    const TablebaseEntry* entries;
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "agent.h"
+#include "match_runner.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Evaluation tournaments between registered agents, played with run_matches() on all
+// cores. Each board size is an independent event with its own ratings; the sizes run
+// concurrently. After every round the Elo ratings are refitted to all games so far
+// (Bradley-Terry maximum likelihood, draws counted as half a win) and the event stops
+// early once every rating's 95% confidence interval is narrow enough.
+
+enum class TournamentFormat {
+    RoundRobin,  // every pair meets every round
+    Swiss        // agents are paired with neighbours in the current standings
+};
+
+struct TournamentConfig {
+    std::vector<int> board_sizes = {3};
+    TournamentFormat format = TournamentFormat::RoundRobin;
+    int games_per_pairing = 20;   // per round, split evenly between colours
+    int max_rounds = 50;
+    double target_ci = 50.0;      // stop once every 95% interval is at most +/- this many Elo
+    int min_rounds = 2;
+    int num_threads = 0;          // 0 = hardware concurrency, shared between board sizes
+    int games_per_thread = 64;
+    uint64_t seed = 0;
+};
+
+struct Rating {
+    std::string name;
+    double elo;     // mean rating across the event is 1500
+    double ci95;    // half-width of the 95% confidence interval
+    uint64_t games;
+    double score;   // (wins + draws/2) / games
+};
+
+struct TournamentResult {
+    int N;
+    int rounds;      // rounds played
+    bool converged;  // stopped because target_ci was reached
+    std::vector<Rating> ratings;  // sorted best first
+};
+
+class Tournament {
+public:
+    explicit Tournament(const TournamentConfig& config);
+
+    // Registers an agent for the given board sizes (empty: all configured sizes)
+    void add_agent(const std::string& name, std::shared_ptr<const Agent> agent, std::vector<int> board_sizes = {});
+
+    // Plays every board size and returns one result per size, in config order
+    std::vector<TournamentResult> run();
+
+private:
+    struct Entry {
+        std::string name;
+        std::shared_ptr<const Agent> agent;
+        std::vector<int> board_sizes;
+    };
+
+    TournamentConfig config;
+    std::vector<Entry> entries;
+
+    TournamentResult run_event(int N, int num_threads) const;
+};
+
+// Fits Bradley-Terry ratings to a pairwise score table.
+//   score[i*n+j]: points i scored against j (win 1, draw 1/2); games[i*n+j]: games between i and j.
+// Returns Elo ratings centred on 1500 and writes 95% interval half-widths to ci95.
+std::vector<double> fit_elo(const std::vector<double>& score, const std::vector<double>& games, int n,
+                            std::vector<double>& ci95);
@@ -0,0 +1,135 @@
+#include "actor_runtime.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+void Actor::promise_type::FinalAwaiter::await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+    // The frame is suspended for good, so it can be freed before the runtime is told
+    ActorRuntime* runtime = handle.promise().runtime;
+    std::exception_ptr error = handle.promise().error;
+    handle.destroy();
+    runtime->finished(error);
+}
+
+ActorRuntime::ActorRuntime(const ActorRuntimeConfig& config) : config(config) {
+    if (config.num_threads < 0) {
+        throw std::invalid_argument("Thread count must not be negative");
+    }
+    if (config.poll_us <= 0) {
+        throw std::invalid_argument("Future polling interval must be positive");
+    }
+    const int num_threads = config.num_threads > 0 ? config.num_threads
+                                                    : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    threads.reserve(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([this] { run_scheduler(); });
+    }
+    watcher = std::thread([this] { run_watcher(); });
+}
+
+ActorRuntime::~ActorRuntime() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    ready_cv.notify_all();
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(watch_mutex);
+        stop_watching = true;
+    }
+    watch_cv.notify_one();
+    watcher.join();
+}
+
+void ActorRuntime::spawn(Actor actor) {
+    if (!actor.handle) {
+        throw std::invalid_argument("Actor has already been spawned");
+    }
+    std::coroutine_handle<Actor::promise_type> handle = actor.handle;
+    actor.handle = nullptr;
+    handle.promise().runtime = this;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        live++;
+        stats.spawned++;
+        ready.push_back(handle);
+    }
+    ready_cv.notify_one();
+}
+
+void ActorRuntime::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle_cv.wait(lock, [&] { return live == 0; });
+    if (first_error) {
+        std::exception_ptr error = first_error;
+        first_error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void ActorRuntime::schedule(std::coroutine_handle<> handle) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.push_back(handle);
+    }
+    ready_cv.notify_one();
+}
+
+ActorRuntimeStats ActorRuntime::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void ActorRuntime::watch(std::function<bool()> ready_fn, std::coroutine_handle<> handle) {
+    {
+        std::lock_guard<std::mutex> lock(watch_mutex);
+        watches.push_back(Watch{std::move(ready_fn), handle});
+    }
+    watch_cv.notify_one();
+}
+
+void ActorRuntime::finished(std::exception_ptr error) {
+    bool idle;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.finished++;
+        if (error && !first_error) first_error = error;
+        idle = --live == 0;
+    }
+    if (idle) idle_cv.notify_all();
+}
+
+void ActorRuntime::run_scheduler() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        ready_cv.wait(lock, [&] { return stopping || !ready.empty(); });
+        if (stopping) break;
+        std::coroutine_handle<> handle = ready.front();
+        ready.pop_front();
+        stats.resumes++;
+        lock.unlock();
+        handle.resume();  // runs until the actor next suspends or finishes
+        lock.lock();
+    }
+}
+
+void ActorRuntime::run_watcher() {
+    const std::chrono::microseconds poll(config.poll_us);
+    std::unique_lock<std::mutex> lock(watch_mutex);
+    while (!stop_watching) {
+        if (watches.empty()) {
+            watch_cv.wait(lock, [&] { return stop_watching || !watches.empty(); });
+            continue;
+        }
+        // Resume every actor whose future is ready; the rest are checked again after poll
+        auto done = std::partition(watches.begin(), watches.end(), [](const Watch& w) { return !w.ready(); });
+        for (auto it = done; it != watches.end(); ++it) {
+            schedule(it->handle);
+        }
+        watches.erase(done, watches.end());
+        watch_cv.wait_for(lock, poll, [&] { return stop_watching; });
+    }
+}
@@ -0,0 +1,345 @@
+#include "agent.h"
+
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr int kWinScore = 1000000;
+
+// True if `player` at `move` completes its row, column or a diagonal
+bool completes_line(const int8_t* board, int N, int move, int player) {
+    const int r = move / N;
+    const int c = move % N;
+    bool row = true;
+    bool col = true;
+    for (int k = 0; k < N; ++k) {
+        row = row && board[r * N + k] == player;
+        col = col && board[k * N + c] == player;
+    }
+    if (row || col) return true;
+    if (r == c) {
+        bool diag = true;
+        for (int k = 0; k < N && diag; ++k) diag = board[k * N + k] == player;
+        if (diag) return true;
+    }
+    if (r + c == N - 1) {
+        bool anti = true;
+        for (int k = 0; k < N && anti; ++k) anti = board[k * N + (N - 1 - k)] == player;
+        if (anti) return true;
+    }
+    return false;
+}
+
+std::vector<int8_t> board_of(const Environment& env) {
+    const std::vector<int>& cells = env.get_state().cells;
+    return std::vector<int8_t>(cells.begin(), cells.end());
+}
+
+}  // namespace
+
+void RandomAgent::act(const Environment* const* envs, RngStream* rngs, int count, int32_t* actions) {
+    for (int i = 0; i < count; ++i) {
+        const std::vector<int>& cells = envs[i]->get_state().cells;
+        int empty = 0;
+        for (int c : cells) empty += c == 0;
+        uint32_t pick = rngs[i].next_below(static_cast<uint32_t>(empty));
+        for (int c = 0; c < static_cast<int>(cells.size()); ++c) {
+            if (cells[c] == 0 && pick-- == 0) {
+                actions[i] = c;
+                break;
+            }
+        }
+    }
+}
+
+PolicyAgent::PolicyAgent(std::shared_ptr<const PolicyNetwork> network, bool greedy)
+    : network(network), local(*network), greedy(greedy) {}
+
+std::unique_ptr<Agent> PolicyAgent::clone() const {
+    return std::make_unique<PolicyAgent>(network, greedy);
+}
+
+void PolicyAgent::act(const Environment* const* envs, RngStream* rngs, int count, int32_t* actions) {
+    const int N = local.board_size();
+    const int A = N * N;
+    observations.resize(static_cast<size_t>(count) * 2 * A);
+    masks.resize(static_cast<size_t>(count) * A);
+    logits.resize(static_cast<size_t>(count) * A);
+    values.resize(count);
+    for (int i = 0; i < count; ++i) {
+        if (envs[i]->get_state().N != N) {
+            throw std::invalid_argument("Board size does not match the policy network");
+        }
+        envs[i]->write_one_hot_state(observations.data() + static_cast<size_t>(i) * 2 * A);
+        envs[i]->write_action_mask(masks.data() + static_cast<size_t>(i) * A);
+    }
+    local.forward(observations.data(), masks.data(), count, logits.data(), values.data());
+
+    for (int i = 0; i < count; ++i) {
+        const float* row = logits.data() + static_cast<size_t>(i) * A;
+        const uint8_t* legal = masks.data() + static_cast<size_t>(i) * A;
+        int best = -1;
+        for (int a = 0; a < A; ++a) {
+            if (legal[a] && (best < 0 || row[a] > row[best])) best = a;
+        }
+        if (!greedy) {
+            // Inverse-CDF sample from the masked softmax
+            float total = 0.0f;
+            for (int a = 0; a < A; ++a) {
+                if (legal[a]) total += std::exp(row[a] - row[best]);
+            }
+            float target = rngs[i].next_uniform() * total;
+            for (int a = 0; a < A; ++a) {
+                if (!legal[a]) continue;
+                target -= std::exp(row[a] - row[best]);
+                if (target < 0.0f) {
+                    best = a;
+                    break;
+                }
+            }
+        }
+        actions[i] = best;
+    }
+}
+
+TablebaseAgent::TablebaseAgent(std::shared_ptr<const MappedTablebase> table) : table(std::move(table)) {
+    if (!this->table) {
+        throw std::invalid_argument("TablebaseAgent needs a table");
+    }
+}
+
+void TablebaseAgent::act(const Environment* const* envs, RngStream* rngs, int count, int32_t* actions) {
+    const PositionIndexer& indexer = table->get_indexer();
+    for (int i = 0; i < count; ++i) {
+        const BoardState& state = envs[i]->get_state();
+        if (state.N != table->get_board_size()) {
+            throw std::invalid_argument("Board size does not match the tablebase");
+        }
+        uint64_t x = 0;
+        uint64_t o = 0;
+        for (int c = 0; c < state.N * state.N; ++c) {
+            if (state.cells[c] == 1) x |= 1ull << c;
+            else if (state.cells[c] == -1) o |= 1ull << c;
+        }
+        const bool x_to_move = envs[i]->get_current_player() == 1;
+
+        int best = std::numeric_limits<int>::min();
+        int ties = 0;
+        int choice = -1;
+        for (int m = 0; m < state.N * state.N; ++m) {
+            if (state.cells[m] != 0) continue;
+            const uint64_t bit = 1ull << m;
+            const TablebaseEntry reply = table->at(x_to_move ? indexer.index(x | bit, o) : indexer.index(x, o | bit));
+            // The reply's outcome is for the opponent; the distance counts this move too
+            const int d = reply.distance() + 1;
+            const int value = reply.outcome() == TablebaseOutcome::Loss ? 100 - d
+                            : reply.outcome() == TablebaseOutcome::Win ? -100 + d
+                            : 0;
+            if (value > best) {
+                best = value;
+                ties = 1;
+                choice = m;
+            } else if (value == best && rngs[i].next_below(++ties) == 0) {
+                choice = m;
+            }
+        }
+        actions[i] = choice;
+    }
+}
+
+int SolverAgent::negamax(std::vector<int8_t>& board, int N, int player, int empty, int depth, int alpha, int beta) {
+    // Value for `player` to move; the previous move did not end the game
+    const bool exact = max_depth < 0;
+    if (!exact && depth >= max_depth) {
+        return lines->score(player);
+    }
+    std::string key;
+    if (exact) {
+        key.assign(board.begin(), board.end());
+        key.push_back(static_cast<char>(player));
+        auto it = memo.find(key);
+        if (it != memo.end()) return it->second;
+    }
+    const int ply = N * N - empty + 1;  // stones after this move; faster wins score higher
+    int best = std::numeric_limits<int>::min();
+    for (int m = 0; m < N * N; ++m) {
+        if (board[m] != 0) continue;
+        int value;
+        board[m] = static_cast<int8_t>(player);
+        if (completes_line(board.data(), N, m, player)) {
+            value = kWinScore - ply;
+        } else if (empty == 1) {
+            value = 0;
+        } else {
+            if (!exact) lines->place(m, player);
+            value = -negamax(board, N, -player, empty - 1, depth + 1, -beta, -std::max(alpha, best));
+            if (!exact) lines->remove(m, player);
+        }
+        board[m] = 0;
+        best = std::max(best, value);
+        // Exact searches use the full window so memoised values are true values
+        if (!exact && best >= beta) break;
+    }
+    if (exact) memo.emplace(std::move(key), best);
+    return best;
+}
+
+void SolverAgent::act(const Environment* const* envs, RngStream* rngs, int count, int32_t* actions) {
+    for (int i = 0; i < count; ++i) {
+        std::vector<int8_t> board = board_of(*envs[i]);
+        const int N = envs[i]->get_state().N;
+        const int player = envs[i]->get_current_player();
+        int empty = 0;
+        for (int8_t v : board) empty += v == 0;
+        if (max_depth >= 0) {
+            if (!lines || lines->get_board_size() != N) lines = std::make_unique<LineEvaluator>(N);
+            lines->sync(envs[i]->get_state());
+        }
+
+        int best = std::numeric_limits<int>::min();
+        int ties = 0;
+        int choice = -1;
+        for (int m = 0; m < N * N; ++m) {
+            if (board[m] != 0) continue;
+            int value;
+            board[m] = static_cast<int8_t>(player);
+            if (completes_line(board.data(), N, m, player)) {
+                value = kWinScore;
+            } else if (empty == 1) {
+                value = 0;
+            } else {
+                // Window opened one below the best so equal moves get exact values
+                const int floor = best == std::numeric_limits<int>::min() ? -kWinScore - 1 : best - 1;
+                if (max_depth >= 0) lines->place(m, player);
+                value = -negamax(board, N, -player, empty - 1, 1, -kWinScore - 1, -floor);
+                if (max_depth >= 0) lines->remove(m, player);
+            }
+            board[m] = 0;
+            if (value > best) {
+                best = value;
+                ties = 1;
+                choice = m;
+            } else if (value == best && rngs[i].next_below(++ties) == 0) {
+                choice = m;  // reservoir sampling among equally good moves
+            }
+        }
+        actions[i] = choice;
+    }
+}
+
+void MCTSAgent::act(const Environment* const* envs, RngStream* rngs, int count, int32_t* actions) {
+    std::vector<int8_t> board;
+    std::vector<int> path;
+    std::vector<int> free_cells;
+    for (int i = 0; i < count; ++i) {
+        const std::vector<int8_t> root_board = board_of(*envs[i]);
+        const int N = envs[i]->get_state().N;
+        const int root_player = envs[i]->get_current_player();
+        RngStream& rng = rngs[i];
+
+        nodes.clear();
+        nodes.push_back(Node{-1, -1, -1, 0, 0, 0.0f, 0});
+        for (int it = 0; it < iterations; ++it) {
+            board = root_board;
+            int player = root_player;
+            int node = 0;
+            path.assign(1, 0);
+
+            // Selection: descend through expanded nodes by UCB1
+            while (nodes[node].num_children > 0 && nodes[node].terminal == 0) {
+                const Node& parent = nodes[node];
+                const float log_visits = std::log(static_cast<float>(parent.visits) + 1.0f);
+                int best = -1;
+                float best_score = -1.0f;
+                for (int c = parent.first_child; c < parent.first_child + parent.num_children; ++c) {
+                    const Node& child = nodes[c];
+                    float score = child.visits == 0
+                        ? std::numeric_limits<float>::infinity()
+                        : child.value / child.visits + exploration * std::sqrt(log_visits / child.visits);
+                    if (score > best_score) {
+                        best_score = score;
+                        best = c;
+                    }
+                }
+                node = best;
+                board[nodes[node].move] = static_cast<int8_t>(player);
+                player = -player;
+                path.push_back(node);
+            }
+
+            // Expansion: add every move, then continue from a random one
+            if (nodes[node].terminal == 0 && nodes[node].num_children == 0) {
+                const int first = static_cast<int>(nodes.size());
+                int empty = 0;
+                for (int8_t v : board) empty += v == 0;
+                for (int m = 0; m < N * N; ++m) {
+                    if (board[m] != 0) continue;
+                    board[m] = static_cast<int8_t>(player);
+                    int8_t terminal = completes_line(board.data(), N, m, player) ? 1 : empty == 1 ? 2 : 0;
+                    board[m] = 0;
+                    nodes.push_back(Node{m, node, -1, 0, 0, 0.0f, terminal});
+                }
+                nodes[node].first_child = first;
+                nodes[node].num_children = static_cast<int>(nodes.size()) - first;
+                node = first + static_cast<int>(rng.next_below(static_cast<uint32_t>(nodes[node].num_children)));
+                board[nodes[node].move] = static_cast<int8_t>(player);
+                player = -player;
+                path.push_back(node);
+            }
+
+            // Simulation: the winner is +1/-1, or 0 for a draw
+            int winner = 0;
+            if (nodes[node].terminal == 1) {
+                winner = -player;
+            } else if (nodes[node].terminal == 0) {
+                free_cells.clear();
+                for (int m = 0; m < N * N; ++m) {
+                    if (board[m] == 0) free_cells.push_back(m);
+                }
+                while (!free_cells.empty()) {
+                    const uint32_t k = rng.next_below(static_cast<uint32_t>(free_cells.size()));
+                    const int m = free_cells[k];
+                    free_cells[k] = free_cells.back();
+                    free_cells.pop_back();
+                    board[m] = static_cast<int8_t>(player);
+                    if (completes_line(board.data(), N, m, player)) {
+                        winner = player;
+                        break;
+                    }
+                    player = -player;
+                }
+            }
+
+            // Backpropagation: node at depth d was entered by root_player when d is odd
+            for (size_t d = 0; d < path.size(); ++d) {
+                Node& n = nodes[path[d]];
+                n.visits++;
+                const int mover = d % 2 == 1 ? root_player : -root_player;
+                n.value += winner == mover ? 1.0f : winner == 0 ? 0.5f : 0.0f;
+            }
+        }
+
+        // Most visited move, taking an immediate win outright
+        const Node& root = nodes[0];
+        int choice = -1;
+        int most = -1;
+        for (int c = root.first_child; c < root.first_child + root.num_children; ++c) {
+            if (nodes[c].terminal == 1) {
+                choice = nodes[c].move;
+                break;
+            }
+            if (nodes[c].visits > most) {
+                most = nodes[c].visits;
+                choice = nodes[c].move;
+            }
+        }
+        if (choice < 0) {
+            // No iterations: fall back to the first legal move
+            for (int m = 0; m < N * N && choice < 0; ++m) {
+                if (root_board[m] == 0) choice = m;
+            }
+        }
+        actions[i] = choice;
+    }
+}
@@ -0,0 +1,574 @@
+#include "batched_environment.h"
+#include "symmetry.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <stdexcept>
+
+BatchedEnvironment::BatchedEnvironment(int num_envs, int N, std::shared_ptr<RewardCallback> reward_fn)
+    : num_envs(num_envs), N(N) {
+    if (num_envs <= 0) {
+        throw std::invalid_argument("Batch must contain at least one environment");
+    }
+    if (N <= 0) {
+        throw std::invalid_argument("Board size must be positive");
+    }
+    envs.reserve(num_envs);
+    for (int i = 0; i < num_envs; ++i) {
+        envs.emplace_back(N, reward_fn);
+    }
+    observations.assign(static_cast<size_t>(num_envs) * 2 * N * N, 0.0f);
+    action_masks.assign(static_cast<size_t>(num_envs) * N * N, 1);
+    rewards.assign(num_envs, 0.0f);
+    dones.assign(num_envs, 0);
+    boards.assign(static_cast<size_t>(num_envs) * N * N, 0);
+    actions.assign(num_envs, 0);
+    outcomes.assign(num_envs, OUTCOME_ONGOING);
+    statuses.assign(num_envs, static_cast<uint8_t>(StepStatus::Ok));
+    symmetries.assign(num_envs, 0);
+    permutations.reserve(static_cast<size_t>(kNumSymmetries) * N * N);
+    for (int t = 0; t < kNumSymmetries; ++t) {
+        for (int c = 0; c < N * N; ++c) {
+            permutations.push_back(transform_cell(N, t, c));
+        }
+    }
+}
+
+void BatchedEnvironment::reset() {
+    for (int i = 0; i < num_envs; ++i) {
+        envs[i].reset_in_place();
+        write_env_buffers(i);
+    }
+    encode_count++;
+    std::fill(rewards.begin(), rewards.end(), 0.0f);
+    std::fill(dones.begin(), dones.end(), 0);
+    std::fill(boards.begin(), boards.end(), 0);
+    std::fill(outcomes.begin(), outcomes.end(), OUTCOME_ONGOING);
+}
+
+void BatchedEnvironment::step(const int32_t* actions_in) {
+    // Check the whole batch before any environment moves, so a bad action cannot leave
+    // it half-stepped
+    const unsigned cells = static_cast<unsigned>(N * N);
+    for (int i = 0; i < num_envs; ++i) {
+        if (static_cast<unsigned>(actions_in[i]) >= cells) {
+            throw std::invalid_argument("Action index out of bounds");
+        }
+        if (envs[i].get_state().cells[actions_in[i]] != 0) {
+            throw std::invalid_argument("Action targets an occupied cell");
+        }
+    }
+    // Apply every action first so a batch reward hook sees all terminal boards
+    for (int i = 0; i < num_envs; ++i) {
+        float reward;
+        bool done;
+        envs[i].step_in_place(Action{actions_in[i]}, reward, done);
+        record_step(i, actions_in[i], reward, done);
+    }
+    finish_step();
+}
+
+int BatchedEnvironment::try_step(const int32_t* actions_in) {
+    int invalid = 0;
+    for (int i = 0; i < num_envs; ++i) {
+        float reward;
+        bool done;
+        const StepStatus status = envs[i].try_step(Action{actions_in[i]}, reward, done);
+        statuses[i] = static_cast<uint8_t>(status);
+        if (status == StepStatus::Ok) {
+            record_step(i, actions_in[i], reward, done);
+        } else {
+            handle_invalid(i);
+            invalid++;
+        }
+    }
+    try_step_count++;
+    finish_step();
+    return invalid;
+}
+
+void BatchedEnvironment::set_invalid_action_policy(InvalidActionPolicy policy, float penalty, uint64_t seed) {
+    invalid_policy = policy;
+    invalid_penalty = penalty;
+    resample_rng = CounterRng(seed);
+}
+
+void BatchedEnvironment::record_step(int i, int32_t action, float reward, bool done) {
+    const size_t cells = static_cast<size_t>(N) * N;
+    rewards[i] = reward;
+    dones[i] = done ? 1 : 0;
+    actions[i] = action;
+
+    const int winner = envs[i].get_winner();
+    outcomes[i] = !done ? OUTCOME_ONGOING
+                : winner == 1 ? OUTCOME_PLAYER1_WIN
+                : winner == -1 ? OUTCOME_PLAYER2_WIN
+                : OUTCOME_DRAW;
+
+    const std::vector<int>& src = envs[i].get_state().cells;
+    int8_t* dst = boards.data() + i * cells;
+    for (size_t c = 0; c < cells; ++c) {
+        dst[c] = static_cast<int8_t>(src[c]);
+    }
+}
+
+void BatchedEnvironment::handle_invalid(int i) {
+    Environment& env = envs[i];
+    switch (invalid_policy) {
+    case InvalidActionPolicy::Reject:
+        record_step(i, kNoAction, 0.0f, false);
+        break;
+    case InvalidActionPolicy::PenalizeAndEnd:
+        // The board is unchanged; the episode ends as a loss for the player who moved
+        record_step(i, kNoAction, invalid_penalty, true);
+        outcomes[i] = env.get_current_player() == 1 ? OUTCOME_PLAYER2_WIN : OUTCOME_PLAYER1_WIN;
+        break;
+    case InvalidActionPolicy::Resample: {
+        // Finished environments are reset, but a restored snapshot can still hold a full
+        // board; with nothing to resample the action is rejected
+        const std::vector<int>& cells = env.get_state().cells;
+        const int empty = static_cast<int>(std::count(cells.begin(), cells.end(), 0));
+        if (empty == 0) {
+            record_step(i, kNoAction, 0.0f, false);
+            break;
+        }
+        int k = static_cast<int>(resample_rng.below(empty, i, try_step_count, kResampleDraw));
+        int replacement = 0;
+        while (cells[replacement] != 0 || k-- > 0) {
+            replacement++;
+        }
+        float reward;
+        bool done;
+        env.try_step(Action{replacement}, reward, done);
+        record_step(i, replacement, reward, done);
+        break;
+    }
+    }
+}
+
+void BatchedEnvironment::finish_step() {
+    // A throwing hook must not skip the resets, or finished boards would stay in play
+    std::exception_ptr error;
+    if (batch_reward) {
+        try {
+            (*batch_reward)(boards.data(), actions.data(), outcomes.data(), num_envs, N, rewards.data());
+        } catch (...) {
+            error = std::current_exception();
+        }
+    }
+
+    for (int i = 0; i < num_envs; ++i) {
+        if (dones[i]) {
+            envs[i].reset_in_place();
+        }
+        write_env_buffers(i);
+    }
+    encode_count++;
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void BatchedEnvironment::set_symmetry_augmentation(bool enabled, uint64_t seed) {
+    augment = enabled;
+    symmetry_rng = CounterRng(seed);
+}
+
+void BatchedEnvironment::transform_policies(const float* in, float* out) const {
+    const size_t cells = static_cast<size_t>(N) * N;
+    for (int i = 0; i < num_envs; ++i) {
+        const int32_t* perm = permutations.data() + symmetries[i] * cells;
+        const float* src = in + i * cells;
+        float* dst = out + i * cells;
+        for (size_t c = 0; c < cells; ++c) {
+            dst[perm[c]] = src[c];
+        }
+    }
+}
+
+void BatchedEnvironment::inverse_transform_policies(const float* in, float* out) const {
+    const size_t cells = static_cast<size_t>(N) * N;
+    for (int i = 0; i < num_envs; ++i) {
+        const int32_t* perm = permutations.data() + symmetries[i] * cells;
+        const float* src = in + i * cells;
+        float* dst = out + i * cells;
+        for (size_t c = 0; c < cells; ++c) {
+            dst[c] = src[perm[c]];
+        }
+    }
+}
+
+void BatchedEnvironment::inverse_transform_actions(const int32_t* in, int32_t* out) const {
+    const int cells = N * N;
+    for (int i = 0; i < num_envs; ++i) {
+        // Out-of-range actions pass through so step() can report them
+        out[i] = in[i] >= 0 && in[i] < cells
+            ? transform_cell(N, inverse_symmetry(symmetries[i]), in[i])
+            : in[i];
+    }
+}
+
+void BatchedEnvironment::set_feature_config(const FeatureConfig& config) {
+    const int planes = num_feature_planes(config);
+    feature_config = config;
+    num_planes = planes;
+    features.assign(static_cast<size_t>(num_envs) * planes * N * N, 0.0f);
+    // Fill the rows for the current boards without drawing new symmetries
+    const size_t cells = static_cast<size_t>(N) * N;
+    for (int i = 0; i < num_envs; ++i) {
+        const int32_t* perm = augment ? permutations.data() + symmetries[i] * cells : nullptr;
+        write_feature_planes(envs[i], feature_config, features.data() + i * planes * cells, perm);
+    }
+}
+
+void BatchedEnvironment::write_env_buffers(int i) {
+    symmetries[i] = augment
+        ? static_cast<uint8_t>(symmetry_rng.below(kNumSymmetries, i, encode_count, kSymmetryDraw))
+        : 0;
+    write_env_rows(i);
+}
+
+void BatchedEnvironment::write_env_rows(int i) {
+    const size_t cells = static_cast<size_t>(N) * N;
+    float* obs = observations.data() + i * 2 * cells;
+    uint8_t* mask = action_masks.data() + i * cells;
+    const int32_t* perm = nullptr;
+    if (symmetries[i] == 0) {
+        envs[i].write_one_hot_state(obs);
+        envs[i].write_action_mask(mask);
+    } else {
+        // Scatter straight into the transformed positions instead of writing and permuting
+        perm = permutations.data() + symmetries[i] * cells;
+        const std::vector<int>& src = envs[i].get_state().cells;
+        for (size_t c = 0; c < cells; ++c) {
+            const int v = src[c];
+            const int32_t d = perm[c];
+            obs[d] = v == 1 ? 1.0f : 0.0f;
+            obs[cells + d] = v == -1 ? 1.0f : 0.0f;
+            mask[d] = v == 0 ? 1 : 0;
+        }
+    }
+    if (num_planes > 0) {
+        write_feature_planes(envs[i], feature_config, features.data() + i * num_planes * cells, perm);
+    }
+}
+
+namespace {
+
+// Snapshot layout: this 64-byte header, then num_envs Environment snapshots of env_bytes
+// each, then rewards, dones, boards, actions, outcomes, statuses and symmetries as
+// stored in the batch. Written in host byte order.
+struct BatchSnapshotHeader {
+    uint32_t magic;    // 'TTBS'
+    uint32_t version;  // 1
+    uint32_t num_envs;
+    uint32_t N;
+    uint64_t try_step_count;
+    uint64_t encode_count;
+    uint64_t resample_seed;
+    uint64_t symmetry_seed;
+    float invalid_penalty;
+    int32_t feature_history;
+    uint8_t invalid_policy;
+    uint8_t augment;
+    uint8_t feature_side_to_move;
+    uint8_t feature_legal_moves;
+    uint32_t env_bytes;
+};
+static_assert(sizeof(BatchSnapshotHeader) == 64, "snapshot header must stay 64 bytes");
+
+constexpr uint32_t kSnapshotMagic = 0x53425454;  // 'TTBS'
+constexpr uint32_t kSnapshotVersion = 1;
+
+size_t snapshot_bytes(size_t num_envs, size_t cells, size_t env_bytes) {
+    return sizeof(BatchSnapshotHeader) +
+           num_envs * (env_bytes + sizeof(float) + 1 + cells + sizeof(int32_t) + 1 + 1 + 1);
+}
+
+}  // namespace
+
+std::vector<uint8_t> BatchedEnvironment::save_snapshot() const {
+    const size_t cells = static_cast<size_t>(N) * N;
+    const size_t env_bytes = envs[0].snapshot_size();
+    std::vector<uint8_t> data(snapshot_bytes(num_envs, cells, env_bytes));
+
+    BatchSnapshotHeader header{};
+    header.magic = kSnapshotMagic;
+    header.version = kSnapshotVersion;
+    header.num_envs = static_cast<uint32_t>(num_envs);
+    header.N = static_cast<uint32_t>(N);
+    header.try_step_count = try_step_count;
+    header.encode_count = encode_count;
+    header.resample_seed = resample_rng.get_seed();
+    header.symmetry_seed = symmetry_rng.get_seed();
+    header.invalid_penalty = invalid_penalty;
+    header.feature_history = feature_config.history;
+    header.invalid_policy = static_cast<uint8_t>(invalid_policy);
+    header.augment = augment ? 1 : 0;
+    header.feature_side_to_move = feature_config.side_to_move ? 1 : 0;
+    header.feature_legal_moves = feature_config.legal_moves ? 1 : 0;
+    header.env_bytes = static_cast<uint32_t>(env_bytes);
+    std::memcpy(data.data(), &header, sizeof(header));
+
+    uint8_t* out = data.data() + sizeof(header);
+    for (const Environment& env : envs) {
+        env.write_snapshot(out);
+        out += env_bytes;
+    }
+    auto put = [&out](const auto& buffer) {
+        const size_t bytes = buffer.size() * sizeof(buffer[0]);
+        std::memcpy(out, buffer.data(), bytes);
+        out += bytes;
+    };
+    put(rewards);
+    put(dones);
+    put(boards);
+    put(actions);
+    put(outcomes);
+    put(statuses);
+    put(symmetries);
+    return data;
+}
+
+void BatchedEnvironment::load_snapshot(const uint8_t* data, size_t size) {
+    BatchSnapshotHeader header;
+    if (size < sizeof(header)) {
+        throw std::runtime_error("Truncated batched environment snapshot");
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != kSnapshotMagic) {
+        throw std::runtime_error("Not a batched environment snapshot");
+    }
+    if (header.version != kSnapshotVersion) {
+        throw std::runtime_error("Unsupported batched environment snapshot version");
+    }
+    if (header.num_envs != static_cast<uint32_t>(num_envs) || header.N != static_cast<uint32_t>(N)) {
+        throw std::invalid_argument("Snapshot is for " + std::to_string(header.num_envs) + " environments of size " +
+                                    std::to_string(header.N) + ", not " + std::to_string(num_envs) + " of size " +
+                                    std::to_string(N));
+    }
+    const size_t cells = static_cast<size_t>(N) * N;
+    const size_t env_bytes = envs[0].snapshot_size();
+    if (header.env_bytes != env_bytes || size != snapshot_bytes(num_envs, cells, env_bytes)) {
+        throw std::runtime_error("Corrupt batched environment snapshot: unexpected size");
+    }
+    FeatureConfig config;
+    config.side_to_move = header.feature_side_to_move != 0;
+    config.history = header.feature_history;
+    config.legal_moves = header.feature_legal_moves != 0;
+    if (header.invalid_policy > static_cast<uint8_t>(InvalidActionPolicy::Resample) ||
+        config.history < 0 || config.history > Environment::kMoveHistory) {
+        throw std::runtime_error("Corrupt batched environment snapshot header");
+    }
+
+    // Everything is decoded and checked before the batch is touched
+    const uint8_t* in = data + sizeof(header);
+    std::vector<Environment> restored = envs;
+    for (Environment& env : restored) {
+        env.read_snapshot(in);
+        in += env_bytes;
+    }
+    const uint8_t* buffers = in;
+    in += num_envs * (sizeof(float) + 1 + cells + sizeof(int32_t));
+    const uint8_t* restored_outcomes = in;
+    const uint8_t* restored_statuses = in + num_envs;
+    const uint8_t* restored_symmetries = in + 2 * num_envs;
+    for (int i = 0; i < num_envs; ++i) {
+        const int8_t outcome = static_cast<int8_t>(restored_outcomes[i]);
+        if ((outcome < OUTCOME_PLAYER2_WIN || outcome > OUTCOME_DRAW) ||
+            restored_statuses[i] > static_cast<uint8_t>(StepStatus::Occupied) ||
+            restored_symmetries[i] >= kNumSymmetries) {
+            throw std::runtime_error("Corrupt batched environment snapshot buffers");
+        }
+    }
+
+    envs.swap(restored);
+    auto get = [&buffers](auto& buffer) {
+        const size_t bytes = buffer.size() * sizeof(buffer[0]);
+        std::memcpy(buffer.data(), buffers, bytes);
+        buffers += bytes;
+    };
+    get(rewards);
+    get(dones);
+    get(boards);
+    get(actions);
+    get(outcomes);
+    get(statuses);
+    get(symmetries);
+
+    invalid_policy = static_cast<InvalidActionPolicy>(header.invalid_policy);
+    invalid_penalty = header.invalid_penalty;
+    resample_rng = CounterRng(header.resample_seed);
+    try_step_count = header.try_step_count;
+    augment = header.augment != 0;
+    symmetry_rng = CounterRng(header.symmetry_seed);
+    encode_count = header.encode_count;
+    feature_config = config;
+    const int planes = num_feature_planes(config);
+    if (planes != num_planes) {
+        num_planes = planes;
+        features.assign(static_cast<size_t>(num_envs) * num_planes * cells, 0.0f);
+    }
+    for (int i = 0; i < num_envs; ++i) {
+        write_env_rows(i);
+    }
+}
+
+void BatchedEnvironment::save_checkpoint(const std::string& path) const {
+    const std::vector<uint8_t> data = save_snapshot();
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Cannot open checkpoint file for writing: " + path);
+    }
+    out.write(reinterpret_cast<const char*>(data.data()), data.size());
+    if (!out) {
+        throw std::runtime_error("Failed writing checkpoint file: " + path);
+    }
+}
+
+void BatchedEnvironment::load_checkpoint(const std::string& path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        throw std::runtime_error("Cannot open checkpoint file: " + path);
+    }
+    std::vector<uint8_t> data(static_cast<size_t>(in.tellg()));
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(data.data()), data.size());
+    if (!in) {
+        throw std::runtime_error("Failed reading checkpoint file: " + path);
+    }
+    load_snapshot(data.data(), data.size());
+}
+
+MixedBatchedEnvironment::MixedBatchedEnvironment(int num_envs, int max_N, std::shared_ptr<RewardCallback> reward_fn)
+    : num_envs(num_envs), max_N(max_N), reward_fn(std::move(reward_fn)) {
+    if (num_envs <= 0) {
+        throw std::invalid_argument("Batch must contain at least one environment");
+    }
+    if (max_N <= 0) {
+        throw std::invalid_argument("Board size must be positive");
+    }
+    const size_t cells = static_cast<size_t>(max_N) * max_N;
+    pool.resize(static_cast<size_t>(num_envs) * max_N);
+    envs.assign(num_envs, nullptr);
+    sizes.assign(num_envs, 0);
+    requested.assign(num_envs, max_N);
+    local_actions.assign(num_envs, 0);
+    cell_masks.assign(num_envs * cells, 0);
+    observations.assign(num_envs * 2 * cells, 0.0f);
+    action_masks.assign(num_envs * cells, 0);
+    rewards.assign(num_envs, 0.0f);
+    dones.assign(num_envs, 0);
+    boards.assign(num_envs * cells, 0);
+    actions.assign(num_envs, 0);
+    outcomes.assign(num_envs, OUTCOME_ONGOING);
+    for (int i = 0; i < num_envs; ++i) {
+        pool[static_cast<size_t>(i) * max_N + max_N - 1] = std::make_unique<Environment>(max_N, this->reward_fn);
+        reset_env(i);
+        write_env_buffers(i);
+    }
+}
+
+void MixedBatchedEnvironment::set_board_sizes(const int32_t* sizes_in) {
+    for (int i = 0; i < num_envs; ++i) {
+        if (sizes_in[i] < 1 || sizes_in[i] > max_N) {
+            throw std::invalid_argument("Board sizes must be between 1 and the maximum board size");
+        }
+    }
+    for (int i = 0; i < num_envs; ++i) {
+        std::unique_ptr<Environment>& slot = pool[static_cast<size_t>(i) * max_N + sizes_in[i] - 1];
+        if (!slot) {
+            slot = std::make_unique<Environment>(sizes_in[i], reward_fn);
+        }
+        requested[i] = sizes_in[i];
+    }
+}
+
+void MixedBatchedEnvironment::reset() {
+    for (int i = 0; i < num_envs; ++i) {
+        reset_env(i);
+        write_env_buffers(i);
+    }
+    std::fill(rewards.begin(), rewards.end(), 0.0f);
+    std::fill(dones.begin(), dones.end(), 0);
+    std::fill(boards.begin(), boards.end(), 0);
+    std::fill(outcomes.begin(), outcomes.end(), OUTCOME_ONGOING);
+}
+
+void MixedBatchedEnvironment::step(const int32_t* actions_in) {
+    const int cells = max_N * max_N;
+    for (int i = 0; i < num_envs; ++i) {
+        const int n = sizes[i];
+        const int a = actions_in[i];
+        if (a < 0 || a >= cells || a / max_N >= n || a % max_N >= n) {
+            throw std::invalid_argument("Action is outside the environment's board");
+        }
+        local_actions[i] = (a / max_N) * n + a % max_N;
+        if (envs[i]->get_state().cells[local_actions[i]] != 0) {
+            throw std::invalid_argument("Action targets an occupied cell");
+        }
+    }
+
+    for (int i = 0; i < num_envs; ++i) {
+        float reward;
+        bool done;
+        envs[i]->step_in_place(Action{local_actions[i]}, reward, done);
+        rewards[i] = reward;
+        dones[i] = done ? 1 : 0;
+        actions[i] = actions_in[i];
+        const int winner = envs[i]->get_winner();
+        outcomes[i] = !done ? OUTCOME_ONGOING
+                    : winner == 1 ? OUTCOME_PLAYER1_WIN
+                    : winner == -1 ? OUTCOME_PLAYER2_WIN
+                    : OUTCOME_DRAW;
+
+        const int n = sizes[i];
+        const std::vector<int>& src = envs[i]->get_state().cells;
+        int8_t* dst = boards.data() + static_cast<size_t>(i) * cells;
+        for (int r = 0; r < max_N; ++r) {
+            for (int c = 0; c < max_N; ++c) {
+                dst[r * max_N + c] = r < n && c < n ? static_cast<int8_t>(src[r * n + c]) : 0;
+            }
+        }
+        if (done) {
+            reset_env(i);
+        }
+        write_env_buffers(i);
+    }
+}
+
+void MixedBatchedEnvironment::reset_env(int i) {
+    const int n = requested[i];
+    const size_t cells = static_cast<size_t>(max_N) * max_N;
+    if (n != sizes[i]) {
+        envs[i] = pool[static_cast<size_t>(i) * max_N + n - 1].get();
+        sizes[i] = n;
+        uint8_t* valid = cell_masks.data() + i * cells;
+        for (int r = 0; r < max_N; ++r) {
+            for (int c = 0; c < max_N; ++c) {
+                valid[r * max_N + c] = r < n && c < n ? 1 : 0;
+            }
+        }
+    }
+    envs[i]->reset_in_place();
+}
+
+void MixedBatchedEnvironment::write_env_buffers(int i) {
+    const int n = sizes[i];
+    const size_t cells = static_cast<size_t>(max_N) * max_N;
+    const std::vector<int>& src = envs[i]->get_state().cells;
+    float* x_plane = observations.data() + i * 2 * cells;
+    float* o_plane = x_plane + cells;
+    uint8_t* mask = action_masks.data() + i * cells;
+    for (int r = 0; r < max_N; ++r) {
+        for (int c = 0; c < max_N; ++c) {
+            const bool on_board = r < n && c < n;
+            const int v = on_board ? src[r * n + c] : 0;
+            x_plane[r * max_N + c] = v == 1 ? 1.0f : 0.0f;
+            o_plane[r * max_N + c] = v == -1 ? 1.0f : 0.0f;
+            mask[r * max_N + c] = on_board && v == 0 ? 1 : 0;
+        }
+    }
+}
@@ -0,0 +1,388 @@
+// US3.3 / US9.2: pybind11 bindings for batched environments.
+//
+// Observations, masks, rewards and dones are exposed as read-only NumPy arrays that
+// view the C++-owned buffers of a BatchedEnvironment. The views are created once per
+// environment, so a step creates no Python objects beyond the returned tuple.
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+
+#include "batched_environment.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace py = pybind11;
+
+namespace {
+
+// Read-only NumPy view on `data`. The capsule `owner` keeps the buffer alive for as
+// long as any view (or slice of it) exists in Python.
+template <typename T>
+py::array make_view(const T* data, const std::vector<py::ssize_t>& shape, const py::capsule& owner) {
+    std::vector<py::ssize_t> strides(shape.size());
+    py::ssize_t stride = sizeof(T);
+    for (size_t d = shape.size(); d-- > 0;) {
+        strides[d] = stride;
+        stride *= shape[d];
+    }
+    py::array view(py::dtype::of<T>(), shape, strides, data, owner);
+    view.attr("setflags")(py::arg("write") = false);
+    return view;
+}
+
+// Borrowed view for data that only needs to stay valid during a callback
+template <typename T>
+py::array make_borrowed_view(const T* data, const std::vector<py::ssize_t>& shape) {
+    return make_view(data, shape, py::capsule(data, [](void*) {}));
+}
+
+// US3.3: Python reward function called once per batch step as
+//   rewards = fn(boards, actions, outcomes)
+// with int8 [B, N, N], int32 [B] and int8 [B] views; it returns B rewards.
+// step() runs without the GIL, which is taken only around this one call.
+class PyBatchReward : public BatchRewardCallback {
+public:
+    PyBatchReward(py::function fn, const BatchedEnvironment& env) : fn(std::move(fn)) {
+        // The views point at the environment's own buffers, so they are built once.
+        // They are borrowed (no reference to the environment) to avoid a cycle through
+        // this callback, and must not be kept after the call returns.
+        const py::ssize_t B = env.get_num_envs();
+        const py::ssize_t n = env.get_board_size();
+        boards = make_borrowed_view(env.get_boards(), {B, n, n});
+        actions = make_borrowed_view(env.get_actions(), {B});
+        outcomes = make_borrowed_view(env.get_outcomes(), {B});
+    }
+
+    ~PyBatchReward() override {
+        py::gil_scoped_acquire acquire;
+        fn = py::function();
+        boards = py::array();
+        actions = py::array();
+        outcomes = py::array();
+    }
+
+    void operator()(const int8_t*, const int32_t*, const int8_t*, int num_envs, int, float* rewards) override {
+        py::gil_scoped_acquire acquire;
+        py::object out = fn(boards, actions, outcomes);
+        auto result = py::array_t<float, py::array::c_style | py::array::forcecast>::ensure(out);
+        if (!result || result.ndim() != 1 || result.shape(0) != num_envs) {
+            throw std::invalid_argument("reward function must return a 1-D array with one reward per environment");
+        }
+        std::copy(result.data(), result.data() + num_envs, rewards);
+    }
+
+private:
+    py::function fn;
+    py::array boards;
+    py::array actions;
+    py::array outcomes;
+};
+
+struct PyBatchedEnvironment {
+    std::shared_ptr<BatchedEnvironment> env;
+    py::array observations;
+    py::array action_masks;
+    py::array rewards;
+    py::array dones;
+    py::array boards;
+    py::array outcomes;
+    py::array statuses;
+    py::array symmetries;
+    py::object features = py::none();
+
+    PyBatchedEnvironment(int num_envs, int N, const py::object& feature_history, bool side_to_move, bool legal_moves)
+        : env(std::make_shared<BatchedEnvironment>(num_envs, N, std::make_shared<DefaultReward>())) {
+        // Feature planes are fixed at construction so their view never dangles
+        if (!feature_history.is_none()) {
+            FeatureConfig config;
+            config.history = feature_history.cast<int>();
+            config.side_to_move = side_to_move;
+            config.legal_moves = legal_moves;
+            env->set_feature_config(config);
+        }
+        // The capsule holds a reference to the environment, not to this wrapper,
+        // so views can outlive the wrapper without a reference cycle
+        py::capsule owner(new std::shared_ptr<BatchedEnvironment>(env), [](void* p) {
+            delete static_cast<std::shared_ptr<BatchedEnvironment>*>(p);
+        });
+        const py::ssize_t B = num_envs;
+        const py::ssize_t n = N;
+        observations = make_view(env->get_observations(), {B, 2, n, n}, owner);
+        action_masks = make_view(env->get_action_masks(), {B, n * n}, owner);
+        rewards = make_view(env->get_rewards(), {B}, owner);
+        dones = make_view(env->get_dones(), {B}, owner);
+        boards = make_view(env->get_boards(), {B, n, n}, owner);
+        outcomes = make_view(env->get_outcomes(), {B}, owner);
+        statuses = make_view(env->get_statuses(), {B}, owner);
+        symmetries = make_view(env->get_symmetries(), {B}, owner);
+        if (env->get_num_feature_planes() > 0) {
+            features = make_view(env->get_features(), {B, env->get_num_feature_planes(), n, n}, owner);
+        }
+    }
+
+    // Loading must not reallocate the feature planes under an existing view, so the
+    // snapshot is tried on a scratch batch first
+    template <typename Load>
+    void load_keeping_views(Load load) {
+        BatchedEnvironment scratch(env->get_num_envs(), env->get_board_size(), std::make_shared<DefaultReward>());
+        load(scratch);
+        if (scratch.get_num_feature_planes() != env->get_num_feature_planes()) {
+            throw py::value_error("snapshot has a different number of feature planes than this environment");
+        }
+        load(*env);
+    }
+
+    py::bytes save_snapshot() const {
+        const std::vector<uint8_t> data = env->save_snapshot();
+        return py::bytes(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+
+    void load_snapshot(const py::bytes& snapshot) {
+        const std::string data = snapshot;
+        load_keeping_views([&data](BatchedEnvironment& target) {
+            target.load_snapshot(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+        });
+    }
+
+    void load_checkpoint(const std::string& path) {
+        load_keeping_views([&path](BatchedEnvironment& target) { target.load_checkpoint(path); });
+    }
+
+    void set_reward_fn(const py::object& fn) {
+        if (fn.is_none()) {
+            env->set_batch_reward(nullptr);
+        } else {
+            if (!PyCallable_Check(fn.ptr())) {
+                throw py::type_error("reward function must be callable or None");
+            }
+            env->set_batch_reward(std::make_shared<PyBatchReward>(py::reinterpret_borrow<py::function>(fn), *env));
+        }
+    }
+
+    py::tuple step(const py::array_t<int32_t, py::array::c_style>& actions) {
+        const int32_t* data = checked_actions(actions);
+        {
+            // The environment only touches C++ memory while stepping
+            py::gil_scoped_release release;
+            env->step(data);
+        }
+        return py::make_tuple(observations, action_masks, rewards, dones);
+    }
+
+    py::tuple try_step(const py::array_t<int32_t, py::array::c_style>& actions) {
+        const int32_t* data = checked_actions(actions);
+        {
+            py::gil_scoped_release release;
+            env->try_step(data);
+        }
+        return py::make_tuple(observations, action_masks, rewards, dones, statuses);
+    }
+
+    void set_invalid_action_policy(const std::string& policy, float penalty, uint64_t seed) {
+        if (policy == "reject") {
+            env->set_invalid_action_policy(InvalidActionPolicy::Reject, penalty, seed);
+        } else if (policy == "penalize") {
+            env->set_invalid_action_policy(InvalidActionPolicy::PenalizeAndEnd, penalty, seed);
+        } else if (policy == "resample") {
+            env->set_invalid_action_policy(InvalidActionPolicy::Resample, penalty, seed);
+        } else {
+            throw std::invalid_argument("policy must be 'reject', 'penalize' or 'resample'");
+        }
+    }
+
+    // [B, N*N] float32 rows mapped by the current symmetries into a new array
+    py::array_t<float> map_policies(const py::array_t<float, py::array::c_style | py::array::forcecast>& in, bool inverse) const {
+        const py::ssize_t B = env->get_num_envs();
+        const py::ssize_t cells = static_cast<py::ssize_t>(env->get_board_size()) * env->get_board_size();
+        if (in.ndim() != 2 || in.shape(0) != B || in.shape(1) != cells) {
+            throw std::invalid_argument("policies must be a [num_envs, N*N] float array");
+        }
+        py::array_t<float> out({B, cells});
+        if (inverse) {
+            env->inverse_transform_policies(in.data(), out.mutable_data());
+        } else {
+            env->transform_policies(in.data(), out.mutable_data());
+        }
+        return out;
+    }
+
+    py::array_t<int32_t> inverse_transform_actions(const py::array_t<int32_t, py::array::c_style>& actions) const {
+        const int32_t* data = checked_actions(actions);
+        py::array_t<int32_t> out(env->get_num_envs());
+        env->inverse_transform_actions(data, out.mutable_data());
+        return out;
+    }
+
+    const int32_t* checked_actions(const py::array_t<int32_t, py::array::c_style>& actions) const {
+        if (actions.ndim() != 1 || actions.shape(0) != env->get_num_envs()) {
+            throw std::invalid_argument("actions must be a 1-D int32 array of length num_envs");
+        }
+        return actions.data();
+    }
+
+    py::tuple reset() {
+        {
+            py::gil_scoped_release release;
+            env->reset();
+        }
+        return py::make_tuple(observations, action_masks);
+    }
+};
+
+// Mixed-size batch: the same views, padded to max_N, plus the board sizes and the
+// per-cell validity masks
+struct PyMixedBatchedEnvironment {
+    std::shared_ptr<MixedBatchedEnvironment> env;
+    py::array observations;
+    py::array action_masks;
+    py::array cell_masks;
+    py::array board_sizes;
+    py::array rewards;
+    py::array dones;
+    py::array boards;
+    py::array outcomes;
+
+    PyMixedBatchedEnvironment(int num_envs, int max_N)
+        : env(std::make_shared<MixedBatchedEnvironment>(num_envs, max_N, std::make_shared<DefaultReward>())) {
+        py::capsule owner(new std::shared_ptr<MixedBatchedEnvironment>(env), [](void* p) {
+            delete static_cast<std::shared_ptr<MixedBatchedEnvironment>*>(p);
+        });
+        const py::ssize_t B = num_envs;
+        const py::ssize_t n = max_N;
+        observations = make_view(env->get_observations(), {B, 2, n, n}, owner);
+        action_masks = make_view(env->get_action_masks(), {B, n * n}, owner);
+        cell_masks = make_view(env->get_cell_masks(), {B, n, n}, owner);
+        board_sizes = make_view(env->get_board_sizes(), {B}, owner);
+        rewards = make_view(env->get_rewards(), {B}, owner);
+        dones = make_view(env->get_dones(), {B}, owner);
+        boards = make_view(env->get_boards(), {B, n, n}, owner);
+        outcomes = make_view(env->get_outcomes(), {B}, owner);
+    }
+
+    void set_board_sizes(const py::array_t<int32_t, py::array::c_style | py::array::forcecast>& sizes) {
+        if (sizes.ndim() != 1 || sizes.shape(0) != env->get_num_envs()) {
+            throw std::invalid_argument("sizes must be a 1-D int array of length num_envs");
+        }
+        env->set_board_sizes(sizes.data());
+    }
+
+    py::tuple step(const py::array_t<int32_t, py::array::c_style>& actions) {
+        if (actions.ndim() != 1 || actions.shape(0) != env->get_num_envs()) {
+            throw std::invalid_argument("actions must be a 1-D int32 array of length num_envs");
+        }
+        const int32_t* data = actions.data();
+        {
+            py::gil_scoped_release release;
+            env->step(data);
+        }
+        return py::make_tuple(observations, action_masks, rewards, dones);
+    }
+
+    py::tuple reset() {
+        {
+            py::gil_scoped_release release;
+            env->reset();
+        }
+        return py::make_tuple(observations, action_masks);
+    }
+};
+
+}  // namespace
+
+PYBIND11_MODULE(tictactoe_env, m) {
+    m.doc() = "NxN Tic-Tac-Toe RL environment";
+
+    py::class_<PyBatchedEnvironment>(m, "BatchedEnvironment")
+        .def(py::init<int, int, const py::object&, bool, bool>(), py::arg("num_envs"), py::arg("N"),
+             py::arg("feature_history") = py::none(), py::arg("side_to_move") = true, py::arg("legal_moves") = true,
+             "With feature_history set (0..8 last-move planes), also maintains AlphaZero-style "
+             "feature planes in `features`.")
+        .def("reset", &PyBatchedEnvironment::reset,
+             "Resets all environments; returns (observations, action_masks)")
+        .def("step", &PyBatchedEnvironment::step, py::arg("actions"),
+             "Steps all environments with an int32 array of actions; returns "
+             "(observations, action_masks, rewards, dones). Finished environments are reset "
+             "automatically. The GIL is released while stepping; do not step the same "
+             "environment from several Python threads at once.")
+        .def("try_step", &PyBatchedEnvironment::try_step, py::arg("actions"),
+             "Like step() but never raises for invalid actions: they are handled by the "
+             "invalid-action policy. Returns (observations, action_masks, rewards, dones, "
+             "statuses) with statuses 0 ok, 1 out of bounds, 2 occupied.")
+        .def("set_invalid_action_policy", &PyBatchedEnvironment::set_invalid_action_policy,
+             py::arg("policy"), py::arg("penalty") = -1.0f, py::arg("seed") = 0,
+             "Sets how try_step handles invalid actions: 'reject' (no move, reward 0), "
+             "'penalize' (episode ends as a loss with the penalty reward) or 'resample' "
+             "(a random legal move is played instead).")
+        .def("save_snapshot", &PyBatchedEnvironment::save_snapshot,
+             "Returns the complete batch state (boards, players to move, move history, "
+             "counters, RNG seeds and step buffers) as bytes. Reward functions are not included.")
+        .def("load_snapshot", &PyBatchedEnvironment::load_snapshot, py::arg("snapshot"),
+             "Restores a save_snapshot() result into this environment in place; stepping then "
+             "continues bit-identically. Raises ValueError for a snapshot of another batch "
+             "shape or feature configuration and RuntimeError for corrupt data.")
+        .def("save_checkpoint",
+             [](const PyBatchedEnvironment& self, const std::string& path) { self.env->save_checkpoint(path); },
+             py::arg("path"), "Writes save_snapshot() to a file")
+        .def("load_checkpoint", &PyBatchedEnvironment::load_checkpoint, py::arg("path"),
+             "Restores a file written by save_checkpoint()")
+        .def("set_symmetry_augmentation",
+             [](PyBatchedEnvironment& self, bool enabled, uint64_t seed) { self.env->set_symmetry_augmentation(enabled, seed); },
+             py::arg("enabled"), py::arg("seed") = 0,
+             "Writes observations and action masks under a random board symmetry per "
+             "environment, redrawn at every reset and step; see `symmetries`.")
+        .def("transform_policies",
+             [](const PyBatchedEnvironment& self, const py::array_t<float, py::array::c_style | py::array::forcecast>& p) {
+                 return self.map_policies(p, false);
+             },
+             py::arg("policies"),
+             "Maps [B, N*N] environment-frame policy targets to the frame of the current observations")
+        .def("inverse_transform_policies",
+             [](const PyBatchedEnvironment& self, const py::array_t<float, py::array::c_style | py::array::forcecast>& p) {
+                 return self.map_policies(p, true);
+             },
+             py::arg("policies"),
+             "Maps [B, N*N] policies on the current observations back to the environments' frame")
+        .def("inverse_transform_actions", &PyBatchedEnvironment::inverse_transform_actions, py::arg("actions"),
+             "Maps actions chosen on the current observations to environment cells for step()")
+        .def("set_reward_fn", &PyBatchedEnvironment::set_reward_fn, py::arg("fn"),
+             "Registers fn(boards, actions, outcomes) -> float32[B], called once per step with "
+             "the GIL held only for that call. The arguments are views valid only during the "
+             "call; outcomes are 0 ongoing, 1 player 1 win, -1 player 2 win, 2 draw. "
+             "Pass None to remove.")
+        .def_property_readonly("num_envs", [](const PyBatchedEnvironment& self) { return self.env->get_num_envs(); })
+        .def_property_readonly("board_size", [](const PyBatchedEnvironment& self) { return self.env->get_board_size(); })
+        .def_readonly("observations", &PyBatchedEnvironment::observations, "float32 view [B, 2, N, N]")
+        .def_readonly("action_masks", &PyBatchedEnvironment::action_masks, "uint8 view [B, N*N]")
+        .def_readonly("rewards", &PyBatchedEnvironment::rewards, "float32 view [B]")
+        .def_readonly("dones", &PyBatchedEnvironment::dones, "uint8 view [B]")
+        .def_readonly("boards", &PyBatchedEnvironment::boards, "int8 view [B, N, N] of the boards after the last move")
+        .def_readonly("outcomes", &PyBatchedEnvironment::outcomes, "int8 view [B] of the last step's outcomes")
+        .def_readonly("statuses", &PyBatchedEnvironment::statuses, "uint8 view [B] of the last try_step's status codes")
+        .def_readonly("features", &PyBatchedEnvironment::features,
+                      "float32 view [B, P, N, N] of the feature planes, or None without feature_history")
+        .def_readonly("symmetries", &PyBatchedEnvironment::symmetries, "uint8 view [B] of the symmetry applied to the current observations");
+
+    py::class_<PyMixedBatchedEnvironment>(m, "MixedBatchedEnvironment")
+        .def(py::init<int, int>(), py::arg("num_envs"), py::arg("max_N"))
+        .def("set_board_sizes", &PyMixedBatchedEnvironment::set_board_sizes, py::arg("sizes"),
+             "Requests a board size (1..max_N) per environment. Each environment switches "
+             "when its episode ends; reset() applies the whole mix at once.")
+        .def("reset", &PyMixedBatchedEnvironment::reset,
+             "Resets all environments at their requested sizes; returns (observations, action_masks)")
+        .def("step", &PyMixedBatchedEnvironment::step, py::arg("actions"),
+             "Steps all environments with padded actions (row * max_N + col); returns "
+             "(observations, action_masks, rewards, dones). Padding cells are never legal.")
+        .def_property_readonly("num_envs", [](const PyMixedBatchedEnvironment& self) { return self.env->get_num_envs(); })
+        .def_property_readonly("max_board_size", [](const PyMixedBatchedEnvironment& self) { return self.env->get_max_board_size(); })
+        .def_readonly("observations", &PyMixedBatchedEnvironment::observations, "float32 view [B, 2, max_N, max_N]")
+        .def_readonly("action_masks", &PyMixedBatchedEnvironment::action_masks, "uint8 view [B, max_N*max_N]")
+        .def_readonly("cell_masks", &PyMixedBatchedEnvironment::cell_masks, "uint8 view [B, max_N, max_N], 1 on the board")
+        .def_readonly("board_sizes", &PyMixedBatchedEnvironment::board_sizes, "int32 view [B] of the current board sizes")
+        .def_readonly("rewards", &PyMixedBatchedEnvironment::rewards, "float32 view [B]")
+        .def_readonly("dones", &PyMixedBatchedEnvironment::dones, "uint8 view [B]")
+        .def_readonly("boards", &PyMixedBatchedEnvironment::boards, "int8 view [B, max_N, max_N] of the boards after the last move")
+        .def_readonly("outcomes", &PyMixedBatchedEnvironment::outcomes, "int8 view [B] of the last step's outcomes");
+}
@@ -0,0 +1,445 @@
+#include "differential_fuzz.h"
+#include "batched_environment.h"
+#include "rng.h"
+#include "sharded_environment.h"
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace {
+
+// Which Environment entry point an EnvironmentEngine drives
+enum class EnvMode {
+    StepResult,  // step(action) -> StepResult, the reference
+    StepInto,    // step(action, out) reusing the StepResult
+    InPlace,     // step_in_place(action, reward, done)
+    TryStep      // try_step(action, reward, done)
+};
+
+// One Environment per game, with the auto-reset of the batched environments
+class EnvironmentEngine : public FuzzEngine {
+public:
+    EnvironmentEngine(int num_games, int N, std::shared_ptr<RewardCallback> reward_fn, EnvMode mode)
+        : N(N), mode(mode), results(num_games),
+          board_buf(static_cast<size_t>(num_games) * N * N), done_buf(num_games), reward_buf(num_games),
+          mask_buf(static_cast<size_t>(num_games) * N * N) {
+        envs.reserve(num_games);
+        for (int i = 0; i < num_games; ++i) {
+            envs.emplace_back(N, reward_fn);
+        }
+    }
+
+    void reset() override {
+        for (size_t i = 0; i < envs.size(); ++i) {
+            if (mode == EnvMode::StepResult) {
+                envs[i].reset();
+            } else {
+                envs[i].reset_in_place();
+            }
+            envs[i].write_action_mask(mask_buf.data() + i * N * N);
+        }
+        std::fill(board_buf.begin(), board_buf.end(), 0);
+        std::fill(done_buf.begin(), done_buf.end(), 0);
+        std::fill(reward_buf.begin(), reward_buf.end(), 0.0f);
+    }
+
+    void step(const int32_t* actions) override {
+        const size_t cells = static_cast<size_t>(N) * N;
+        for (size_t i = 0; i < envs.size(); ++i) {
+            Environment& env = envs[i];
+            const std::vector<int>* board = &env.get_state().cells;
+            float reward = 0.0f;
+            bool done = false;
+            switch (mode) {
+                case EnvMode::StepResult: {
+                    results[i] = env.step(Action{actions[i]});
+                    board = &results[i].next_state.cells;
+                    reward = results[i].reward;
+                    done = results[i].done;
+                    break;
+                }
+                case EnvMode::StepInto:
+                    env.step(Action{actions[i]}, results[i]);
+                    board = &results[i].next_state.cells;
+                    reward = results[i].reward;
+                    done = results[i].done;
+                    break;
+                case EnvMode::InPlace:
+                    env.step_in_place(Action{actions[i]}, reward, done);
+                    break;
+                case EnvMode::TryStep:
+                    // A rejected action leaves the board unchanged, which the comparison reports
+                    env.try_step(Action{actions[i]}, reward, done);
+                    break;
+            }
+            for (size_t c = 0; c < cells; ++c) {
+                board_buf[i * cells + c] = static_cast<int8_t>((*board)[c]);
+            }
+            done_buf[i] = done ? 1 : 0;
+            reward_buf[i] = reward;
+            if (done) {
+                env.reset_in_place();
+            }
+            env.write_action_mask(mask_buf.data() + i * cells);
+        }
+    }
+
+    const int8_t* boards() const override { return board_buf.data(); }
+    const uint8_t* dones() const override { return done_buf.data(); }
+    const float* rewards() const override { return reward_buf.data(); }
+    const uint8_t* masks() const override { return mask_buf.data(); }
+
+private:
+    int N;
+    EnvMode mode;
+    std::vector<Environment> envs;
+    std::vector<StepResult> results;
+    std::vector<int8_t> board_buf;
+    std::vector<uint8_t> done_buf;
+    std::vector<float> reward_buf;
+    std::vector<uint8_t> mask_buf;
+};
+
+// Adapter for the batched environments, which already expose the compared buffers
+template <typename Batch>
+class BatchEngine : public FuzzEngine {
+public:
+    explicit BatchEngine(std::unique_ptr<Batch> batch, bool use_try_step = false)
+        : batch(std::move(batch)), use_try_step(use_try_step) {}
+
+    void reset() override { batch->reset(); }
+
+    void step(const int32_t* actions) override {
+        if constexpr (std::is_same_v<Batch, BatchedEnvironment>) {
+            if (use_try_step) {
+                batch->try_step(actions);
+                return;
+            }
+        }
+        batch->step(actions);
+    }
+
+    const int8_t* boards() const override { return batch->get_boards(); }
+    const uint8_t* dones() const override { return batch->get_dones(); }
+    const float* rewards() const override { return batch->get_rewards(); }
+    const uint8_t* masks() const override { return batch->get_action_masks(); }
+
+private:
+    std::unique_ptr<Batch> batch;
+    bool use_try_step;
+};
+
+FuzzEngineFactory environment_factory(EnvMode mode) {
+    return [mode](int num_games, int N, std::shared_ptr<RewardCallback> reward_fn) -> std::unique_ptr<FuzzEngine> {
+        return std::make_unique<EnvironmentEngine>(num_games, N, std::move(reward_fn), mode);
+    };
+}
+
+// First difference between the reference and an engine for game g, filled into d
+bool compare_game(const FuzzEngine& reference, const FuzzEngine& engine, int g, int N, Divergence& d) {
+    const size_t cells = static_cast<size_t>(N) * N;
+    const size_t row = static_cast<size_t>(g) * cells;
+    for (size_t c = 0; c < cells; ++c) {
+        if (reference.boards()[row + c] != engine.boards()[row + c]) {
+            d.field = "board";
+            d.cell = static_cast<int>(c);
+            d.expected = std::to_string(reference.boards()[row + c]);
+            d.actual = std::to_string(engine.boards()[row + c]);
+            return true;
+        }
+    }
+    if (reference.dones()[g] != engine.dones()[g]) {
+        d.field = "done";
+        d.expected = std::to_string(reference.dones()[g]);
+        d.actual = std::to_string(engine.dones()[g]);
+        return true;
+    }
+    if (reference.rewards()[g] != engine.rewards()[g]) {
+        std::ostringstream expected, actual;
+        expected.precision(9);
+        actual.precision(9);
+        expected << reference.rewards()[g];
+        actual << engine.rewards()[g];
+        d.field = "reward";
+        d.expected = expected.str();
+        d.actual = actual.str();
+        return true;
+    }
+    for (size_t c = 0; c < cells; ++c) {
+        if (reference.masks()[row + c] != engine.masks()[row + c]) {
+            d.field = "mask";
+            d.cell = static_cast<int>(c);
+            d.expected = std::to_string(reference.masks()[row + c]);
+            d.actual = std::to_string(engine.masks()[row + c]);
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+std::vector<FuzzTarget> builtin_fuzz_targets() {
+    std::vector<FuzzTarget> targets;
+    targets.push_back({"Environment::step(out)", environment_factory(EnvMode::StepInto)});
+    targets.push_back({"Environment::step_in_place", environment_factory(EnvMode::InPlace)});
+    targets.push_back({"Environment::try_step", environment_factory(EnvMode::TryStep)});
+    targets.push_back({"BatchedEnvironment::step",
+                       [](int num_games, int N, std::shared_ptr<RewardCallback> reward_fn) -> std::unique_ptr<FuzzEngine> {
+                           return std::make_unique<BatchEngine<BatchedEnvironment>>(
+                               std::make_unique<BatchedEnvironment>(num_games, N, std::move(reward_fn)));
+                       }});
+    targets.push_back({"BatchedEnvironment::try_step",
+                       [](int num_games, int N, std::shared_ptr<RewardCallback> reward_fn) -> std::unique_ptr<FuzzEngine> {
+                           return std::make_unique<BatchEngine<BatchedEnvironment>>(
+                               std::make_unique<BatchedEnvironment>(num_games, N, std::move(reward_fn)), true);
+                       }});
+    // Every slot at max_N, so the padded layout coincides with the dense one
+    targets.push_back({"MixedBatchedEnvironment::step",
+                       [](int num_games, int N, std::shared_ptr<RewardCallback> reward_fn) -> std::unique_ptr<FuzzEngine> {
+                           return std::make_unique<BatchEngine<MixedBatchedEnvironment>>(
+                               std::make_unique<MixedBatchedEnvironment>(num_games, N, std::move(reward_fn)));
+                       }});
+    targets.push_back({"ShardedBatchedEnvironment::step",
+                       [](int num_games, int N, std::shared_ptr<RewardCallback> reward_fn) -> std::unique_ptr<FuzzEngine> {
+                           ShardedEnvConfig config;
+                           config.num_shards = 2;
+                           return std::make_unique<BatchEngine<ShardedBatchedEnvironment>>(
+                               std::make_unique<ShardedBatchedEnvironment>(num_games, N, std::move(reward_fn), config));
+                       }});
+    return targets;
+}
+
+std::unique_ptr<FuzzEngine> make_reference_engine(int num_games, int N, std::shared_ptr<RewardCallback> reward_fn) {
+    return std::make_unique<EnvironmentEngine>(num_games, N, std::move(reward_fn), EnvMode::StepResult);
+}
+
+float FuzzReward::operator()(const BoardState& state, const Action& action) {
+    // FNV-1a over the cells and the action
+    uint32_t h = 2166136261u;
+    for (int cell : state.cells) {
+        h = (h ^ static_cast<uint32_t>(cell + 2)) * 16777619u;
+    }
+    h = (h ^ static_cast<uint32_t>(action.index)) * 16777619u;
+    return static_cast<float>(h >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+std::string Divergence::describe() const {
+    std::ostringstream out;
+    out << engine << " diverged on " << field;
+    if (cell >= 0) out << " cell " << cell;
+    out << " after move " << actions.size() << " (N=" << N << ", minimized from " << original_length << " moves): ";
+    if (field == "exception") {
+        out << "threw \"" << actual << '"';
+    } else {
+        out << "expected " << expected << ", got " << actual;
+    }
+    out << "; actions:";
+    for (int32_t a : actions) out << ' ' << a;
+    return out.str();
+}
+
+DifferentialFuzzer::DifferentialFuzzer(const DiffFuzzConfig& config)
+    : config(config), reward_fn(std::make_shared<FuzzReward>()) {
+    if (config.board_sizes.empty()) {
+        throw std::invalid_argument("Need at least one board size to fuzz");
+    }
+    for (int N : config.board_sizes) {
+        if (N <= 0) throw std::invalid_argument("Board size must be positive");
+    }
+    if (config.num_games <= 0 || config.steps_per_round <= 0 || config.rounds < 0) {
+        throw std::invalid_argument("Fuzzing needs positive games and steps per round and non-negative rounds");
+    }
+    if (config.max_replays < 0) {
+        throw std::invalid_argument("Replay budget must not be negative");
+    }
+}
+
+void DifferentialFuzzer::add_target(FuzzTarget target) {
+    if (!target.make) {
+        throw std::invalid_argument("Fuzz target needs an engine factory");
+    }
+    targets.push_back(std::move(target));
+}
+
+void DifferentialFuzzer::add_builtin_targets() {
+    for (FuzzTarget& target : builtin_fuzz_targets()) {
+        add_target(std::move(target));
+    }
+}
+
+DiffFuzzReport DifferentialFuzzer::run() {
+    DiffFuzzReport report;
+    const CounterRng rng(config.seed);
+    const int B = config.num_games;
+    std::vector<bool> diverged(targets.size(), false);
+    auto start = std::chrono::steady_clock::now();
+
+    for (int round = 0; round < config.rounds; ++round) {
+        const int N = config.board_sizes[round % config.board_sizes.size()];
+        const size_t cells = static_cast<size_t>(N) * N;
+        std::unique_ptr<FuzzEngine> reference = make_reference_engine(B, N, reward_fn);
+        reference->reset();
+        std::vector<std::unique_ptr<FuzzEngine>> engines(targets.size());
+        std::vector<std::vector<int32_t>> history(B);
+        std::vector<int32_t> actions(B);
+
+        auto record = [&](size_t t, Divergence d) {
+            d.engine = targets[t].name;
+            d.N = N;
+            d.original_length = static_cast<int>(d.actions.size());
+            if (config.minimize) d = minimize(targets[t], d);
+            report.divergences.push_back(std::move(d));
+            diverged[t] = true;
+            engines[t].reset();
+        };
+        // Compares every game, reporting the first divergence of engine t
+        auto check = [&](size_t t) {
+            for (int g = 0; g < B; ++g) {
+                Divergence d;
+                if (compare_game(*reference, *engines[t], g, N, d)) {
+                    d.actions = history[g];
+                    record(t, std::move(d));
+                    return;
+                }
+            }
+        };
+        // An exception does not say which game caused it: replay each game alone
+        auto record_exception = [&](size_t t, const std::exception& e) {
+            for (int g = 0; g < B; ++g) {
+                std::optional<Divergence> d = replay(targets[t], N, history[g]);
+                if (d) {
+                    record(t, std::move(*d));
+                    return;
+                }
+            }
+            Divergence d;
+            d.field = "exception";
+            d.actual = e.what();
+            record(t, std::move(d));
+        };
+
+        for (size_t t = 0; t < targets.size(); ++t) {
+            if (diverged[t]) continue;
+            engines[t] = targets[t].make(B, N, reward_fn);
+            try {
+                engines[t]->reset();
+            } catch (const std::exception& e) {
+                record_exception(t, e);
+                continue;
+            }
+            check(t);
+        }
+
+        for (int step = 0; step < config.steps_per_round; ++step) {
+            const uint64_t counter = static_cast<uint64_t>(round) * config.steps_per_round + step;
+            const uint8_t* masks = reference->masks();
+            for (int g = 0; g < B; ++g) {
+                const uint8_t* mask = masks + g * cells;
+                const int legal = static_cast<int>(std::count(mask, mask + cells, 1));
+                int pick = static_cast<int>(rng.below(legal, g, counter, kFuzzDraw));
+                int a = 0;
+                while (!mask[a] || pick-- > 0) ++a;
+                actions[g] = a;
+                history[g].push_back(a);
+            }
+            reference->step(actions.data());
+            for (int g = 0; g < B; ++g) report.games += reference->dones()[g];
+
+            for (size_t t = 0; t < targets.size(); ++t) {
+                if (!engines[t]) continue;
+                try {
+                    engines[t]->step(actions.data());
+                } catch (const std::exception& e) {
+                    record_exception(t, e);
+                    continue;
+                }
+                check(t);
+                report.steps += B;
+            }
+        }
+    }
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
+
+std::optional<Divergence> DifferentialFuzzer::replay(const FuzzTarget& target, int N,
+                                                     const std::vector<int32_t>& actions) const {
+    const int cells = N * N;
+    std::unique_ptr<FuzzEngine> reference = make_reference_engine(1, N, reward_fn);
+    std::unique_ptr<FuzzEngine> engine = target.make(1, N, reward_fn);
+    reference->reset();
+    Divergence d;
+    d.engine = target.name;
+    d.N = N;
+    d.original_length = static_cast<int>(actions.size());
+    try {
+        engine->reset();
+    } catch (const std::exception& e) {
+        d.field = "exception";
+        d.actual = e.what();
+        return d;
+    }
+    if (compare_game(*reference, *engine, 0, N, d)) return d;
+
+    for (size_t k = 0; k < actions.size(); ++k) {
+        const int32_t a = actions[k];
+        if (a < 0 || a >= cells || !reference->masks()[a]) {
+            throw std::invalid_argument("Replayed action " + std::to_string(a) + " is illegal at move " +
+                                        std::to_string(k));
+        }
+        reference->step(&a);
+        d.actions.assign(actions.begin(), actions.begin() + k + 1);
+        try {
+            engine->step(&a);
+        } catch (const std::exception& e) {
+            d.field = "exception";
+            d.expected.clear();
+            d.actual = e.what();
+            return d;
+        }
+        if (compare_game(*reference, *engine, 0, N, d)) return d;
+    }
+    return std::nullopt;
+}
+
+Divergence DifferentialFuzzer::minimize(const FuzzTarget& target, const Divergence& divergence) const {
+    Divergence best = divergence;
+    int replays = 0;
+    // A candidate that stays legal and diverges replaces best, cut at its first divergence
+    auto attempt = [&](const std::vector<int32_t>& candidate) {
+        replays++;
+        try {
+            std::optional<Divergence> d = replay(target, best.N, candidate);
+            if (!d) return false;
+            d->original_length = best.original_length;
+            best = std::move(*d);
+            return true;
+        } catch (const std::invalid_argument&) {
+            return false;
+        }
+    };
+
+    size_t chunk = std::max<size_t>(1, best.actions.size() / 2);
+    while (!best.actions.empty() && replays < config.max_replays) {
+        bool removed = false;
+        for (size_t begin = 0; begin < best.actions.size() && replays < config.max_replays;) {
+            std::vector<int32_t> candidate = best.actions;
+            candidate.erase(candidate.begin() + begin,
+                            candidate.begin() + std::min(begin + chunk, candidate.size()));
+            if (attempt(candidate)) {
+                removed = true;
+            } else {
+                begin += chunk;
+            }
+        }
+        if (!removed) {
+            if (chunk == 1) break;
+            chunk /= 2;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,359 @@
+#include "env_server.h"
+
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared-memory counters must be lock-free");
+
+namespace {
+
+constexpr uint32_t kSegmentMagic = 0x54545345;  // "ESTT"
+constexpr uint32_t kSegmentVersion = 1;
+constexpr size_t kAlign = 64;
+constexpr int kSpinIterations = 2000;
+
+enum : uint32_t { OP_STEP = 0, OP_RESET = 1 };
+enum : int32_t { STATUS_OK = 0, STATUS_INVALID_ACTION = 1 };
+
+size_t align_up(size_t value) {
+    return (value + kAlign - 1) / kAlign * kAlign;
+}
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+// Shared (not FUTEX_PRIVATE) futex operations, since waiters live in other processes
+void futex_wait(std::atomic<uint32_t>* word, uint32_t expected) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected, nullptr, nullptr, 0);
+}
+
+void futex_wake(std::atomic<uint32_t>* word, int count) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, count, nullptr, nullptr, 0);
+}
+
+// Blocks until *word != value, spinning briefly before sleeping
+uint32_t wait_for_change(std::atomic<uint32_t>* word, uint32_t value) {
+    uint32_t current = word->load(std::memory_order_acquire);
+    for (int i = 0; i < kSpinIterations && current == value; ++i) {
+        cpu_relax();
+        current = word->load(std::memory_order_acquire);
+    }
+    while (current == value) {
+        futex_wait(word, value);
+        current = word->load(std::memory_order_acquire);
+    }
+    return current;
+}
+
+// Per-slot layout: op/status header, then actions and results, each 64-byte aligned
+struct SlotLayout {
+    size_t actions;
+    size_t observations;
+    size_t action_masks;
+    size_t rewards;
+    size_t dones;
+    size_t size;
+
+    SlotLayout(int B, int N) {
+        const size_t cells = static_cast<size_t>(N) * N;
+        actions = kAlign;
+        observations = actions + align_up(B * sizeof(int32_t));
+        action_masks = observations + align_up(B * 2 * cells * sizeof(float));
+        rewards = action_masks + align_up(B * cells);
+        dones = rewards + align_up(B * sizeof(float));
+        size = dones + align_up(B);
+    }
+};
+
+struct SlotHeader {
+    uint32_t op;
+    int32_t status;
+};
+
+}  // namespace
+
+struct ShmSegmentHeader {
+    uint32_t magic;
+    uint32_t version;
+    int32_t num_channels;
+    int32_t envs_per_channel;
+    int32_t N;
+    int32_t ring_slots;
+    uint64_t channel_stride;
+    uint64_t slot_stride;
+    alignas(kAlign) std::atomic<uint32_t> doorbell;   // bumped by clients after every request
+    std::atomic<uint32_t> shutdown;
+};
+
+struct ShmChannelHeader {
+    alignas(kAlign) std::atomic<uint32_t> request_seq;   // written by the client
+    std::atomic<uint32_t> claimed;
+    alignas(kAlign) std::atomic<uint32_t> response_seq;  // written by the server
+};
+
+namespace {
+
+size_t channels_offset() {
+    return align_up(sizeof(ShmSegmentHeader));
+}
+
+ShmChannelHeader* channel_at(uint8_t* base, const ShmSegmentHeader* header, int channel) {
+    return reinterpret_cast<ShmChannelHeader*>(base + channels_offset() + channel * header->channel_stride);
+}
+
+uint8_t* slot_at(uint8_t* base, const ShmSegmentHeader* header, int channel, uint32_t ticket) {
+    return reinterpret_cast<uint8_t*>(channel_at(base, header, channel)) + align_up(sizeof(ShmChannelHeader)) +
+           (ticket % header->ring_slots) * header->slot_stride;
+}
+
+std::string segment_name(const std::string& name) {
+    return name.empty() || name[0] != '/' ? "/" + name : name;
+}
+
+}  // namespace
+
+EnvServer::EnvServer(const std::string& name, int num_channels, int envs_per_channel, int N, int ring_slots,
+                     bool force)
+    : name(segment_name(name)), segment_size(0), base(nullptr), header(nullptr) {
+    if (num_channels <= 0 || envs_per_channel <= 0 || N <= 0 || ring_slots <= 0) {
+        throw std::invalid_argument("Server dimensions must be positive");
+    }
+
+    const SlotLayout layout(envs_per_channel, N);
+    const size_t channel_stride = align_up(sizeof(ShmChannelHeader)) + ring_slots * layout.size;
+    segment_size = channels_offset() + num_channels * channel_stride;
+
+    if (force) shm_unlink(this->name.c_str());
+    int fd = shm_open(this->name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 && errno == EEXIST) {
+        throw std::runtime_error("Segment " + this->name + " already exists (another server is running, "
+                                 "or pass force to replace a stale one)");
+    }
+    if (fd < 0) {
+        throw std::runtime_error("shm_open failed for " + this->name + ": " + std::strerror(errno));
+    }
+    if (ftruncate(fd, static_cast<off_t>(segment_size)) != 0) {
+        close(fd);
+        shm_unlink(this->name.c_str());
+        throw std::runtime_error("ftruncate failed for " + this->name + ": " + std::strerror(errno));
+    }
+    void* mapped = mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        shm_unlink(this->name.c_str());
+        throw std::runtime_error("mmap failed for " + this->name + ": " + std::strerror(errno));
+    }
+    base = static_cast<uint8_t*>(mapped);
+
+    // ftruncate zero-fills, so all counters start at 0
+    header = new (base) ShmSegmentHeader();
+    header->num_channels = num_channels;
+    header->envs_per_channel = envs_per_channel;
+    header->N = N;
+    header->ring_slots = ring_slots;
+    header->channel_stride = channel_stride;
+    header->slot_stride = layout.size;
+    for (int c = 0; c < num_channels; ++c) {
+        new (channel_at(base, header, c)) ShmChannelHeader();
+        envs.push_back(std::make_unique<BatchedEnvironment>(envs_per_channel, N, std::make_shared<DefaultReward>()));
+        envs.back()->reset();
+    }
+    handled.assign(num_channels, 0);
+
+    // Publish the header last; clients refuse to attach until the magic is visible
+    header->version = kSegmentVersion;
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = kSegmentMagic;
+}
+
+EnvServer::~EnvServer() {
+    if (base != nullptr) {
+        munmap(base, segment_size);
+        shm_unlink(name.c_str());
+    }
+}
+
+void EnvServer::handle(int channel, uint32_t request) {
+    const SlotLayout layout(header->envs_per_channel, header->N);
+    uint8_t* slot = slot_at(base, header, channel, request);
+    SlotHeader* slot_header = reinterpret_cast<SlotHeader*>(slot);
+    BatchedEnvironment& env = *envs[channel];
+
+    slot_header->status = STATUS_OK;
+    // BatchedEnvironment::step checks the whole row before moving any environment, so a
+    // rejected request leaves the channel's batch exactly as it was
+    try {
+        if (slot_header->op == OP_RESET) {
+            env.reset();
+        } else {
+            env.step(reinterpret_cast<const int32_t*>(slot + layout.actions));
+        }
+    } catch (const std::invalid_argument&) {
+        slot_header->status = STATUS_INVALID_ACTION;
+    }
+
+    const size_t B = header->envs_per_channel;
+    const size_t cells = static_cast<size_t>(header->N) * header->N;
+    std::memcpy(slot + layout.observations, env.get_observations(), B * 2 * cells * sizeof(float));
+    std::memcpy(slot + layout.action_masks, env.get_action_masks(), B * cells);
+    std::memcpy(slot + layout.rewards, env.get_rewards(), B * sizeof(float));
+    std::memcpy(slot + layout.dones, env.get_dones(), B);
+
+    ShmChannelHeader* ch = channel_at(base, header, channel);
+    ch->response_seq.store(request + 1, std::memory_order_release);
+    futex_wake(&ch->response_seq, INT_MAX);
+}
+
+int EnvServer::poll() {
+    int count = 0;
+    for (int c = 0; c < header->num_channels; ++c) {
+        const uint32_t requested = channel_at(base, header, c)->request_seq.load(std::memory_order_acquire);
+        while (handled[c] != requested) {
+            handle(c, handled[c]);
+            handled[c]++;
+            count++;
+        }
+    }
+    return count;
+}
+
+void EnvServer::serve() {
+    while (!header->shutdown.load(std::memory_order_acquire)) {
+        // Read the doorbell before scanning so a request that arrives mid-scan changes it
+        const uint32_t bell = header->doorbell.load(std::memory_order_acquire);
+        if (poll() > 0) {
+            continue;
+        }
+        wait_for_change(&header->doorbell, bell);
+    }
+}
+
+void EnvServer::stop() {
+    header->shutdown.store(1, std::memory_order_release);
+    header->doorbell.fetch_add(1, std::memory_order_release);
+    futex_wake(&header->doorbell, INT_MAX);
+}
+
+EnvClient::EnvClient(const std::string& name, int channel)
+    : segment_size(0), base(nullptr), header(nullptr), channel_header(nullptr), channel(channel) {
+    const std::string full_name = segment_name(name);
+    int fd = shm_open(full_name.c_str(), O_RDWR, 0600);
+    if (fd < 0) {
+        throw std::runtime_error("No environment server at " + full_name + ": " + std::strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(ShmSegmentHeader)) {
+        close(fd);
+        throw std::runtime_error("Environment server segment is not initialized: " + full_name);
+    }
+    segment_size = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        throw std::runtime_error("mmap failed for " + full_name + ": " + std::strerror(errno));
+    }
+    base = static_cast<uint8_t*>(mapped);
+    header = reinterpret_cast<ShmSegmentHeader*>(base);
+
+    if (header->magic != kSegmentMagic || header->version != kSegmentVersion) {
+        munmap(base, segment_size);
+        throw std::runtime_error("Incompatible environment server segment: " + full_name);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (channel < 0 || channel >= header->num_channels) {
+        munmap(base, segment_size);
+        throw std::invalid_argument("Channel index out of range");
+    }
+
+    channel_header = channel_at(base, header, channel);
+    if (channel_header->claimed.exchange(1, std::memory_order_acq_rel) != 0) {
+        munmap(base, segment_size);
+        throw std::runtime_error("Channel already in use by another client");
+    }
+    num_envs = header->envs_per_channel;
+    N = header->N;
+    ring_slots = header->ring_slots;
+    submitted = channel_header->request_seq.load(std::memory_order_acquire);
+    // Drain anything a previous client left in flight on this channel
+    uint32_t response = channel_header->response_seq.load(std::memory_order_acquire);
+    while (response != submitted) {
+        response = wait_for_change(&channel_header->response_seq, response);
+    }
+}
+
+EnvClient::~EnvClient() {
+    if (base != nullptr) {
+        channel_header->claimed.store(0, std::memory_order_release);
+        munmap(base, segment_size);
+    }
+}
+
+uint32_t EnvClient::submit(uint32_t op, const int32_t* actions) {
+    const uint32_t ticket = submitted;
+
+    // The slot is reused every ring_slots requests; wait until its previous request is
+    // done. That request's status is not checked: its errors belong to wait() on its own
+    // ticket, not to this submit.
+    if (ticket - channel_header->response_seq.load(std::memory_order_acquire) >= static_cast<uint32_t>(ring_slots)) {
+        wait_done(ticket - ring_slots);
+    }
+
+    uint8_t* slot = slot_at(base, header, channel, ticket);
+    reinterpret_cast<SlotHeader*>(slot)->op = op;
+    if (actions != nullptr) {
+        const SlotLayout layout(num_envs, N);
+        std::memcpy(slot + layout.actions, actions, num_envs * sizeof(int32_t));
+    }
+
+    submitted = ticket + 1;
+    channel_header->request_seq.store(submitted, std::memory_order_release);
+    header->doorbell.fetch_add(1, std::memory_order_release);
+    futex_wake(&header->doorbell, 1);
+    return ticket;
+}
+
+uint32_t EnvClient::submit_step(const int32_t* actions) {
+    return submit(OP_STEP, actions);
+}
+
+uint32_t EnvClient::submit_reset() {
+    return submit(OP_RESET, nullptr);
+}
+
+void EnvClient::wait_done(uint32_t ticket) {
+    // Wrap-safe "response_seq <= ticket"
+    uint32_t response = channel_header->response_seq.load(std::memory_order_acquire);
+    while (static_cast<int32_t>(response - ticket) <= 0) {
+        response = wait_for_change(&channel_header->response_seq, response);
+    }
+}
+
+EnvStepView EnvClient::wait(uint32_t ticket) {
+    wait_done(ticket);
+
+    const SlotLayout layout(num_envs, N);
+    const uint8_t* slot = slot_at(base, header, channel, ticket);
+    if (reinterpret_cast<const SlotHeader*>(slot)->status == STATUS_INVALID_ACTION) {
+        throw std::invalid_argument("Environment server rejected an invalid action");
+    }
+    return EnvStepView{
+        reinterpret_cast<const float*>(slot + layout.observations),
+        slot + layout.action_masks,
+        reinterpret_cast<const float*>(slot + layout.rewards),
+        slot + layout.dones,
+    };
+}
@@ -1,49 +1,113 @@
 #include "environment.h"
+#include "step_profiler.h"
+
+#include <algorithm>
+#include <cstring>
 
 Environment::Environment(int N, std::shared_ptr<RewardCallback> reward_fn) : reward_fn(reward_fn) {
     current_state.N = N;
     current_state.cells = std::vector<int>(N * N, 0);
     current_player = 1;  // Start with player 1
+    winner = 0;
+    recent_moves.fill(-1);
+    move_count = 0;
 }
 
 BoardState Environment::reset() {
-    current_state.cells.assign(current_state.N * current_state.N, 0);
-    current_player = 1;  // Reset to player 1
+    reset_in_place();
     return current_state;
 }
 
+void Environment::reset_in_place() {
+    std::fill(current_state.cells.begin(), current_state.cells.end(), 0);
+    current_player = 1;  // Reset to player 1
+    winner = 0;
+    move_count = 0;
+    recent_moves.fill(-1);
+}
+
 StepResult Environment::step(const Action& action) {
-    // Validate action index bounds
-    if (action.index < 0 || action.index >= current_state.N * current_state.N) {
+    float reward;
+    bool done;
+    step_in_place(action, reward, done);
+    TICTACTOE_STEP_SCOPE(StepPhase::ResultCopy);
+    return StepResult{current_state, reward, done};
+}
+
+void Environment::step(const Action& action, StepResult& out) {
+    step_in_place(action, out.reward, out.done);
+    TICTACTOE_STEP_SCOPE(StepPhase::ResultCopy);
+    out.next_state.N = current_state.N;
+    // assign() reuses the existing capacity, so only the first call allocates
+    out.next_state.cells.assign(current_state.cells.begin(), current_state.cells.end());
+}
+
+void Environment::step_in_place(const Action& action, float& reward, bool& done) {
+    const StepStatus status = try_step(action, reward, done);
+    if (status == StepStatus::OutOfBounds) {
         throw std::invalid_argument("Action index out of bounds");
     }
-    
-    // Validate that the target cell is empty
-    if (current_state.cells[action.index] != 0) {
+    if (status == StepStatus::Occupied) {
         throw std::invalid_argument("Action targets an occupied cell");
     }
+}
+
+StepStatus Environment::try_step(const Action& action, float& reward, bool& done) {
+    TICTACTOE_STEP_COUNT();
+    {
+        TICTACTOE_STEP_SCOPE(StepPhase::Validation);
+        // One unsigned compare covers both ends of the bounds check
+        const unsigned cells = static_cast<unsigned>(current_state.N * current_state.N);
+        if (static_cast<unsigned>(action.index) >= cells) {
+            return StepStatus::OutOfBounds;
+        }
+        if (current_state.cells[action.index] != 0) {
+            return StepStatus::Occupied;
+        }
+    }
     
-    // Apply the action - set cell to current player
-    current_state.cells[action.index] = current_player;
+    {
+        TICTACTOE_STEP_SCOPE(StepPhase::Apply);
+        // Apply the action - set cell to current player
+        current_state.cells[action.index] = current_player;
+        recent_moves[move_count % kMoveHistory] = action.index;
+        move_count++;
+    }
     
     // Check for terminal conditions
-    bool done = false;
-    if (check_win(current_state, current_player)) {
+    done = false;
+    bool current_wins;
+    {
+        TICTACTOE_STEP_SCOPE(StepPhase::CheckWinCurrent);
+        current_wins = check_win(current_state, current_player);
+    }
+    if (current_wins) {
         done = true;  // Current player wins
-    } else if (check_win(current_state, -current_player)) {
-        done = true;  // Other player wins  
-    } else if (is_board_full(current_state)) {
-        done = true;  // Draw - board is full with no winner
+        winner = current_player;
+    } else {
+        bool other_wins;
+        {
+            TICTACTOE_STEP_SCOPE(StepPhase::CheckWinOther);
+            other_wins = check_win(current_state, -current_player);
+        }
+        if (other_wins) {
+            done = true;  // Other player wins  
+            winner = -current_player;
+        } else {
+            TICTACTOE_STEP_SCOPE(StepPhase::BoardFull);
+            done = is_board_full(current_state);  // Draw - board is full with no winner
+        }
     }
     
     // Call reward callback
-    float reward = (*reward_fn)(current_state, action);
-    StepResult result = {current_state, reward, done};
+    {
+        TICTACTOE_STEP_SCOPE(StepPhase::RewardCallback);
+        reward = (*reward_fn)(current_state, action);
+    }
     
     // Alternate to the next player
     current_player = -current_player;  // Switch between 1 and -1
-    
-    return result;
+    return StepStatus::Ok;
 }
 
 // Terminal detection helper methods
@@ -125,32 +189,88 @@ std::vector<bool> Environment::get_action_mask() const {
 
 std::vector<float> Environment::get_flattened_state() const {
     std::vector<float> flattened_state(current_state.N * current_state.N);
+    write_flattened_state(flattened_state.data());
+    return flattened_state;
+}
+
+void Environment::write_flattened_state(float* out) const {
     for (int i = 0; i < current_state.N * current_state.N; ++i) {
-        flattened_state[i] = static_cast<float>(current_state.cells[i]);
+        out[i] = static_cast<float>(current_state.cells[i]);
     }
-    return flattened_state;
-} 
+}
 
 // US2.2: One-Hot Encoding Option
 std::vector<float> Environment::get_one_hot_state() const {
-    const int N = current_state.N;
-    const int board_size = N * N;
-    
     // Create one-hot tensor with shape [2, N, N] flattened to 2*N*N
-    std::vector<float> one_hot(2 * board_size, 0.0f);
+    std::vector<float> one_hot(2 * current_state.N * current_state.N);
+    write_one_hot_state(one_hot.data());
+    return one_hot;
+}
+
+void Environment::write_one_hot_state(float* out) const {
+    const int board_size = current_state.N * current_state.N;
     
     for (int i = 0; i < board_size; ++i) {
         int cell_value = current_state.cells[i];
-        
-        if (cell_value == 1) {
-            // Player 1 channel (first N*N elements)
-            one_hot[i] = 1.0f;
-        } else if (cell_value == -1) {
-            // Player 2 channel (second N*N elements)
-            one_hot[board_size + i] = 1.0f;
-        }
-        // Empty cells (cell_value == 0) remain 0.0f in both channels
+        // Player 1 channel (first N*N elements), Player 2 channel (second N*N elements)
+        // Empty cells (cell_value == 0) are 0.0f in both channels
+        out[i] = (cell_value == 1) ? 1.0f : 0.0f;
+        out[board_size + i] = (cell_value == -1) ? 1.0f : 0.0f;
     }
-    
-    return one_hot;
-} 
\ No newline at end of file
+}
+
+void Environment::write_action_mask(uint8_t* out) const {
+    for (int i = 0; i < current_state.N * current_state.N; ++i) {
+        out[i] = (current_state.cells[i] == 0) ? 1 : 0;
+    }
+}
+
+// Snapshot layout: int8 player, int8 winner, 2 reserved bytes, int32 move count,
+// int32 recent_moves[kMoveHistory], then one int8 per cell
+void Environment::write_snapshot(uint8_t* out) const {
+    const int32_t count = move_count;
+    out[0] = static_cast<uint8_t>(static_cast<int8_t>(current_player));
+    out[1] = static_cast<uint8_t>(static_cast<int8_t>(winner));
+    out[2] = 0;
+    out[3] = 0;
+    std::memcpy(out + 4, &count, sizeof(count));
+    for (int k = 0; k < kMoveHistory; ++k) {
+        const int32_t move = recent_moves[k];
+        std::memcpy(out + 8 + 4 * k, &move, sizeof(move));
+    }
+    int8_t* cells = reinterpret_cast<int8_t*>(out + kSnapshotHeaderBytes);
+    for (size_t i = 0; i < current_state.cells.size(); ++i) {
+        cells[i] = static_cast<int8_t>(current_state.cells[i]);
+    }
+}
+
+void Environment::read_snapshot(const uint8_t* in) {
+    const int player = static_cast<int8_t>(in[0]);
+    const int won = static_cast<int8_t>(in[1]);
+    int32_t count;
+    std::memcpy(&count, in + 4, sizeof(count));
+    std::array<int, kMoveHistory> moves;
+    const int size = static_cast<int>(current_state.cells.size());
+    bool valid = (player == 1 || player == -1) && won >= -1 && won <= 1 && count >= 0;
+    for (int k = 0; k < kMoveHistory; ++k) {
+        int32_t move;
+        std::memcpy(&move, in + 8 + 4 * k, sizeof(move));
+        moves[k] = move;
+        valid = valid && move >= -1 && move < size;
+    }
+    const int8_t* cells = reinterpret_cast<const int8_t*>(in + kSnapshotHeaderBytes);
+    for (int i = 0; i < size; ++i) {
+        valid = valid && cells[i] >= -1 && cells[i] <= 1;
+    }
+    if (!valid) {
+        throw std::runtime_error("Corrupt environment snapshot");
+    }
+    // Validated before anything is assigned, so a bad snapshot leaves the environment as it was
+    current_player = player;
+    winner = won;
+    move_count = count;
+    recent_moves = moves;
+    for (int i = 0; i < size; ++i) {
+        current_state.cells[i] = cells[i];
+    }
+}
@@ -0,0 +1,312 @@
+#include "episode.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+void Episode::write_state_at(int t, int* out) const {
+    if (t < 0 || t > length) {
+        throw std::invalid_argument("Episode step out of range");
+    }
+    std::fill(out, out + N * N, 0);
+    int player = 1;
+    for (int k = 0; k < offset; ++k) {
+        out[history[k]] = player;
+        player = -player;
+    }
+    for (int k = 0; k < t; ++k) {
+        out[moves[k]] = player;
+        player = -player;
+    }
+}
+
+BoardState Episode::state_at(int t) const {
+    BoardState state{std::vector<int>(N * N), N};
+    write_state_at(t, state.cells.data());
+    return state;
+}
+
+StepResult Episode::step_at(int t) const {
+    if (t < 0 || t >= length) {
+        throw std::invalid_argument("Episode step out of range");
+    }
+    return StepResult{state_at(t + 1), rewards[t], done_at(t)};
+}
+
+void Episode::write_observations(float* out) const {
+    const size_t cells = static_cast<size_t>(N) * N;
+    const size_t stride = 2 * cells;
+    if (length == 0) return;
+    std::fill(out, out + stride, 0.0f);
+    int player = 1;
+    for (int k = 0; k < offset; ++k) {
+        out[(player == 1 ? 0 : cells) + history[k]] = 1.0f;
+        player = -player;
+    }
+    for (int t = 1; t < length; ++t) {
+        float* obs = out + t * stride;
+        std::memcpy(obs, obs - stride, stride * sizeof(float));
+        obs[(player == 1 ? 0 : cells) + moves[t - 1]] = 1.0f;
+        player = -player;
+    }
+}
+
+ObservationIterator::ObservationIterator(const Episode& episode)
+    : episode(episode), t(0), player(1),
+      observation_buffer(2 * episode.N * episode.N, 0.0f), mask_buffer(episode.N * episode.N, 1) {
+    const int cells = episode.N * episode.N;
+    for (int k = 0; k < episode.offset; ++k) {
+        observation_buffer[(player == 1 ? 0 : cells) + episode.history[k]] = 1.0f;
+        mask_buffer[episode.history[k]] = 0;
+        player = -player;
+    }
+}
+
+void ObservationIterator::next() {
+    if (at_end()) return;
+    const int cells = episode.N * episode.N;
+    const int move = episode.moves[t];
+    observation_buffer[(player == 1 ? 0 : cells) + move] = 1.0f;
+    mask_buffer[move] = 0;
+    player = -player;
+    ++t;
+}
+
+EpisodeRecorder::EpisodeRecorder(int num_envs, int N, size_t arena_block_size)
+    : num_envs(num_envs), N(N), arena(arena_block_size) {
+    if (num_envs <= 0 || N <= 0) {
+        throw std::invalid_argument("Recorder needs at least one environment and a positive board size");
+    }
+    if (N * N > 65536) {
+        throw std::invalid_argument("Board too large for 16-bit move encoding");
+    }
+    staged_moves.assign(static_cast<size_t>(num_envs) * N * N, 0);
+    staged_rewards.assign(static_cast<size_t>(num_envs) * N * N, 0.0f);
+    staged_length.assign(num_envs, 0);
+    flushed_length.assign(num_envs, 0);
+}
+
+void EpisodeRecorder::record(int env, int action, float reward, bool done) {
+    if (env < 0 || env >= num_envs) {
+        throw std::invalid_argument("Environment index out of range");
+    }
+    if (action < 0 || action >= N * N) {
+        throw std::invalid_argument("Action index out of bounds");
+    }
+    int& length = staged_length[env];
+    if (length >= N * N) {
+        throw std::invalid_argument("Episode longer than the board allows");
+    }
+    const size_t slot = static_cast<size_t>(env) * N * N + length;
+    staged_moves[slot] = static_cast<uint16_t>(action);
+    staged_rewards[slot] = reward;
+    ++length;
+    if (done) {
+        commit(env, true);
+    }
+}
+
+void EpisodeRecorder::record_batch(const int32_t* actions, const float* rewards, const uint8_t* dones) {
+    for (int i = 0; i < num_envs; ++i) {
+        if (actions[i] >= 0) {
+            record(i, actions[i], rewards[i], dones[i] != 0);
+        } else if (dones[i]) {
+            // The game ended without a move (a forfeit): keep what was played as an
+            // unfinished episode and start the next game from an empty board
+            if (staged_length[i] > flushed_length[i]) {
+                commit(i, false);
+            }
+            staged_length[i] = 0;
+            flushed_length[i] = 0;
+        }
+    }
+}
+
+void EpisodeRecorder::flush() {
+    for (int i = 0; i < num_envs; ++i) {
+        if (staged_length[i] > flushed_length[i]) {
+            commit(i, false);
+        }
+    }
+}
+
+void EpisodeRecorder::reset() {
+    arena.reset();
+    episodes.clear();
+}
+
+void EpisodeRecorder::clear() {
+    reset();
+    std::fill(staged_length.begin(), staged_length.end(), 0);
+    std::fill(flushed_length.begin(), flushed_length.end(), 0);
+}
+
+void EpisodeRecorder::commit(int env, bool finished) {
+    // Steps stored by an earlier flush() become this episode's history; they are copied
+    // again since that flush's arena memory may have been reset since
+    const int offset = flushed_length[env];
+    const size_t base = static_cast<size_t>(env) * N * N;
+    store(offset, staged_length[env] - offset, finished, staged_moves.data() + base,
+          staged_rewards.data() + base + offset);
+    if (finished) {
+        staged_length[env] = 0;
+        flushed_length[env] = 0;
+    } else {
+        flushed_length[env] = staged_length[env];
+    }
+}
+
+void EpisodeRecorder::store(int offset, int length, bool finished, const uint16_t* moves_in, const float* rewards_in) {
+    float* rewards = arena.allocate_array<float>(length);
+    uint16_t* moves = arena.allocate_array<uint16_t>(length + offset);
+    std::memcpy(moves, moves_in, (length + offset) * sizeof(uint16_t));
+    std::memcpy(rewards, rewards_in, length * sizeof(float));
+    episodes.push_back(Episode{N, length, finished, moves + offset, rewards, offset, moves});
+}
+
+namespace {
+
+struct RecorderSnapshotHeader {
+    uint32_t magic;    // 'TTER'
+    uint32_t version;  // 1
+    uint32_t num_envs;
+    uint32_t N;
+    uint64_t num_episodes;
+};
+static_assert(sizeof(RecorderSnapshotHeader) == 24, "snapshot header must stay 24 bytes");
+
+struct EpisodeSnapshotHeader {
+    int32_t length;
+    int32_t offset;
+    uint32_t finished;
+};
+
+constexpr uint32_t kRecorderSnapshotMagic = 0x52455454;  // 'TTER'
+constexpr uint32_t kRecorderSnapshotVersion = 1;
+
+}  // namespace
+
+std::vector<uint8_t> EpisodeRecorder::save_snapshot() const {
+    RecorderSnapshotHeader header{};
+    header.magic = kRecorderSnapshotMagic;
+    header.version = kRecorderSnapshotVersion;
+    header.num_envs = static_cast<uint32_t>(num_envs);
+    header.N = static_cast<uint32_t>(N);
+    header.num_episodes = episodes.size();
+
+    std::vector<uint8_t> data;
+    auto put = [&data](const void* p, size_t bytes) {
+        const uint8_t* b = static_cast<const uint8_t*>(p);
+        data.insert(data.end(), b, b + bytes);
+    };
+    put(&header, sizeof(header));
+    put(staged_length.data(), staged_length.size() * sizeof(int));
+    put(flushed_length.data(), flushed_length.size() * sizeof(int));
+    put(staged_moves.data(), staged_moves.size() * sizeof(uint16_t));
+    put(staged_rewards.data(), staged_rewards.size() * sizeof(float));
+    for (const Episode& ep : episodes) {
+        const EpisodeSnapshotHeader record{ep.length, ep.offset, ep.finished ? 1u : 0u};
+        put(&record, sizeof(record));
+        put(ep.history, ep.offset * sizeof(uint16_t));
+        put(ep.moves, ep.length * sizeof(uint16_t));
+        put(ep.rewards, ep.length * sizeof(float));
+    }
+    return data;
+}
+
+void EpisodeRecorder::load_snapshot(const uint8_t* data, size_t size) {
+    RecorderSnapshotHeader header;
+    if (size < sizeof(header)) {
+        throw std::runtime_error("Truncated episode recorder snapshot");
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != kRecorderSnapshotMagic) {
+        throw std::runtime_error("Not an episode recorder snapshot");
+    }
+    if (header.version != kRecorderSnapshotVersion) {
+        throw std::runtime_error("Unsupported episode recorder snapshot version");
+    }
+    if (header.num_envs != static_cast<uint32_t>(num_envs) || header.N != static_cast<uint32_t>(N)) {
+        throw std::invalid_argument("Snapshot is for " + std::to_string(header.num_envs) + " environments of size " +
+                                    std::to_string(header.N) + ", not " + std::to_string(num_envs) + " of size " +
+                                    std::to_string(N));
+    }
+
+    // Everything is decoded and checked before the recorder is touched
+    const int cells = N * N;
+    const uint8_t* in = data + sizeof(header);
+    const uint8_t* end = data + size;
+    auto get = [&in, end](void* p, size_t bytes) {
+        if (static_cast<size_t>(end - in) < bytes) {
+            throw std::runtime_error("Truncated episode recorder snapshot");
+        }
+        std::memcpy(p, in, bytes);
+        in += bytes;
+    };
+    std::vector<int> restored_length(num_envs);
+    std::vector<int> restored_flushed(num_envs);
+    std::vector<uint16_t> restored_moves(staged_moves.size());
+    std::vector<float> restored_rewards(staged_rewards.size());
+    get(restored_length.data(), restored_length.size() * sizeof(int));
+    get(restored_flushed.data(), restored_flushed.size() * sizeof(int));
+    get(restored_moves.data(), restored_moves.size() * sizeof(uint16_t));
+    get(restored_rewards.data(), restored_rewards.size() * sizeof(float));
+    for (int i = 0; i < num_envs; ++i) {
+        if (restored_length[i] < 0 || restored_length[i] > cells || restored_flushed[i] < 0 ||
+            restored_flushed[i] > restored_length[i]) {
+            throw std::runtime_error("Corrupt episode recorder snapshot: staged lengths");
+        }
+    }
+
+    struct Stored {
+        EpisodeSnapshotHeader record;
+        const uint8_t* moves;    // [offset + length] uint16
+        const uint8_t* rewards;  // [length] float
+    };
+    std::vector<Stored> stored;
+    for (uint64_t e = 0; e < header.num_episodes; ++e) {
+        Stored ep;
+        get(&ep.record, sizeof(ep.record));
+        const EpisodeSnapshotHeader& r = ep.record;
+        if (r.length < 0 || r.offset < 0 || r.length > cells - r.offset || r.finished > 1) {
+            throw std::runtime_error("Corrupt episode recorder snapshot: episode header");
+        }
+        const size_t total = static_cast<size_t>(r.offset) + r.length;
+        if (static_cast<size_t>(end - in) < total * sizeof(uint16_t) + r.length * sizeof(float)) {
+            throw std::runtime_error("Truncated episode recorder snapshot");
+        }
+        ep.moves = in;
+        ep.rewards = in + total * sizeof(uint16_t);
+        for (size_t k = 0; k < total; ++k) {
+            uint16_t move;
+            std::memcpy(&move, ep.moves + k * sizeof(uint16_t), sizeof(move));
+            if (move >= cells) {
+                throw std::runtime_error("Corrupt episode recorder snapshot: move out of bounds");
+            }
+        }
+        in = ep.rewards + r.length * sizeof(float);
+        stored.push_back(ep);
+    }
+    if (in != end) {
+        throw std::runtime_error("Corrupt episode recorder snapshot: unexpected size");
+    }
+
+    staged_length.swap(restored_length);
+    flushed_length.swap(restored_flushed);
+    staged_moves.swap(restored_moves);
+    staged_rewards.swap(restored_rewards);
+    reset();
+    std::vector<uint16_t> moves;
+    std::vector<float> rewards;
+    for (const Stored& ep : stored) {
+        const int offset = ep.record.offset;
+        const int length = ep.record.length;
+        // The snapshot bytes need not be aligned for uint16/float
+        moves.resize(offset + length);
+        rewards.resize(length);
+        std::memcpy(moves.data(), ep.moves, moves.size() * sizeof(uint16_t));
+        std::memcpy(rewards.data(), ep.rewards, rewards.size() * sizeof(float));
+        store(offset, length, ep.record.finished != 0, moves.data(), rewards.data());
+    }
+}
@@ -0,0 +1,118 @@
+#include "eval_broker.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+EvaluationBroker::EvaluationBroker(const PolicyNetwork& network, const EvalBrokerConfig& config)
+    : network(network), config(config), N(network.board_size()) {
+    if (config.max_batch <= 0) {
+        throw std::invalid_argument("Broker batch size must be positive");
+    }
+    if (config.deadline_us < 0) {
+        throw std::invalid_argument("Broker deadline must not be negative");
+    }
+    const size_t cells = static_cast<size_t>(N) * N;
+    batch.reserve(config.max_batch);
+    inputs.resize(config.max_batch * 2 * cells);
+    masks.resize(config.max_batch * cells);
+    logits.resize(config.max_batch * cells);
+    values.resize(config.max_batch);
+    worker = std::thread([this] { run(); });
+}
+
+EvaluationBroker::~EvaluationBroker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    queue_cv.notify_one();
+    worker.join();
+}
+
+float EvaluationBroker::evaluate(const float* observation, const uint8_t* mask, float* logits_out) {
+    float value = 0.0f;
+    bool ready = false;
+    enqueue(Request{observation, mask, logits_out, &value, nullptr, &ready, std::chrono::steady_clock::now()});
+    std::unique_lock<std::mutex> lock(mutex);
+    done_cv.wait(lock, [&] { return ready; });
+    return value;
+}
+
+void EvaluationBroker::submit(const float* observation, const uint8_t* mask, float* logits_out, float* value,
+                              std::function<void()> on_done) {
+    enqueue(Request{observation, mask, logits_out, value, std::move(on_done), nullptr,
+                    std::chrono::steady_clock::now()});
+}
+
+EvalBrokerStats EvaluationBroker::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void EvaluationBroker::enqueue(Request request) {
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(std::move(request));
+        // The broker needs to start the deadline clock or fire a full batch
+        wake = pending.size() == 1 || pending.size() >= static_cast<size_t>(config.max_batch);
+    }
+    if (wake) queue_cv.notify_one();
+}
+
+void EvaluationBroker::run() {
+    const size_t max_batch = static_cast<size_t>(config.max_batch);
+    const std::chrono::microseconds deadline(config.deadline_us);
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        queue_cv.wait(lock, [&] { return stopping || !pending.empty(); });
+        if (pending.empty()) break;  // stopping with nothing left to evaluate
+        if (pending.size() < max_batch && !stopping) {
+            queue_cv.wait_until(lock, pending.front().queued + deadline,
+                                [&] { return stopping || pending.size() >= max_batch; });
+        }
+        const size_t take = std::min(pending.size(), max_batch);
+        batch.assign(std::make_move_iterator(pending.begin()), std::make_move_iterator(pending.begin() + take));
+        pending.erase(pending.begin(), pending.begin() + take);
+        stats.requests += take;
+        stats.batches++;
+        stats.full_batches += take == max_batch;
+        lock.unlock();
+
+        evaluate_batch();
+        for (Request& r : batch) {
+            if (r.on_done) r.on_done();
+        }
+
+        lock.lock();
+        for (Request& r : batch) {
+            if (r.ready) *r.ready = true;
+        }
+        batch.clear();
+        done_cv.notify_all();
+    }
+}
+
+void EvaluationBroker::evaluate_batch() {
+    const size_t cells = static_cast<size_t>(N) * N;
+    const int count = static_cast<int>(batch.size());
+    for (int b = 0; b < count; ++b) {
+        const Request& r = batch[b];
+        float* input = inputs.data() + b * 2 * cells;
+        uint8_t* mask = masks.data() + b * cells;
+        std::copy(r.observation, r.observation + 2 * cells, input);
+        if (r.mask) {
+            std::copy(r.mask, r.mask + cells, mask);
+        } else {
+            for (size_t c = 0; c < cells; ++c) {
+                mask[c] = input[c] == 0.0f && input[cells + c] == 0.0f ? 1 : 0;
+            }
+        }
+    }
+    network.forward(inputs.data(), masks.data(), count, logits.data(), values.data());
+    for (int b = 0; b < count; ++b) {
+        const Request& r = batch[b];
+        std::copy(logits.data() + b * cells, logits.data() + (b + 1) * cells, r.logits);
+        *r.value = values[b];
+    }
+}
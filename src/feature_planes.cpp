@@ -0,0 +1,40 @@
+#include "feature_planes.h"
+
+#include <algorithm>
+
+int num_feature_planes(const FeatureConfig& config) {
+    if (config.history < 0 || config.history > Environment::kMoveHistory) {
+        throw std::invalid_argument("History planes must be between 0 and Environment::kMoveHistory");
+    }
+    return 2 + (config.side_to_move ? 1 : 0) + config.history + (config.legal_moves ? 1 : 0);
+}
+
+void write_feature_planes(const Environment& env, const FeatureConfig& config, float* out, const int32_t* perm) {
+    const std::vector<int>& cells = env.get_state().cells;
+    const int size = static_cast<int>(cells.size());
+    const int player = env.get_current_player();
+    float* own = out;
+    float* opponent = out + size;
+    float* next = out + 2 * size;
+    if (config.side_to_move) {
+        // Invariant under symmetries, so no permutation needed
+        std::fill(next, next + size, player == 1 ? 1.0f : 0.0f);
+        next += size;
+    }
+    float* history = next;
+    next += config.history * size;
+    float* legal = config.legal_moves ? next : nullptr;
+
+    for (int c = 0; c < size; ++c) {
+        const int v = cells[c];
+        const int d = perm ? perm[c] : c;
+        own[d] = v == player ? 1.0f : 0.0f;
+        opponent[d] = v == -player ? 1.0f : 0.0f;
+        if (legal) legal[d] = v == 0 ? 1.0f : 0.0f;
+    }
+    std::fill(history, history + config.history * size, 0.0f);
+    for (int k = 0; k < config.history; ++k) {
+        const int move = env.get_recent_move(k);
+        if (move >= 0) history[k * size + (perm ? perm[move] : move)] = 1.0f;
+    }
+}
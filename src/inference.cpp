@@ -0,0 +1,405 @@
+#include "inference.h"
+
+#include <fstream>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Cache blocking: a KC x NC panel of B stays in L2 while MC rows of A stream through it.
+constexpr int MC = 64;
+constexpr int KC = 256;
+constexpr int NC = 512;
+
+// Register tile computed by the micro-kernel.
+constexpr int MR = 4;
+constexpr int NR = 16;
+
+constexpr uint32_t kMagic = 0x4E545454;  // "TTTN"
+constexpr uint32_t kVersion = 1;
+
+// Full MR x NR tile: C[MR, NR] (+)= A[MR, kc] * B[kc, NR]
+void micro_kernel(int kc, const float* A, int lda, const float* B, int ldb,
+                  float* C, int ldc, bool load_c) {
+#if defined(__AVX2__) && defined(__FMA__)
+    __m256 acc[MR][2];
+    for (int r = 0; r < MR; ++r) {
+        if (load_c) {
+            acc[r][0] = _mm256_loadu_ps(C + r * ldc);
+            acc[r][1] = _mm256_loadu_ps(C + r * ldc + 8);
+        } else {
+            acc[r][0] = _mm256_setzero_ps();
+            acc[r][1] = _mm256_setzero_ps();
+        }
+    }
+    for (int k = 0; k < kc; ++k) {
+        __m256 b0 = _mm256_loadu_ps(B + k * ldb);
+        __m256 b1 = _mm256_loadu_ps(B + k * ldb + 8);
+        for (int r = 0; r < MR; ++r) {
+            __m256 a = _mm256_broadcast_ss(A + r * lda + k);
+            acc[r][0] = _mm256_fmadd_ps(a, b0, acc[r][0]);
+            acc[r][1] = _mm256_fmadd_ps(a, b1, acc[r][1]);
+        }
+    }
+    for (int r = 0; r < MR; ++r) {
+        _mm256_storeu_ps(C + r * ldc, acc[r][0]);
+        _mm256_storeu_ps(C + r * ldc + 8, acc[r][1]);
+    }
+#else
+    // Fixed-width accumulator rows; the j-loops are written to auto-vectorize.
+    float acc[MR][NR];
+    for (int r = 0; r < MR; ++r) {
+        for (int j = 0; j < NR; ++j) {
+            acc[r][j] = load_c ? C[r * ldc + j] : 0.0f;
+        }
+    }
+    for (int k = 0; k < kc; ++k) {
+        const float* b = B + k * ldb;
+        for (int r = 0; r < MR; ++r) {
+            const float a = A[r * lda + k];
+            for (int j = 0; j < NR; ++j) {
+                acc[r][j] += a * b[j];
+            }
+        }
+    }
+    for (int r = 0; r < MR; ++r) {
+        for (int j = 0; j < NR; ++j) {
+            C[r * ldc + j] = acc[r][j];
+        }
+    }
+#endif
+}
+
+// Partial tile at the right/bottom edge of C
+void edge_kernel(int mr, int nr, int kc, const float* A, int lda, const float* B, int ldb,
+                 float* C, int ldc, bool load_c) {
+    for (int r = 0; r < mr; ++r) {
+        float* c = C + r * ldc;
+        if (!load_c) {
+            for (int j = 0; j < nr; ++j) c[j] = 0.0f;
+        }
+        for (int k = 0; k < kc; ++k) {
+            const float a = A[r * lda + k];
+            const float* b = B + k * ldb;
+            for (int j = 0; j < nr; ++j) {
+                c[j] += a * b[j];
+            }
+        }
+    }
+}
+
+void apply_activation(float* data, size_t count, Activation activation) {
+    if (activation == Activation::ReLU) {
+        for (size_t i = 0; i < count; ++i) {
+            data[i] = data[i] > 0.0f ? data[i] : 0.0f;
+        }
+    }
+}
+
+// Number of features produced per sample by a layer
+int output_features(const Layer& layer, int N) {
+    return layer.type == LayerType::Conv3x3 ? layer.out * N * N : layer.out;
+}
+
+void validate_layer(const Layer& layer, int expected_in_features, int N) {
+    if (layer.in <= 0 || layer.out <= 0) {
+        throw std::invalid_argument("Layer dimensions must be positive");
+    }
+    size_t expected_weights;
+    if (layer.type == LayerType::Conv3x3) {
+        if (layer.in * N * N != expected_in_features) {
+            throw std::invalid_argument("Conv3x3 input channels do not match previous layer");
+        }
+        expected_weights = static_cast<size_t>(layer.out) * layer.in * 9;
+    } else if (layer.type == LayerType::Dense) {
+        if (layer.in != expected_in_features) {
+            throw std::invalid_argument("Dense input size does not match previous layer");
+        }
+        expected_weights = static_cast<size_t>(layer.out) * layer.in;
+    } else {
+        throw std::invalid_argument("Unknown layer type");
+    }
+    if (layer.weights.size() != expected_weights || layer.bias.size() != static_cast<size_t>(layer.out)) {
+        throw std::invalid_argument("Layer weight or bias size does not match its dimensions");
+    }
+}
+
+void write_u32(std::ofstream& out, uint32_t value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+uint32_t read_u32(std::ifstream& in) {
+    uint32_t value = 0;
+    in.read(reinterpret_cast<char*>(&value), sizeof(value));
+    if (!in) {
+        throw std::runtime_error("Unexpected end of weight file");
+    }
+    return value;
+}
+
+void write_layer(std::ofstream& out, const Layer& layer) {
+    write_u32(out, static_cast<uint32_t>(layer.type));
+    write_u32(out, static_cast<uint32_t>(layer.activation));
+    write_u32(out, static_cast<uint32_t>(layer.in));
+    write_u32(out, static_cast<uint32_t>(layer.out));
+    out.write(reinterpret_cast<const char*>(layer.weights.data()), layer.weights.size() * sizeof(float));
+    out.write(reinterpret_cast<const char*>(layer.bias.data()), layer.bias.size() * sizeof(float));
+}
+
+Layer read_layer(std::ifstream& in) {
+    Layer layer;
+    layer.type = static_cast<LayerType>(read_u32(in));
+    layer.activation = static_cast<Activation>(read_u32(in));
+    layer.in = static_cast<int>(read_u32(in));
+    layer.out = static_cast<int>(read_u32(in));
+    if (layer.in <= 0 || layer.out <= 0 || layer.in > (1 << 20) || layer.out > (1 << 20)) {
+        throw std::runtime_error("Corrupt layer dimensions in weight file");
+    }
+    size_t weight_count = static_cast<size_t>(layer.in) * layer.out;
+    if (layer.type == LayerType::Conv3x3) {
+        weight_count *= 9;
+    }
+    layer.weights.resize(weight_count);
+    layer.bias.resize(layer.out);
+    in.read(reinterpret_cast<char*>(layer.weights.data()), weight_count * sizeof(float));
+    in.read(reinterpret_cast<char*>(layer.bias.data()), layer.out * sizeof(float));
+    if (!in) {
+        throw std::runtime_error("Unexpected end of weight file");
+    }
+    return layer;
+}
+
+}  // namespace
+
+void sgemm(const float* A, const float* B, float* C, int M, int K, int Ncols, bool accumulate) {
+    if (K == 0) {
+        if (!accumulate) std::fill(C, C + static_cast<size_t>(M) * Ncols, 0.0f);
+        return;
+    }
+    for (int jc = 0; jc < Ncols; jc += NC) {
+        const int nc = std::min(NC, Ncols - jc);
+        for (int pc = 0; pc < K; pc += KC) {
+            const int kc = std::min(KC, K - pc);
+            const bool load_c = accumulate || pc > 0;
+            for (int ic = 0; ic < M; ic += MC) {
+                const int mc = std::min(MC, M - ic);
+                for (int i = ic; i < ic + mc; i += MR) {
+                    const int mr = std::min(MR, ic + mc - i);
+                    for (int j = jc; j < jc + nc; j += NR) {
+                        const int nr = std::min(NR, jc + nc - j);
+                        const float* a = A + static_cast<size_t>(i) * K + pc;
+                        const float* b = B + static_cast<size_t>(pc) * Ncols + j;
+                        float* c = C + static_cast<size_t>(i) * Ncols + j;
+                        if (mr == MR && nr == NR) {
+                            micro_kernel(kc, a, K, b, Ncols, c, Ncols, load_c);
+                        } else {
+                            edge_kernel(mr, nr, kc, a, K, b, Ncols, c, Ncols, load_c);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+PolicyNetwork::PolicyNetwork(int N, std::vector<Layer> trunk, Layer policy_head, Layer value_head)
+    : N(N), trunk(std::move(trunk)), policy_head(std::move(policy_head)), value_head(std::move(value_head)) {
+    if (N <= 0) {
+        throw std::invalid_argument("Board size must be positive");
+    }
+
+    // Walk the layer chain checking that each layer consumes what the previous one produced
+    int features = 2 * N * N;
+    bool seen_dense = false;
+    for (const Layer& layer : this->trunk) {
+        if (layer.type == LayerType::Conv3x3 && seen_dense) {
+            throw std::invalid_argument("Conv3x3 layers must precede Dense layers");
+        }
+        seen_dense = seen_dense || layer.type == LayerType::Dense;
+        validate_layer(layer, features, N);
+        features = output_features(layer, N);
+    }
+    if (this->policy_head.type != LayerType::Dense || this->policy_head.out != N * N) {
+        throw std::invalid_argument("Policy head must be Dense with N*N outputs");
+    }
+    if (this->value_head.type != LayerType::Dense || this->value_head.out != 1) {
+        throw std::invalid_argument("Value head must be Dense with 1 output");
+    }
+    validate_layer(this->policy_head, features, N);
+    validate_layer(this->value_head, features, N);
+
+    pack_layers();
+}
+
+void PolicyNetwork::pack_layers() {
+    packed.clear();
+    std::vector<const Layer*> all;
+    for (const Layer& layer : trunk) all.push_back(&layer);
+    all.push_back(&policy_head);
+    all.push_back(&value_head);
+
+    for (const Layer* layer : all) {
+        PackedLayer p{layer->type, layer->activation, layer->in, layer->out, {}, layer->bias};
+        // Transpose [out, K] -> [K, out] so the GEMM inner loop runs over contiguous outputs
+        const int K = layer->type == LayerType::Conv3x3 ? layer->in * 9 : layer->in;
+        p.weights.resize(static_cast<size_t>(K) * layer->out);
+        for (int o = 0; o < layer->out; ++o) {
+            for (int k = 0; k < K; ++k) {
+                p.weights[static_cast<size_t>(k) * layer->out + o] = layer->weights[static_cast<size_t>(o) * K + k];
+            }
+        }
+        packed.push_back(std::move(p));
+    }
+}
+
+void PolicyNetwork::run_layer(const PackedLayer& layer, const float* input, int batch, float* output) {
+    if (layer.type == LayerType::Dense) {
+        sgemm(input, layer.weights.data(), output, batch, layer.in, layer.out, false);
+        for (int b = 0; b < batch; ++b) {
+            float* row = output + static_cast<size_t>(b) * layer.out;
+            for (int o = 0; o < layer.out; ++o) {
+                row[o] += layer.bias[o];
+            }
+        }
+        apply_activation(output, static_cast<size_t>(batch) * layer.out, layer.activation);
+        return;
+    }
+
+    // Conv3x3 via im2col: rows are (sample, cell), columns are (in_channel, ky, kx)
+    const int P = N * N;
+    const int K = layer.in * 9;
+    columns.assign(static_cast<size_t>(batch) * P * K, 0.0f);
+    for (int b = 0; b < batch; ++b) {
+        const float* x = input + static_cast<size_t>(b) * layer.in * P;
+        for (int r = 0; r < N; ++r) {
+            for (int c = 0; c < N; ++c) {
+                float* col = columns.data() + (static_cast<size_t>(b) * P + r * N + c) * K;
+                for (int ci = 0; ci < layer.in; ++ci) {
+                    for (int ky = 0; ky < 3; ++ky) {
+                        const int y = r + ky - 1;
+                        if (y < 0 || y >= N) continue;
+                        for (int kx = 0; kx < 3; ++kx) {
+                            const int xx = c + kx - 1;
+                            if (xx < 0 || xx >= N) continue;
+                            col[ci * 9 + ky * 3 + kx] = x[ci * P + y * N + xx];
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    gemm_out.resize(static_cast<size_t>(batch) * P * layer.out);
+    sgemm(columns.data(), layer.weights.data(), gemm_out.data(), batch * P, K, layer.out, false);
+
+    // [B, P, out] -> [B, out, P] so activations keep the [C, N, N] layout of the observations
+    for (int b = 0; b < batch; ++b) {
+        for (int p = 0; p < P; ++p) {
+            const float* src = gemm_out.data() + (static_cast<size_t>(b) * P + p) * layer.out;
+            for (int o = 0; o < layer.out; ++o) {
+                output[(static_cast<size_t>(b) * layer.out + o) * P + p] = src[o] + layer.bias[o];
+            }
+        }
+    }
+    apply_activation(output, static_cast<size_t>(batch) * layer.out * P, layer.activation);
+}
+
+void PolicyNetwork::forward(const float* observations, const uint8_t* mask, int batch,
+                            float* logits, float* values) {
+    if (batch <= 0) return;
+
+    const float* current = observations;
+    float* buffers[2];
+    size_t max_features = 2 * N * N;
+    for (const Layer& layer : trunk) {
+        max_features = std::max(max_features, static_cast<size_t>(output_features(layer, N)));
+    }
+    act_a.resize(max_features * batch);
+    act_b.resize(max_features * batch);
+    buffers[0] = act_a.data();
+    buffers[1] = act_b.data();
+
+    const size_t trunk_count = trunk.size();
+    for (size_t i = 0; i < trunk_count; ++i) {
+        float* next = buffers[i % 2];
+        run_layer(packed[i], current, batch, next);
+        current = next;
+    }
+
+    const int P = N * N;
+    run_layer(packed[trunk_count], current, batch, logits);
+
+    // The value head writes into a scratch buffer that is no longer needed for activations
+    float* value_scratch = buffers[trunk_count % 2];
+    run_layer(packed[trunk_count + 1], current, batch, value_scratch);
+    for (int b = 0; b < batch; ++b) {
+        values[b] = std::tanh(value_scratch[b]);
+    }
+
+    // Mask illegal moves
+    const float neg_inf = -std::numeric_limits<float>::infinity();
+    for (int b = 0; b < batch; ++b) {
+        float* row = logits + static_cast<size_t>(b) * P;
+        if (mask != nullptr) {
+            const uint8_t* m = mask + static_cast<size_t>(b) * P;
+            for (int i = 0; i < P; ++i) {
+                row[i] = m[i] ? row[i] : neg_inf;
+            }
+        } else {
+            const float* obs = observations + static_cast<size_t>(b) * 2 * P;
+            for (int i = 0; i < P; ++i) {
+                row[i] = (obs[i] == 0.0f && obs[P + i] == 0.0f) ? row[i] : neg_inf;
+            }
+        }
+    }
+}
+
+PolicyNetwork PolicyNetwork::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Cannot open weight file: " + path);
+    }
+    if (read_u32(in) != kMagic) {
+        throw std::runtime_error("Not a policy weight file: " + path);
+    }
+    if (read_u32(in) != kVersion) {
+        throw std::runtime_error("Unsupported weight file version: " + path);
+    }
+    const int N = static_cast<int>(read_u32(in));
+    const uint32_t trunk_count = read_u32(in);
+    if (N <= 0 || N > 64 || trunk_count > 1024) {
+        throw std::runtime_error("Corrupt weight file header: " + path);
+    }
+
+    std::vector<Layer> trunk;
+    for (uint32_t i = 0; i < trunk_count; ++i) {
+        trunk.push_back(read_layer(in));
+    }
+    Layer policy_head = read_layer(in);
+    Layer value_head = read_layer(in);
+    return PolicyNetwork(N, std::move(trunk), std::move(policy_head), std::move(value_head));
+}
+
+void PolicyNetwork::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Cannot open weight file for writing: " + path);
+    }
+    write_u32(out, kMagic);
+    write_u32(out, kVersion);
+    write_u32(out, static_cast<uint32_t>(N));
+    write_u32(out, static_cast<uint32_t>(trunk.size()));
+    for (const Layer& layer : trunk) {
+        write_layer(out, layer);
+    }
+    write_layer(out, policy_head);
+    write_layer(out, value_head);
+    if (!out) {
+        throw std::runtime_error("Failed writing weight file: " + path);
+    }
+}
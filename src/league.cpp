@@ -0,0 +1,128 @@
+#include "league.h"
+
+#include <cmath>
+
+namespace {
+
+// Keeps sampling weights positive so no opponent is ever starved completely
+constexpr double kMinWeight = 1e-3;
+
+}  // namespace
+
+League::League(const LeagueConfig& config)
+    : config(config), sampling_rng(config.seed ^ 0x9E3779B97F4A7C15ULL),
+      results(new PairCounters[static_cast<size_t>(config.max_snapshots) * config.max_snapshots]) {
+    if (config.max_snapshots <= 0) {
+        throw std::invalid_argument("League needs room for at least one snapshot");
+    }
+}
+
+int League::add_snapshot(std::shared_ptr<const Agent> agent, const std::string& name) {
+    if (!agent) {
+        throw std::invalid_argument("Snapshot agent must not be null");
+    }
+    if (static_cast<int>(snapshots.size()) >= config.max_snapshots) {
+        throw std::invalid_argument("League snapshot pool is full");
+    }
+    snapshots.push_back(Snapshot{name, std::move(agent)});
+    return static_cast<int>(snapshots.size()) - 1;
+}
+
+PairRecord League::get_record(int a, int b) const {
+    if (a < 0 || b < 0 || a >= get_num_snapshots() || b >= get_num_snapshots()) {
+        throw std::invalid_argument("Unknown snapshot id");
+    }
+    const PairCounters& as_first = counters(a, b);
+    const PairCounters& as_second = counters(b, a);
+    PairRecord record{
+        as_first.first_wins.load(std::memory_order_relaxed) + as_second.second_wins.load(std::memory_order_relaxed),
+        as_first.second_wins.load(std::memory_order_relaxed) + as_second.first_wins.load(std::memory_order_relaxed),
+        as_first.draws.load(std::memory_order_relaxed) + as_second.draws.load(std::memory_order_relaxed),
+    };
+    if (a == b) {
+        // Mirror games are stored once; each one is a win for one side and a loss for the other
+        record.wins = as_first.first_wins.load(std::memory_order_relaxed) + as_first.second_wins.load(std::memory_order_relaxed);
+        record.losses = record.wins;
+        record.draws = as_first.draws.load(std::memory_order_relaxed);
+    }
+    return record;
+}
+
+std::vector<double> League::opponent_distribution(int learner) const {
+    const int n = get_num_snapshots();
+    std::vector<double> weights(n, 0.0);
+    if (n == 1) {
+        weights[learner] = 1.0;
+        return weights;
+    }
+    double total = 0.0;
+    for (int o = 0; o < n; ++o) {
+        if (o == learner) continue;
+        const double p = get_record(learner, o).score();
+        double w = 1.0;
+        switch (config.sampling) {
+            case OpponentSampling::Uniform: w = 1.0; break;
+            case OpponentSampling::PrioritizedHard: w = std::pow(1.0 - p, config.pfsp_power); break;
+            case OpponentSampling::PrioritizedEven: w = p * (1.0 - p); break;
+        }
+        weights[o] = std::max(w, kMinWeight);
+        total += weights[o];
+    }
+    for (double& w : weights) w /= total;
+    return weights;
+}
+
+int League::sample_opponent(int learner, uint64_t game) const {
+    return sample_from(opponent_distribution(learner), learner, game);
+}
+
+int League::sample_from(const std::vector<double>& weights, int learner, uint64_t game) const {
+    double target = sampling_rng.uniform(static_cast<uint32_t>(game), game >> 32);
+    int last = learner;
+    for (int o = 0; o < static_cast<int>(weights.size()); ++o) {
+        if (weights[o] == 0.0) continue;
+        last = o;
+        target -= weights[o];
+        if (target < 0.0) return o;
+    }
+    return last;  // rounding left a sliver of probability mass
+}
+
+void League::run(int learner, uint64_t num_games) {
+    if (learner < 0 || learner >= get_num_snapshots()) {
+        throw std::invalid_argument("Unknown learner snapshot");
+    }
+    std::vector<std::shared_ptr<const Agent>> agents;
+    for (const Snapshot& s : snapshots) {
+        agents.push_back(s.agent);
+    }
+    MatchRunnerConfig runner;
+    runner.N = config.N;
+    runner.num_threads = config.num_threads;
+    runner.games_per_thread = config.games_per_thread;
+    runner.seed = config.seed;
+    // Game numbers continue across runs so every game draws fresh random streams
+    const uint64_t first_game = total_games.load(std::memory_order_relaxed);
+    runner.game_offset = first_game;
+
+    // Opponent weights are fixed for the whole run: read from the live counters they would
+    // depend on which games other threads had finished, and so on timing
+    const std::vector<double> weights = opponent_distribution(learner);
+    auto schedule = [&](uint64_t game) {
+        const uint64_t id = first_game + game;
+        const int opponent = sample_from(weights, learner, id);
+        return game % 2 == 0 ? Match{learner, opponent} : Match{opponent, learner};
+    };
+    auto report = [&](int, uint64_t, const Match& match, int8_t outcome) {
+        PairCounters& c = counters(match.first, match.second);
+        if (outcome == OUTCOME_PLAYER1_WIN) {
+            c.first_wins.fetch_add(1, std::memory_order_relaxed);
+        } else if (outcome == OUTCOME_PLAYER2_WIN) {
+            c.second_wins.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            c.draws.fetch_add(1, std::memory_order_relaxed);
+        }
+        total_games.fetch_add(1, std::memory_order_relaxed);
+    };
+    run_matches(agents, num_games, runner, schedule, report);
+}
@@ -0,0 +1,123 @@
+#include "line_evaluator.h"
+
+#include <algorithm>
+
+LineEvaluator::LineEvaluator(int N, int K) : N(N), K(K == 0 ? N : K), num_lines(0), balance(0) {
+    if (N <= 0) {
+        throw std::invalid_argument("Board size must be positive");
+    }
+    if (this->K <= 0 || this->K > N) {
+        throw std::invalid_argument("Win length must be between 1 and N");
+    }
+    const int directions[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    std::vector<std::vector<int>> lines_of_cell(N * N);
+    for (int r = 0; r < N; ++r) {
+        for (int c = 0; c < N; ++c) {
+            for (const auto& d : directions) {
+                const int end_r = r + (this->K - 1) * d[0];
+                const int end_c = c + (this->K - 1) * d[1];
+                if (end_r < 0 || end_r >= N || end_c < 0 || end_c >= N) continue;
+                for (int k = 0; k < this->K; ++k) {
+                    const int cell = (r + k * d[0]) * N + c + k * d[1];
+                    cells_of_line.push_back(cell);
+                    lines_of_cell[cell].push_back(num_lines);
+                }
+                num_lines++;
+            }
+        }
+    }
+    line_offsets.push_back(0);
+    for (const std::vector<int>& lines : lines_of_cell) {
+        through.insert(through.end(), lines.begin(), lines.end());
+        line_offsets.push_back(static_cast<int>(through.size()));
+    }
+    reset();
+}
+
+void LineEvaluator::reset() {
+    for (int s = 0; s < 2; ++s) {
+        counts[s].assign(num_lines, 0);
+        open[s].assign(K + 1, 0);
+        open[s][0] = num_lines;
+    }
+    balance = 0;
+}
+
+void LineEvaluator::sync(const BoardState& state) {
+    if (state.N != N || static_cast<int>(state.cells.size()) != N * N) {
+        throw std::invalid_argument("Board size does not match the evaluator");
+    }
+    reset();
+    for (int c = 0; c < N * N; ++c) {
+        if (state.cells[c] != 0) place(c, state.cells[c]);
+    }
+}
+
+void LineEvaluator::place(int cell, int player) {
+    update(cell, player, 1);
+}
+
+void LineEvaluator::remove(int cell, int player) {
+    update(cell, player, -1);
+}
+
+void LineEvaluator::update(int cell, int player, int delta) {
+    const int me = side(player);
+    uint8_t* mine = counts[me].data();
+    const uint8_t* theirs = counts[1 - me].data();
+    for (int i = line_offsets[cell]; i < line_offsets[cell + 1]; ++i) {
+        const int l = through[i];
+        const int before = mine[l];
+        const int after = before + delta;
+        const int other = theirs[l];
+        mine[l] = static_cast<uint8_t>(after);
+        // The line's open status for the other player flips between 0 and 1 of my stones
+        if (other == 0) {
+            open[me][before]--;
+            open[me][after]++;
+        }
+        if (before == 0 || after == 0) {
+            const int change = after == 0 ? 1 : -1;
+            open[1 - me][other] += change;
+        }
+        const int x_before = me == 0 ? before : other;
+        const int o_before = me == 0 ? other : before;
+        const int x_after = me == 0 ? after : other;
+        const int o_after = me == 0 ? other : after;
+        balance += contribution(x_after, o_after) - contribution(x_before, o_before);
+    }
+}
+
+LineShapingReward::LineShapingReward(int num_envs, int N, float scale, int K)
+    : scale(scale), evaluators(num_envs, LineEvaluator(N, K)), known(static_cast<size_t>(num_envs) * N * N, 0) {}
+
+void LineShapingReward::reset() {
+    for (LineEvaluator& e : evaluators) e.reset();
+    std::fill(known.begin(), known.end(), 0);
+}
+
+void LineShapingReward::operator()(const int8_t* boards, const int32_t* actions, const int8_t* outcomes,
+                                   int num_envs, int N, float* rewards) {
+    if (num_envs != static_cast<int>(evaluators.size()) || N != evaluators[0].get_board_size()) {
+        throw std::invalid_argument("Shaping reward does not match the batch");
+    }
+    const int cells = N * N;
+    for (int i = 0; i < num_envs; ++i) {
+        LineEvaluator& e = evaluators[i];
+        int8_t* mirror = known.data() + static_cast<size_t>(i) * cells;
+        const int a = actions[i];
+        // Rejected and out-of-range actions leave the board as it was
+        if (a >= 0 && a < cells && mirror[a] == 0 && boards[i * cells + a] != 0) {
+            const int mover = boards[i * cells + a];
+            const int before = e.score(mover);
+            e.place(a, mover);
+            mirror[a] = static_cast<int8_t>(mover);
+            rewards[i] += scale * static_cast<float>(e.score(mover) - before);
+        }
+        if (outcomes[i] != OUTCOME_ONGOING) {
+            // The environment is reset right after this hook
+            e.reset();
+            std::fill(mirror, mirror + cells, 0);
+        }
+    }
+}
@@ -0,0 +1,454 @@
+#include "llm_connector.h"
+#include "symmetry.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace {
+
+// Splits "http://host[:port]/path" into its parts
+void parse_endpoint(const std::string& endpoint, std::string& host, std::string& port, std::string& path) {
+    const std::string scheme = "http://";
+    if (endpoint.compare(0, scheme.size(), scheme) != 0) {
+        throw std::invalid_argument("LLM endpoint must start with http://");
+    }
+    std::string rest = endpoint.substr(scheme.size());
+    size_t slash = rest.find('/');
+    std::string authority = rest.substr(0, slash);
+    path = slash == std::string::npos ? "/" : rest.substr(slash);
+    size_t colon = authority.rfind(':');
+    if (colon == std::string::npos) {
+        host = authority;
+        port = "80";
+    } else {
+        host = authority.substr(0, colon);
+        port = authority.substr(colon + 1);
+    }
+    if (host.empty() || port.empty()) {
+        throw std::invalid_argument("LLM endpoint has no host or port");
+    }
+}
+
+void append_json_string(std::string& out, const std::string& text) {
+    out += '"';
+    for (char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+// Extracts the "responses" array of a reply. Strings are unescaped; numbers are kept
+// as their text. Returns an empty vector if the reply is malformed.
+std::vector<std::string> parse_responses(const std::string& json) {
+    std::vector<std::string> out;
+    size_t pos = json.find("\"responses\"");
+    if (pos == std::string::npos) return {};
+    pos = json.find('[', pos);
+    if (pos == std::string::npos) return {};
+    ++pos;
+    auto skip_ws = [&]() {
+        while (pos < json.size() && std::isspace(static_cast<unsigned char>(json[pos]))) ++pos;
+    };
+    skip_ws();
+    if (pos < json.size() && json[pos] == ']') return out;
+    while (pos < json.size()) {
+        skip_ws();
+        std::string item;
+        if (json[pos] == '"') {
+            ++pos;
+            while (pos < json.size() && json[pos] != '"') {
+                if (json[pos] == '\\' && pos + 1 < json.size()) {
+                    char e = json[++pos];
+                    if (e == 'u') {
+                        pos += 4;  // non-ASCII text never carries the move
+                        item += '?';
+                    } else {
+                        item += e == 'n' ? '\n' : e == 't' ? '\t' : e;
+                    }
+                } else {
+                    item += json[pos];
+                }
+                ++pos;
+            }
+            if (pos >= json.size()) return {};
+            ++pos;
+        } else {
+            while (pos < json.size() && json[pos] != ',' && json[pos] != ']' &&
+                   !std::isspace(static_cast<unsigned char>(json[pos]))) {
+                item += json[pos++];
+            }
+        }
+        out.push_back(std::move(item));
+        skip_ws();
+        if (pos >= json.size()) return {};
+        if (json[pos] == ']') return out;
+        if (json[pos] != ',') return {};
+        ++pos;
+    }
+    return {};
+}
+
+// First non-negative integer in a model's answer, or -1
+int first_integer(const std::string& text) {
+    size_t i = 0;
+    while (i < text.size() && !std::isdigit(static_cast<unsigned char>(text[i]))) ++i;
+    if (i == text.size()) return -1;
+    long value = 0;
+    while (i < text.size() && std::isdigit(static_cast<unsigned char>(text[i]))) {
+        value = value * 10 + (text[i++] - '0');
+        if (value > 1 << 20) return -1;
+    }
+    return static_cast<int>(value);
+}
+
+std::string decode_chunked(const std::string& body) {
+    std::string out;
+    size_t pos = 0;
+    while (pos < body.size()) {
+        size_t eol = body.find("\r\n", pos);
+        if (eol == std::string::npos) break;
+        size_t size = std::strtoul(body.substr(pos, eol - pos).c_str(), nullptr, 16);
+        if (size == 0) break;
+        out.append(body, eol + 2, size);
+        pos = eol + 2 + size + 2;
+    }
+    return out;
+}
+
+}  // namespace
+
+std::string http_post(const std::string& host, const std::string& port, const std::string& path,
+                      const std::string& body, int timeout_ms) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses) != 0) {
+        throw std::runtime_error("Cannot resolve LLM host " + host);
+    }
+    int fd = -1;
+    for (addrinfo* a = addresses; a != nullptr; a = a->ai_next) {
+        fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (fd < 0) continue;
+        timeval tv{};
+        tv.tv_sec = timeout_ms / 1000;
+        tv.tv_usec = (timeout_ms % 1000) * 1000;
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        if (connect(fd, a->ai_addr, a->ai_addrlen) == 0) break;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(addresses);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot connect to LLM endpoint " + host + ":" + port);
+    }
+
+    std::ostringstream request;
+    request << "POST " << path << " HTTP/1.1\r\n"
+            << "Host: " << host << ":" << port << "\r\n"
+            << "Content-Type: application/json\r\n"
+            << "Content-Length: " << body.size() << "\r\n"
+            << "Connection: close\r\n\r\n"
+            << body;
+    const std::string data = request.str();
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            close(fd);
+            throw std::runtime_error("Failed to send LLM request");
+        }
+        sent += static_cast<size_t>(n);
+    }
+
+    std::string response;
+    char buf[4096];
+    while (true) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) {
+            close(fd);
+            throw std::runtime_error("LLM request timed out");
+        }
+        if (n == 0) break;
+        response.append(buf, static_cast<size_t>(n));
+    }
+    close(fd);
+
+    size_t header_end = response.find("\r\n\r\n");
+    if (response.compare(0, 5, "HTTP/") != 0 || header_end == std::string::npos) {
+        throw std::runtime_error("Malformed HTTP response from LLM endpoint");
+    }
+    int status = std::atoi(response.c_str() + response.find(' ') + 1);
+    if (status < 200 || status >= 300) {
+        throw std::runtime_error("LLM endpoint returned HTTP " + std::to_string(status));
+    }
+    std::string headers = response.substr(0, header_end);
+    std::transform(headers.begin(), headers.end(), headers.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    std::string payload = response.substr(header_end + 4);
+    if (headers.find("transfer-encoding: chunked") != std::string::npos) {
+        return decode_chunked(payload);
+    }
+    size_t length_pos = headers.find("content-length:");
+    if (length_pos != std::string::npos) {
+        size_t length = std::strtoul(headers.c_str() + length_pos + 15, nullptr, 10);
+        if (length < payload.size()) payload.resize(length);
+    }
+    return payload;
+}
+
+void LatencyHistogram::record(std::chrono::microseconds latency) {
+    uint64_t us = latency.count() > 0 ? static_cast<uint64_t>(latency.count()) : 0;
+    int bucket = 0;
+    while (us != 0 && bucket < kNumBuckets - 1) {
+        us >>= 1;
+        ++bucket;
+    }
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::count() const {
+    uint64_t total = 0;
+    for (int b = 0; b < kNumBuckets; ++b) total += get_bucket(b);
+    return total;
+}
+
+uint64_t LatencyHistogram::percentile(double q) const {
+    const uint64_t total = count();
+    if (total == 0) return 0;
+    const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * total)));
+    uint64_t seen = 0;
+    for (int b = 0; b < kNumBuckets; ++b) {
+        seen += get_bucket(b);
+        if (seen >= target) return uint64_t(1) << b;  // bucket b holds values below 2^b
+    }
+    return uint64_t(1) << (kNumBuckets - 1);
+}
+
+AsyncLLMConnector::AsyncLLMConnector(const LLMConnectorConfig& config)
+    : config(config), stopping(false),
+      num_requests(0), num_cache_hits(0), num_batches(0), num_errors(0) {
+    if (config.max_batch_size <= 0 || config.max_in_flight <= 0) {
+        throw std::invalid_argument("LLM batch size and in-flight window must be positive");
+    }
+    parse_endpoint(config.endpoint, host, port, path);
+    for (int i = 0; i < config.max_in_flight; ++i) {
+        senders.emplace_back(&AsyncLLMConnector::sender_loop, this);
+    }
+}
+
+AsyncLLMConnector::~AsyncLLMConnector() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    // Senders drain the queue before exiting, so every future gets a value
+    for (auto& t : senders) {
+        t.join();
+    }
+}
+
+const AsyncLLMConnector::CacheEntry* AsyncLLMConnector::find_cached(uint64_t hash, const std::vector<int>& canonical) const {
+    auto range = cache.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second.canonical == canonical) return &it->second;
+    }
+    return nullptr;
+}
+
+std::future<Action> AsyncLLMConnector::suggest_move(const BoardState& state) {
+    const int N = state.N;
+    if (N <= 0 || static_cast<int>(state.cells.size()) != N * N) {
+        throw std::invalid_argument("Board state does not match its size");
+    }
+    if (std::find(state.cells.begin(), state.cells.end(), 0) == state.cells.end()) {
+        throw std::invalid_argument("Board has no legal moves");
+    }
+    num_requests.fetch_add(1, std::memory_order_relaxed);
+
+    Waiter waiter;
+    waiter.symmetry = canonical_symmetry(state);
+    waiter.cells = state.cells;
+    waiter.submitted = Clock::now();
+    std::future<Action> result = waiter.promise.get_future();
+
+    std::vector<int> canonical(state.cells.size());
+    apply_symmetry(state.cells.data(), canonical.data(), N, waiter.symmetry);
+    const uint64_t hash = hash_cells(canonical);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (const CacheEntry* hit = find_cached(hash, canonical)) {
+        const int action = hit->action;
+        lock.unlock();
+        num_cache_hits.fetch_add(1, std::memory_order_relaxed);
+        resolve(waiter, action, N);
+        return result;
+    }
+    auto it = outstanding.find(hash);
+    if (it != outstanding.end() && it->second->canonical == canonical) {
+        // Same position already queued or in flight: share its answer
+        it->second->waiters.push_back(std::move(waiter));
+        num_cache_hits.fetch_add(1, std::memory_order_relaxed);
+        return result;
+    }
+    auto pending = std::make_shared<Pending>();
+    pending->hash = hash;
+    pending->canonical = std::move(canonical);
+    pending->N = N;
+    pending->enqueued = waiter.submitted;
+    pending->waiters.push_back(std::move(waiter));
+    if (it == outstanding.end()) {
+        outstanding.emplace(hash, pending);  // hash collisions are simply not deduplicated
+    }
+    queue.push_back(std::move(pending));
+    const bool full = static_cast<int>(queue.size()) >= config.max_batch_size;
+    lock.unlock();
+    if (full) {
+        cv.notify_all();
+    } else {
+        cv.notify_one();
+    }
+    return result;
+}
+
+void AsyncLLMConnector::sender_loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cv.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (queue.empty()) {
+            return;  // stopping with nothing left to send
+        }
+        // Give a partial batch until its oldest entry's deadline to fill up
+        const auto deadline = queue.front()->enqueued + std::chrono::milliseconds(config.max_batch_delay_ms);
+        while (!stopping && !queue.empty() &&
+               static_cast<int>(queue.size()) < config.max_batch_size && Clock::now() < deadline) {
+            cv.wait_until(lock, deadline);
+        }
+        if (queue.empty()) {
+            continue;  // another sender took it
+        }
+        std::vector<std::shared_ptr<Pending>> batch;
+        while (!queue.empty() && static_cast<int>(batch.size()) < config.max_batch_size) {
+            batch.push_back(std::move(queue.front()));
+            queue.pop_front();
+        }
+        lock.unlock();
+        send_batch(batch);
+        lock.lock();
+    }
+}
+
+void AsyncLLMConnector::send_batch(const std::vector<std::shared_ptr<Pending>>& batch) {
+    std::string body = "{\"requests\": [";
+    for (size_t i = 0; i < batch.size(); ++i) {
+        if (i > 0) body += ", ";
+        body += "{\"prompt\": ";
+        append_json_string(body, config.prompt);
+        body += ", \"state\": {\"cells\": [";
+        for (size_t c = 0; c < batch[i]->canonical.size(); ++c) {
+            if (c > 0) body += ',';
+            body += std::to_string(batch[i]->canonical[c]);
+        }
+        body += "], \"N\": " + std::to_string(batch[i]->N) + "}}";
+    }
+    body += "]}";
+
+    std::vector<std::string> responses;
+    const auto start = Clock::now();
+    try {
+        responses = parse_responses(http_post(host, port, path, body, config.timeout_ms));
+    } catch (const std::runtime_error&) {
+        responses.clear();  // every position falls back below
+    }
+    num_batches.fetch_add(1, std::memory_order_relaxed);
+    http_latency.record(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start));
+    if (responses.size() != batch.size()) {
+        responses.clear();
+    }
+
+    // Validate in the canonical frame, publish to the cache and detach the waiters
+    std::vector<int> actions(batch.size(), -1);
+    std::vector<std::vector<Waiter>> waiters(batch.size());
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < batch.size(); ++i) {
+            Pending& p = *batch[i];
+            if (!responses.empty()) {
+                int a = first_integer(responses[i]);
+                if (a >= 0 && a < p.N * p.N && p.canonical[a] == 0) {
+                    actions[i] = a;
+                }
+            }
+            if (actions[i] >= 0) {
+                if (cache.size() >= config.max_cache_entries) {
+                    cache.clear();
+                }
+                cache.emplace(p.hash, CacheEntry{p.canonical, actions[i]});
+            }
+            auto it = outstanding.find(p.hash);
+            if (it != outstanding.end() && it->second == batch[i]) {
+                outstanding.erase(it);
+            }
+            waiters[i] = std::move(p.waiters);
+        }
+    }
+    for (size_t i = 0; i < batch.size(); ++i) {
+        if (actions[i] < 0) {
+            num_errors.fetch_add(waiters[i].size(), std::memory_order_relaxed);
+        }
+        for (Waiter& w : waiters[i]) {
+            resolve(w, actions[i], batch[i]->N);
+        }
+    }
+}
+
+void AsyncLLMConnector::resolve(Waiter& waiter, int canonical_action, int N) {
+    int action;
+    if (canonical_action >= 0) {
+        // Map the answer back from the canonical board to the caller's board
+        action = transform_cell(N, inverse_symmetry(waiter.symmetry), canonical_action);
+    } else {
+        action = static_cast<int>(std::find(waiter.cells.begin(), waiter.cells.end(), 0) - waiter.cells.begin());
+    }
+    request_latency.record(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - waiter.submitted));
+    waiter.promise.set_value(Action{action});
+}
+
+LLMConnectorStats AsyncLLMConnector::get_stats() const {
+    return LLMConnectorStats{
+        num_requests.load(std::memory_order_relaxed),
+        num_cache_hits.load(std::memory_order_relaxed),
+        num_batches.load(std::memory_order_relaxed),
+        num_errors.load(std::memory_order_relaxed),
+    };
+}
@@ -0,0 +1,139 @@
+#include "match_runner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+struct GameSlot {
+    Environment env;
+    Match match;
+    uint64_t game;
+    int moves;
+    bool active;
+};
+
+}  // namespace
+
+int run_matches(const std::vector<std::shared_ptr<const Agent>>& agents, uint64_t num_games,
+                const MatchRunnerConfig& config, const MatchSchedule& schedule, const MatchReport& report) {
+    if (config.N <= 0 || config.games_per_thread <= 0) {
+        throw std::invalid_argument("Board size and games per thread must be positive");
+    }
+    int num_threads = config.num_threads > 0 ? config.num_threads
+                                             : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    const uint64_t needed = (num_games + config.games_per_thread - 1) / config.games_per_thread;
+    num_threads = static_cast<int>(std::max<uint64_t>(1, std::min<uint64_t>(num_threads, needed)));
+
+    const CounterRng rng(config.seed);
+    const int num_agents = static_cast<int>(agents.size());
+    std::atomic<uint64_t> next_game(0);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto worker = [&](int worker_id) {
+        try {
+            // Agents carry scratch state, so each worker plays with its own clones
+            std::vector<std::unique_ptr<Agent>> local(num_agents);
+            auto reward_fn = std::make_shared<DefaultReward>();
+            std::vector<GameSlot> slots;
+            slots.reserve(config.games_per_thread);
+
+            auto start_next = [&](GameSlot& slot) {
+                uint64_t game = next_game.fetch_add(1, std::memory_order_relaxed);
+                if (game >= num_games) {
+                    slot.active = false;
+                    return;
+                }
+                slot.match = schedule(game);
+                if (slot.match.first < 0 || slot.match.first >= num_agents ||
+                    slot.match.second < 0 || slot.match.second >= num_agents) {
+                    throw std::invalid_argument("Scheduled match refers to an unknown agent");
+                }
+                for (int a : {slot.match.first, slot.match.second}) {
+                    if (!local[a]) local[a] = agents[a]->clone();
+                }
+                slot.env.reset_in_place();
+                slot.game = game;
+                slot.moves = 0;
+                slot.active = true;
+            };
+
+            for (int s = 0; s < config.games_per_thread; ++s) {
+                slots.push_back(GameSlot{Environment(config.N, reward_fn), Match{0, 0}, 0, 0, false});
+                start_next(slots.back());
+                if (!slots.back().active) {
+                    slots.pop_back();
+                    break;
+                }
+            }
+
+            std::vector<std::vector<int>> to_move(num_agents);
+            std::vector<const Environment*> envs;
+            std::vector<RngStream> streams;
+            std::vector<int32_t> actions;
+            bool any_active = !slots.empty();
+            while (any_active) {
+                for (auto& group : to_move) group.clear();
+                for (int s = 0; s < static_cast<int>(slots.size()); ++s) {
+                    const GameSlot& slot = slots[s];
+                    if (!slot.active) continue;
+                    int mover = slot.env.get_current_player() == 1 ? slot.match.first : slot.match.second;
+                    to_move[mover].push_back(s);
+                }
+                any_active = false;
+                for (int a = 0; a < num_agents; ++a) {
+                    const std::vector<int>& group = to_move[a];
+                    if (group.empty()) continue;
+                    envs.clear();
+                    streams.clear();
+                    for (int s : group) {
+                        envs.push_back(&slots[s].env);
+                        const uint64_t game = slots[s].game + config.game_offset;
+                        streams.emplace_back(rng, static_cast<uint32_t>(game),
+                                             ((game >> 32) << 32) | static_cast<uint64_t>(slots[s].moves));
+                    }
+                    actions.resize(group.size());
+                    local[a]->act(envs.data(), streams.data(), static_cast<int>(group.size()), actions.data());
+
+                    for (size_t k = 0; k < group.size(); ++k) {
+                        GameSlot& slot = slots[group[k]];
+                        float reward;
+                        bool done;
+                        slot.env.step_in_place(Action{actions[k]}, reward, done);
+                        slot.moves++;
+                        if (done) {
+                            const int winner = slot.env.get_winner();
+                            const int8_t outcome = winner == 1 ? OUTCOME_PLAYER1_WIN
+                                                 : winner == -1 ? OUTCOME_PLAYER2_WIN
+                                                 : OUTCOME_DRAW;
+                            report(worker_id, slot.game, slot.match, outcome);
+                            start_next(slot);
+                        }
+                        any_active |= slot.active;
+                    }
+                }
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) error = std::current_exception();
+            next_game.store(num_games);  // let the other workers wind down
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < num_threads; ++t) {
+        threads.emplace_back(worker, t);
+    }
+    worker(0);
+    for (auto& t : threads) {
+        t.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return num_threads;
+}
@@ -0,0 +1,69 @@
+#include "rng.h"
+
+namespace {
+
+constexpr int kLanes = 8;
+
+// Philox over kLanes consecutive env indices in struct-of-arrays form
+void philox_lanes(uint32_t env_begin, uint64_t step, uint32_t draw, uint32_t key0, uint32_t key1,
+                  uint32_t c0[kLanes], uint32_t c1[kLanes], uint32_t c2[kLanes], uint32_t c3[kLanes]) {
+    for (int l = 0; l < kLanes; ++l) {
+        c0[l] = draw;
+        c1[l] = env_begin + static_cast<uint32_t>(l);
+        c2[l] = static_cast<uint32_t>(step);
+        c3[l] = static_cast<uint32_t>(step >> 32);
+    }
+    for (int round = 0; round < 10; ++round) {
+        for (int l = 0; l < kLanes; ++l) {
+            const uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * c0[l];
+            const uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * c2[l];
+            const uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1[l] ^ key0;
+            const uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3[l] ^ key1;
+            c0[l] = n0;
+            c1[l] = static_cast<uint32_t>(p1);
+            c2[l] = n2;
+            c3[l] = static_cast<uint32_t>(p0);
+        }
+        key0 += 0x9E3779B9u;
+        key1 += 0xBB67AE85u;
+    }
+}
+
+}  // namespace
+
+void CounterRng::fill_uniform(uint32_t env_begin, int count, uint64_t step, uint32_t draw, float* out) const {
+    const uint32_t key0 = static_cast<uint32_t>(seed);
+    const uint32_t key1 = static_cast<uint32_t>(seed >> 32);
+    int i = 0;
+    for (; i + kLanes <= count; i += kLanes) {
+        uint32_t c0[kLanes], c1[kLanes], c2[kLanes], c3[kLanes];
+        philox_lanes(env_begin + i, step, draw, key0, key1, c0, c1, c2, c3);
+        for (int l = 0; l < kLanes; ++l) {
+            out[i + l] = uint_to_uniform(c0[l]);
+        }
+    }
+    for (; i < count; ++i) {
+        out[i] = uniform(env_begin + i, step, draw);
+    }
+}
+
+void CounterRng::fill_blocks(uint32_t env_begin, int count, uint64_t step, uint32_t draw, uint32_t* out) const {
+    const uint32_t key0 = static_cast<uint32_t>(seed);
+    const uint32_t key1 = static_cast<uint32_t>(seed >> 32);
+    int i = 0;
+    for (; i + kLanes <= count; i += kLanes) {
+        uint32_t c0[kLanes], c1[kLanes], c2[kLanes], c3[kLanes];
+        philox_lanes(env_begin + i, step, draw, key0, key1, c0, c1, c2, c3);
+        for (int l = 0; l < kLanes; ++l) {
+            uint32_t* o = out + 4 * (i + l);
+            o[0] = c0[l];
+            o[1] = c1[l];
+            o[2] = c2[l];
+            o[3] = c3[l];
+        }
+    }
+    for (; i < count; ++i) {
+        PhiloxBlock b = block(env_begin + i, step, draw);
+        for (int w = 0; w < 4; ++w) out[4 * i + w] = b[w];
+    }
+}
@@ -0,0 +1,132 @@
+#include "sampling.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+// splitmix64: one add + two multiply-xorshift rounds per draw, 8 bytes of state per row
+inline uint64_t next_u64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Uniform float in [0, 1) from the top 24 bits
+inline float next_uniform(uint64_t& state) {
+    return static_cast<float>(next_u64(state) >> 40) * (1.0f / 16777216.0f);
+}
+
+// Smallest shifted logit with a normal-range exp; legal actions further below the row
+// max (including -inf logits) get zero weight
+constexpr float kMinShifted = -87.0f;
+
+// Branch-free exp for x <= 0 (logits are shifted by the row max), written so the
+// calling loops vectorize. Relative error is below 2e-7 over [-87, 0].
+inline float fast_exp(float x) {
+    x = x < kMinShifted ? kMinShifted : x;
+    const float n = std::floor(x * 1.44269504088896341f + 0.5f);
+    // r = x - n*ln2 with ln2 split into high and low parts for accuracy
+    float r = x - n * 0.693359375f;
+    r = r + n * 2.12194440e-4f;
+    float p = 1.9875691500e-4f;
+    p = p * r + 1.3981999507e-3f;
+    p = p * r + 8.3334519073e-3f;
+    p = p * r + 4.1665795894e-2f;
+    p = p * r + 1.6666665459e-1f;
+    p = p * r + 5.0000001201e-1f;
+    p = p * r * r + r + 1.0f;
+    // Scale by 2^n through the exponent bits
+    const int32_t bits = (static_cast<int32_t>(n) + 127) << 23;
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+}
+
+inline bool is_legal(const float* row, const uint8_t* mask_row, int i) {
+    return mask_row != nullptr ? mask_row[i] != 0 : row[i] != -std::numeric_limits<float>::infinity();
+}
+
+// Masked softmax, sample and statistics for row b given its uniform draw u
+void sample_row(const float* logits, const uint8_t* mask, int b, int num_actions, float u,
+                int32_t* actions, float* log_probs, float* entropy) {
+    const float neg_inf = -std::numeric_limits<float>::infinity();
+    const float* row = logits + static_cast<size_t>(b) * num_actions;
+    const uint8_t* mask_row = mask != nullptr ? mask + static_cast<size_t>(b) * num_actions : nullptr;
+
+    // Pass 1: max over legal logits
+    float max_logit = neg_inf;
+    for (int i = 0; i < num_actions; ++i) {
+        const float v = is_legal(row, mask_row, i) ? row[i] : neg_inf;
+        max_logit = v > max_logit ? v : max_logit;
+    }
+
+    if (max_logit == neg_inf) {
+        // No legal action in this row
+        actions[b] = -1;
+        if (log_probs) log_probs[b] = 0.0f;
+        if (entropy) entropy[b] = 0.0f;
+        return;
+    }
+
+    // Pass 2: partition function and E[x - max] for the entropy
+    float z = 0.0f;
+    float weighted = 0.0f;
+    for (int i = 0; i < num_actions; ++i) {
+        const bool legal = is_legal(row, mask_row, i);
+        const float shifted = legal ? row[i] - max_logit : 0.0f;
+        const bool live = legal && shifted > kMinShifted;
+        const float e = live ? fast_exp(shifted) : 0.0f;
+        z += e;
+        weighted += live ? e * shifted : 0.0f;
+    }
+    const float log_z = std::log(z);
+
+    // Pass 3: inverse-CDF walk to the sampled action
+    const float target = u * z;
+    float cumulative = 0.0f;
+    int chosen = -1;
+    for (int i = 0; i < num_actions; ++i) {
+        if (!is_legal(row, mask_row, i) || !(row[i] - max_logit > kMinShifted)) continue;
+        chosen = i;
+        cumulative += fast_exp(row[i] - max_logit);
+        if (cumulative > target) break;
+    }
+
+    actions[b] = chosen;
+    if (log_probs) log_probs[b] = (row[chosen] - max_logit) - log_z;
+    if (entropy) entropy[b] = log_z - weighted / z;
+}
+
+}  // namespace
+
+void seed_sampler_states(uint64_t seed, uint64_t* rng_states, int batch) {
+    uint64_t state = seed;
+    for (int b = 0; b < batch; ++b) {
+        rng_states[b] = next_u64(state);
+    }
+}
+
+void sample_masked_categorical(const float* logits, const uint8_t* mask, int batch, int num_actions,
+                               uint64_t* rng_states, int32_t* actions, float* log_probs, float* entropy) {
+    for (int b = 0; b < batch; ++b) {
+        sample_row(logits, mask, b, num_actions, next_uniform(rng_states[b]), actions, log_probs, entropy);
+    }
+}
+
+void sample_masked_categorical(const float* logits, const uint8_t* mask, int batch, int num_actions,
+                               const CounterRng& rng, uint32_t env_begin, uint64_t step,
+                               int32_t* actions, float* log_probs, float* entropy) {
+    // Uniforms are generated a chunk at a time with the vectorized Philox path
+    constexpr int kChunk = 64;
+    float uniforms[kChunk];
+    for (int begin = 0; begin < batch; begin += kChunk) {
+        const int count = batch - begin < kChunk ? batch - begin : kChunk;
+        rng.fill_uniform(env_begin + static_cast<uint32_t>(begin), count, step, kSamplerDraw, uniforms);
+        for (int i = 0; i < count; ++i) {
+            sample_row(logits, mask, begin + i, num_actions, uniforms[i], actions, log_probs, entropy);
+        }
+    }
+}
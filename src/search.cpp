@@ -0,0 +1,345 @@
+#include "search.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+enum : int { kBoundUpper = 1, kBoundLower = 2, kBoundExact = 3 };
+
+constexpr int kMaxPly = 64;
+constexpr uint8_t kNoMove = 0xFF;
+constexpr uint64_t kValidBit = 1ull << 48;
+constexpr int kForcedScore = kSearchWinScore - 100;  // beyond this a score is a forced result
+
+uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+}  // namespace
+
+struct AlphaBetaEngine::Worker {
+    AlphaBetaEngine& engine;
+    bool can_abort;
+    bool aborted = false;
+    uint64_t nodes = 0;
+    uint64_t unreported = 0;
+    int killers[kMaxPly][2];
+    int history[2][64] = {};
+    int centrality[64];
+
+    Worker(AlphaBetaEngine& engine, bool can_abort) : engine(engine), can_abort(can_abort) {
+        std::fill(&killers[0][0], &killers[0][0] + kMaxPly * 2, -1);
+        const int N = engine.N;
+        for (int c = 0; c < N * N; ++c) {
+            // Distance from the centre, doubled so even boards get a symmetric ranking
+            const int dr = std::abs(2 * (c / N) - (N - 1));
+            const int dc = std::abs(2 * (c % N) - (N - 1));
+            centrality[c] = -(dr + dc);
+        }
+    }
+
+    // Empty cells that would complete a line for `me`
+    uint64_t win_cells(uint64_t me, uint64_t opp) const {
+        uint64_t cells = 0;
+        for (uint64_t line : engine.lines) {
+            if ((line & opp) == 0 && __builtin_popcountll(line & me) == engine.K - 1) {
+                cells |= line & ~me;
+            }
+        }
+        return cells;
+    }
+
+    // Lines still open for one side score (stones in the line)^2, mine minus theirs
+    int evaluate(uint64_t me, uint64_t opp) const {
+        int score = 0;
+        for (uint64_t line : engine.lines) {
+            const int mine = __builtin_popcountll(line & me);
+            const int theirs = __builtin_popcountll(line & opp);
+            if (theirs == 0) score += mine * mine;
+            if (mine == 0) score -= theirs * theirs;
+        }
+        return score;
+    }
+
+    bool out_of_budget() {
+        engine.total_nodes.fetch_add(unreported, std::memory_order_relaxed);
+        unreported = 0;
+        if (engine.stop_flag.load(std::memory_order_relaxed)) return true;
+        const SearchLimits& limits = engine.limits;
+        if ((limits.time_ms > 0 && std::chrono::steady_clock::now() >= engine.deadline) ||
+            (limits.max_nodes > 0 && engine.total_nodes.load(std::memory_order_relaxed) >= limits.max_nodes)) {
+            engine.stop_flag.store(true, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    // Value for the side to move (`me`, stone colour `side`). The previous move did not
+    // end the game. root_move, when given, receives the best move.
+    int negamax(uint64_t me, uint64_t opp, int side, uint64_t key, int depth, int ply, int alpha, int beta,
+                int* root_move) {
+        nodes++;
+        if (++unreported >= 1024 && can_abort && out_of_budget()) {
+            aborted = true;
+        }
+        if (aborted) return 0;
+
+        const uint64_t empty = engine.board_mask & ~(me | opp);
+        if (empty == 0) return 0;
+        const uint64_t wins = win_cells(me, opp);
+        if (wins != 0) {
+            if (root_move) *root_move = __builtin_ctzll(wins);
+            return kSearchWinScore - (ply + 1);
+        }
+        const uint64_t threats = win_cells(opp, me);
+        if (__builtin_popcountll(threats) >= 2) {
+            if (root_move) *root_move = __builtin_ctzll(threats);
+            return -(kSearchWinScore - (ply + 2));
+        }
+        if (depth <= 0 || ply >= kMaxPly - 1) {
+            return evaluate(me, opp);
+        }
+
+        int tt_depth, tt_score, tt_bound, tt_move = -1;
+        if (engine.probe_table(key, ply, tt_depth, tt_score, tt_bound, tt_move) && !root_move && tt_depth >= depth) {
+            if (tt_bound == kBoundExact ||
+                (tt_bound == kBoundLower && tt_score >= beta) ||
+                (tt_bound == kBoundUpper && tt_score <= alpha)) {
+                return tt_score;
+            }
+        }
+
+        // A single threat must be blocked; otherwise every empty cell is a candidate
+        const uint64_t candidates = threats != 0 ? threats : empty;
+        int moves[64];
+        int scores[64];
+        int count = 0;
+        for (uint64_t rest = candidates; rest != 0; rest &= rest - 1) {
+            const int m = __builtin_ctzll(rest);
+            moves[count] = m;
+            scores[count] = m == tt_move ? 1 << 30
+                          : m == killers[ply][0] ? 1 << 29
+                          : m == killers[ply][1] ? 1 << 28
+                          : history[side][m] * 16 + centrality[m];
+            count++;
+        }
+
+        const int alpha_in = alpha;
+        int best = -kSearchWinScore;
+        int best_move = moves[0];
+        for (int i = 0; i < count; ++i) {
+            // Selection sort: moves are usually cut off before the list is exhausted
+            int pick = i;
+            for (int j = i + 1; j < count; ++j) {
+                if (scores[j] > scores[pick]) pick = j;
+            }
+            std::swap(moves[i], moves[pick]);
+            std::swap(scores[i], scores[pick]);
+            const int m = moves[i];
+
+            const int score = -negamax(opp, me | (1ull << m), 1 - side, key ^ engine.zobrist[m][side],
+                                       depth - 1, ply + 1, -beta, -alpha, nullptr);
+            if (aborted) return 0;
+            if (score > best) {
+                best = score;
+                best_move = m;
+                if (score > alpha) alpha = score;
+            }
+            if (alpha >= beta) {
+                if (m != killers[ply][0]) {
+                    killers[ply][1] = killers[ply][0];
+                    killers[ply][0] = m;
+                }
+                history[side][m] += depth * depth;
+                if (history[side][m] > (1 << 20)) {
+                    for (int& h : history[side]) h /= 2;
+                }
+                break;
+            }
+        }
+
+        const int bound = best <= alpha_in ? kBoundUpper : best >= beta ? kBoundLower : kBoundExact;
+        engine.store_table(key, ply, depth, best, bound, best_move);
+        if (root_move) *root_move = best_move;
+        return best;
+    }
+};
+
+AlphaBetaEngine::AlphaBetaEngine(const SearchConfig& config) : config(config) {
+    if (config.num_threads <= 0) {
+        throw std::invalid_argument("Search needs at least one thread");
+    }
+    size_t entries = 1024;
+    while (entries * 2 <= config.tt_entries) entries *= 2;
+    table.reset(new TTSlot[entries]);
+    table_mask = entries - 1;
+    clear();
+    uint64_t state = 0x5EA2C4ull;
+    for (auto& cell : zobrist) {
+        cell[0] = splitmix64(state);
+        cell[1] = splitmix64(state);
+    }
+}
+
+void AlphaBetaEngine::clear() {
+    for (uint64_t i = 0; i <= table_mask; ++i) {
+        table[i].check.store(0, std::memory_order_relaxed);
+        table[i].data.store(0, std::memory_order_relaxed);
+    }
+    generation = 0;
+}
+
+void AlphaBetaEngine::set_geometry(int board_size) {
+    const int k = config.K == 0 ? board_size : config.K;
+    if (board_size * board_size > 64) {
+        throw std::invalid_argument("Search supports boards of at most 64 cells");
+    }
+    if (k <= 0 || k > board_size) {
+        throw std::invalid_argument("Win length must be between 1 and N");
+    }
+    if (board_size == N && k == K) return;
+    N = board_size;
+    K = k;
+    board_mask = N * N == 64 ? ~0ull : (1ull << (N * N)) - 1;
+    lines.clear();
+    const int directions[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    for (int r = 0; r < N; ++r) {
+        for (int c = 0; c < N; ++c) {
+            for (const auto& d : directions) {
+                const int end_r = r + (K - 1) * d[0];
+                const int end_c = c + (K - 1) * d[1];
+                if (end_r < 0 || end_r >= N || end_c < 0 || end_c >= N) continue;
+                uint64_t mask = 0;
+                for (int i = 0; i < K; ++i) {
+                    mask |= 1ull << ((r + i * d[0]) * N + c + i * d[1]);
+                }
+                lines.push_back(mask);
+            }
+        }
+    }
+    clear();  // entries from another geometry would alias
+}
+
+bool AlphaBetaEngine::probe_table(uint64_t key, int ply, int& depth, int& score, int& bound, int& move) const {
+    const TTSlot& slot = table[key & table_mask];
+    const uint64_t data = slot.data.load(std::memory_order_relaxed);
+    const uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if ((check ^ data) != key || !(data & kValidBit)) return false;
+    score = static_cast<int16_t>(data & 0xFFFF);
+    depth = static_cast<int>((data >> 16) & 0xFF);
+    bound = static_cast<int>((data >> 24) & 0x3);
+    const uint8_t m = static_cast<uint8_t>(data >> 32);
+    move = m == kNoMove ? -1 : m;
+    // Forced results are stored relative to the node; convert back to distance from the root
+    if (score > kForcedScore) score -= ply;
+    else if (score < -kForcedScore) score += ply;
+    return true;
+}
+
+void AlphaBetaEngine::store_table(uint64_t key, int ply, int depth, int score, int bound, int move) {
+    TTSlot& slot = table[key & table_mask];
+    const uint64_t old = slot.data.load(std::memory_order_relaxed);
+    // Keep deeper results from this search unless they are for the same position
+    if ((old & kValidBit) && static_cast<uint8_t>(old >> 40) == generation &&
+        static_cast<int>((old >> 16) & 0xFF) > depth + 2 &&
+        (slot.check.load(std::memory_order_relaxed) ^ old) != key) {
+        return;
+    }
+    if (score > kForcedScore) score += ply;
+    else if (score < -kForcedScore) score -= ply;
+    const uint64_t data = static_cast<uint64_t>(static_cast<uint16_t>(score)) |
+                          static_cast<uint64_t>(depth & 0xFF) << 16 |
+                          static_cast<uint64_t>(bound) << 24 |
+                          static_cast<uint64_t>(move < 0 ? kNoMove : move) << 32 |
+                          static_cast<uint64_t>(generation) << 40 | kValidBit;
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+    slot.data.store(data, std::memory_order_relaxed);
+}
+
+SearchResult AlphaBetaEngine::search(const Environment& env, const SearchLimits& search_limits) {
+    return search(env.get_state(), env.get_current_player(), search_limits);
+}
+
+SearchResult AlphaBetaEngine::search(const BoardState& state, int player, const SearchLimits& search_limits) {
+    const auto start = std::chrono::steady_clock::now();
+    set_geometry(state.N);
+    if (static_cast<int>(state.cells.size()) != N * N || (player != 1 && player != -1)) {
+        throw std::invalid_argument("Malformed board");
+    }
+    uint64_t me = 0;
+    uint64_t opp = 0;
+    uint64_t key = 0;
+    for (int c = 0; c < N * N; ++c) {
+        if (state.cells[c] == 0) continue;
+        (state.cells[c] == player ? me : opp) |= 1ull << c;
+        key ^= zobrist[c][state.cells[c] == 1 ? 0 : 1];
+    }
+    for (uint64_t line : lines) {
+        if ((line & me) == line || (line & opp) == line) {
+            throw std::invalid_argument("Game is already over");
+        }
+    }
+    if ((me | opp) == board_mask) {
+        throw std::invalid_argument("Game is already over");
+    }
+
+    limits = search_limits;
+    deadline = start + std::chrono::milliseconds(limits.time_ms);
+    stop_flag.store(false, std::memory_order_relaxed);
+    total_nodes.store(0, std::memory_order_relaxed);
+    generation++;
+    const int side = player == 1 ? 0 : 1;
+    const int max_depth = std::max(1, std::min(limits.max_depth, kMaxPly - 1));
+
+    // Lazy SMP helpers: the same iterative deepening, staggered by one ply on odd
+    // threads, sharing only the transposition table
+    std::vector<std::unique_ptr<Worker>> helpers;
+    std::vector<std::thread> threads;
+    for (int t = 1; t < config.num_threads; ++t) {
+        helpers.push_back(std::make_unique<Worker>(*this, true));
+        Worker* helper = helpers.back().get();
+        threads.emplace_back([=] {
+            for (int depth = 1 + t % 2; depth <= max_depth && !helper->aborted; ++depth) {
+                int move;
+                helper->negamax(me, opp, side, key, depth, 0, -kSearchWinScore, kSearchWinScore, &move);
+            }
+        });
+    }
+
+    Worker main(*this, false);
+    SearchResult result;
+    for (int depth = 1; depth <= max_depth; ++depth) {
+        int move = -1;
+        const int score = main.negamax(me, opp, side, key, depth, 0, -kSearchWinScore, kSearchWinScore, &move);
+        if (main.aborted) break;
+        result.move = move;
+        result.score = score;
+        result.depth = depth;
+        main.can_abort = true;  // the first iteration always completes
+        if (std::abs(score) > kForcedScore) break;
+    }
+    stop_flag.store(true, std::memory_order_relaxed);
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    result.nodes = main.nodes;
+    for (const auto& helper : helpers) {
+        result.nodes += helper->nodes;
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+AlphaBetaAgent::AlphaBetaAgent(const SearchLimits& limits, const SearchConfig& config)
+    : limits(limits), config(config), engine(config) {}
+
+void AlphaBetaAgent::act(const Environment* const* envs, RngStream*, int count, int32_t* actions) {
+    for (int i = 0; i < count; ++i) {
+        actions[i] = engine.search(*envs[i], limits).move;
+    }
+}
@@ -0,0 +1,271 @@
+#include "sharded_environment.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// CPUs this process may run on, in increasing order
+std::vector<int> allowed_cpus() {
+    std::vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int c = 0; c < CPU_SETSIZE; ++c) {
+            if (CPU_ISSET(c, &set)) cpus.push_back(c);
+        }
+    }
+#endif
+    if (cpus.empty()) cpus.push_back(0);
+    return cpus;
+}
+
+void pin_current_thread(int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    const int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0) {
+        throw std::runtime_error("Failed to pin shard thread to CPU " + std::to_string(cpu) + ": " + std::strerror(rc));
+    }
+#else
+    (void)cpu;
+#endif
+}
+
+// CPU and NUMA node the calling thread is running on
+void current_cpu(int& cpu, int& node) {
+    cpu = 0;
+    node = 0;
+#ifdef __linux__
+    unsigned c = 0;
+    unsigned n = 0;
+    if (syscall(SYS_getcpu, &c, &n, nullptr) == 0) {
+        cpu = static_cast<int>(c);
+        node = static_cast<int>(n);
+    }
+#endif
+}
+
+}  // namespace
+
+ShardedBatchedEnvironment::ShardedBatchedEnvironment(int num_envs, int N, std::shared_ptr<RewardCallback> reward_fn,
+                                                     const ShardedEnvConfig& config)
+    : num_envs(num_envs), N(N), reward_fn(std::move(reward_fn)) {
+    if (num_envs <= 0) {
+        throw std::invalid_argument("Batch must contain at least one environment");
+    }
+    if (N <= 0) {
+        throw std::invalid_argument("Board size must be positive");
+    }
+    if (config.num_shards < 0) {
+        throw std::invalid_argument("Shard count must not be negative");
+    }
+    const int chunks = (num_envs + kShardGranularity - 1) / kShardGranularity;
+    int num_shards = config.num_shards > 0 ? config.num_shards
+                                           : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    num_shards = std::min(num_shards, chunks);
+
+    std::vector<int> cpus(num_shards, -1);
+    if (config.pin_threads) {
+        if (!config.cpus.empty()) {
+            if (static_cast<int>(config.cpus.size()) < num_shards) {
+                throw std::invalid_argument("Need one CPU per shard to pin threads");
+            }
+            std::copy(config.cpus.begin(), config.cpus.begin() + num_shards, cpus.begin());
+        } else {
+            const std::vector<int> allowed = allowed_cpus();
+            for (int s = 0; s < num_shards; ++s) cpus[s] = allowed[s % allowed.size()];
+        }
+    }
+
+    // Untouched until the workers write their slices
+    const size_t cells = static_cast<size_t>(N) * N;
+    observations = AlignedArray<float>(num_envs * 2 * cells);
+    action_masks = AlignedArray<uint8_t>(num_envs * cells);
+    rewards = AlignedArray<float>(num_envs);
+    dones = AlignedArray<uint8_t>(num_envs);
+    boards = AlignedArray<int8_t>(num_envs * cells);
+    outcomes = AlignedArray<int8_t>(num_envs);
+
+    for (int s = 0; s < num_shards; ++s) {
+        auto shard = std::make_unique<Shard>();
+        shard->begin = std::min(num_envs, static_cast<int>(static_cast<int64_t>(chunks) * s / num_shards) * kShardGranularity);
+        shard->end = std::min(num_envs, static_cast<int>(static_cast<int64_t>(chunks) * (s + 1) / num_shards) * kShardGranularity);
+        shards.push_back(std::move(shard));
+    }
+    // Each worker builds its shard before its first command, as if handling one
+    remaining = num_shards;
+    for (int s = 0; s < num_shards; ++s) {
+        Shard* shard = shards[s].get();
+        const int cpu = cpus[s];
+        shard->thread = std::thread([this, shard, cpu] { run_worker(*shard, cpu); });
+    }
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done_cv.wait(lock, [&] { return remaining == 0; });
+    }
+    for (auto& shard : shards) {
+        if (shard->error && !error) error = shard->error;
+    }
+    if (error) {
+        dispatch(Command::Exit);
+        for (auto& shard : shards) shard->thread.join();
+        std::rethrow_exception(error);
+    }
+}
+
+ShardedBatchedEnvironment::~ShardedBatchedEnvironment() {
+    dispatch(Command::Exit);
+    for (auto& shard : shards) {
+        shard->thread.join();
+    }
+}
+
+const Environment& ShardedBatchedEnvironment::get_env(int i) const {
+    for (const auto& shard : shards) {
+        if (i < shard->end) return shard->envs[i - shard->begin];
+    }
+    throw std::out_of_range("Environment index out of range");
+}
+
+void ShardedBatchedEnvironment::reset() {
+    dispatch(Command::Reset);
+}
+
+void ShardedBatchedEnvironment::step(const int32_t* actions_in) {
+    // Checked against the action masks before any shard moves, as BatchedEnvironment::step
+    // does, so an invalid action leaves the whole batch untouched
+    const unsigned cells = static_cast<unsigned>(N * N);
+    for (int i = 0; i < num_envs; ++i) {
+        if (static_cast<unsigned>(actions_in[i]) >= cells) throw std::invalid_argument("Action index out of bounds");
+        if (!action_masks.data()[i * cells + actions_in[i]]) throw std::invalid_argument("Action targets an occupied cell");
+    }
+    actions = actions_in;
+    dispatch(Command::Step);
+}
+
+void ShardedBatchedEnvironment::dispatch(Command cmd) {
+    std::unique_lock<std::mutex> lock(mutex);
+    command = cmd;
+    generation++;
+    if (cmd == Command::Exit) {
+        command_cv.notify_all();
+        return;
+    }
+    remaining = static_cast<int>(shards.size());
+    command_cv.notify_all();
+    done_cv.wait(lock, [&] { return remaining == 0; });
+    std::exception_ptr error;
+    for (auto& shard : shards) {
+        if (shard->error && !error) error = shard->error;
+        shard->error = nullptr;
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+void ShardedBatchedEnvironment::run_worker(Shard& shard, int requested_cpu) {
+    uint64_t seen = 0;
+    try {
+        if (requested_cpu >= 0) pin_current_thread(requested_cpu);
+        current_cpu(shard.cpu, shard.node);
+        initialize_shard(shard);
+    } catch (...) {
+        shard.error = std::current_exception();
+    }
+    while (true) {
+        Command cmd;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (--remaining == 0) done_cv.notify_one();
+            command_cv.wait(lock, [&] { return generation != seen; });
+            seen = generation;
+            cmd = command;
+        }
+        if (cmd == Command::Exit) return;
+        try {
+            if (cmd == Command::Reset) {
+                reset_shard(shard);
+            } else {
+                step_shard(shard);
+            }
+        } catch (...) {
+            shard.error = std::current_exception();
+        }
+    }
+}
+
+void ShardedBatchedEnvironment::initialize_shard(Shard& shard) {
+    shard.envs.reserve(shard.end - shard.begin);
+    for (int i = shard.begin; i < shard.end; ++i) {
+        shard.envs.emplace_back(N, reward_fn);
+    }
+    // First touch of this shard's slices happens here, on the worker's node
+    reset_shard(shard);
+}
+
+void ShardedBatchedEnvironment::reset_shard(Shard& shard) {
+    const size_t cells = static_cast<size_t>(N) * N;
+    const int begin = shard.begin;
+    const int count = shard.end - shard.begin;
+    for (int i = shard.begin; i < shard.end; ++i) {
+        shard.envs[i - begin].reset_in_place();
+        write_env_buffers(shard, i);
+    }
+    std::fill(rewards.data() + begin, rewards.data() + begin + count, 0.0f);
+    std::fill(dones.data() + begin, dones.data() + begin + count, 0);
+    std::fill(boards.data() + begin * cells, boards.data() + (begin + count) * cells, 0);
+    std::fill(outcomes.data() + begin, outcomes.data() + begin + count, static_cast<int8_t>(OUTCOME_ONGOING));
+}
+
+void ShardedBatchedEnvironment::step_shard(Shard& shard) {
+    const size_t cells = static_cast<size_t>(N) * N;
+    for (int i = shard.begin; i < shard.end; ++i) {
+        Environment& env = shard.envs[i - shard.begin];
+        float reward;
+        bool done;
+        try {
+            env.step_in_place(Action{actions[i]}, reward, done);
+        } catch (...) {
+            // Actions were checked in step(), so this is a reward callback error; keep
+            // stepping the rest of the shard and report the first one
+            if (!shard.error) shard.error = std::current_exception();
+            continue;
+        }
+        rewards.data()[i] = reward;
+        dones.data()[i] = done ? 1 : 0;
+        const int winner = env.get_winner();
+        outcomes.data()[i] = !done ? OUTCOME_ONGOING
+                           : winner == 1 ? OUTCOME_PLAYER1_WIN
+                           : winner == -1 ? OUTCOME_PLAYER2_WIN
+                           : OUTCOME_DRAW;
+        const std::vector<int>& src = env.get_state().cells;
+        int8_t* dst = boards.data() + i * cells;
+        for (size_t c = 0; c < cells; ++c) {
+            dst[c] = static_cast<int8_t>(src[c]);
+        }
+        if (done) {
+            env.reset_in_place();
+        }
+        write_env_buffers(shard, i);
+    }
+}
+
+void ShardedBatchedEnvironment::write_env_buffers(Shard& shard, int i) {
+    const size_t cells = static_cast<size_t>(N) * N;
+    const Environment& env = shard.envs[i - shard.begin];
+    env.write_one_hot_state(observations.data() + i * 2 * cells);
+    env.write_action_mask(action_masks.data() + i * cells);
+}
@@ -0,0 +1,178 @@
+#include "step_profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Written only by the owning thread (plain load + store); atomics make the reads
+// from get_step_profile() well-defined
+struct ThreadCounters {
+    std::atomic<uint64_t> steps{0};
+    std::atomic<uint64_t> calls[kNumStepPhases] = {};
+    std::atomic<uint64_t> ticks[kNumStepPhases] = {};
+};
+
+void bump(std::atomic<uint64_t>& counter, uint64_t amount) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+void add_into(ThreadCounters& dst, const ThreadCounters& src) {
+    dst.steps.fetch_add(src.steps.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    for (int p = 0; p < kNumStepPhases; ++p) {
+        dst.calls[p].fetch_add(src.calls[p].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        dst.ticks[p].fetch_add(src.ticks[p].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+void clear(ThreadCounters& c) {
+    c.steps.store(0, std::memory_order_relaxed);
+    for (int p = 0; p < kNumStepPhases; ++p) {
+        c.calls[p].store(0, std::memory_order_relaxed);
+        c.ticks[p].store(0, std::memory_order_relaxed);
+    }
+}
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<ThreadCounters*> live;
+    ThreadCounters retired;  // counters of threads that have exited
+};
+
+Registry& registry() {
+    // Never destroyed: threads may exit during static destruction
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+struct ThreadSlot {
+    ThreadCounters counters;
+
+    ThreadSlot() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.live.push_back(&counters);
+    }
+
+    ~ThreadSlot() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        add_into(r.retired, counters);
+        r.live.erase(std::find(r.live.begin(), r.live.end(), &counters));
+    }
+};
+
+ThreadCounters& local_counters() {
+    thread_local ThreadSlot slot;
+    return slot.counters;
+}
+
+// Ticks per nanosecond, measured once against steady_clock
+double tick_rate() {
+    static const double rate = [] {
+#if defined(__x86_64__) || defined(__i386__)
+        const auto t0 = std::chrono::steady_clock::now();
+        const uint64_t c0 = step_profiler_detail::read_ticks();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        const uint64_t c1 = step_profiler_detail::read_ticks();
+        const auto t1 = std::chrono::steady_clock::now();
+        const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+        return ns > 0.0 ? static_cast<double>(c1 - c0) / ns : 1.0;
+#else
+        return 1.0;  // read_ticks() already returns nanoseconds
+#endif
+    }();
+    return rate;
+}
+
+}  // namespace
+
+namespace step_profiler_detail {
+
+void record(int phase, uint64_t ticks) {
+    ThreadCounters& c = local_counters();
+    bump(c.calls[phase], 1);
+    bump(c.ticks[phase], ticks);
+}
+
+void count_step() {
+    bump(local_counters().steps, 1);
+}
+
+}  // namespace step_profiler_detail
+
+const char* step_phase_name(StepPhase phase) {
+    switch (phase) {
+        case StepPhase::Validation: return "validation";
+        case StepPhase::Apply: return "apply";
+        case StepPhase::CheckWinCurrent: return "check_win (mover)";
+        case StepPhase::CheckWinOther: return "check_win (opponent)";
+        case StepPhase::BoardFull: return "is_board_full";
+        case StepPhase::RewardCallback: return "reward callback";
+        case StepPhase::ResultCopy: return "StepResult copy";
+        default: return "unknown";
+    }
+}
+
+StepProfile get_step_profile() {
+    ThreadCounters total;
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        add_into(total, r.retired);
+        for (const ThreadCounters* c : r.live) {
+            add_into(total, *c);
+        }
+    }
+    StepProfile profile{};
+    profile.steps = total.steps.load(std::memory_order_relaxed);
+    const double rate = profile.steps > 0 ? tick_rate() : 1.0;
+    for (int p = 0; p < kNumStepPhases; ++p) {
+        profile.phases[p].calls = total.calls[p].load(std::memory_order_relaxed);
+        profile.phases[p].ticks = total.ticks[p].load(std::memory_order_relaxed);
+        profile.phases[p].nanoseconds = profile.phases[p].ticks / rate;
+    }
+    return profile;
+}
+
+void reset_step_profile() {
+    // Counters of threads that are stepping concurrently may keep part of their values
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    clear(r.retired);
+    for (ThreadCounters* c : r.live) {
+        clear(*c);
+    }
+}
+
+void dump_step_profile(std::ostream& out) {
+    if (!step_profiling_enabled()) {
+        out << "Step profiling disabled (configure with -DTICTACTOE_PROFILE_STEP=ON)\n";
+        return;
+    }
+    const StepProfile profile = get_step_profile();
+    double total_ns = 0.0;
+    for (const StepPhaseStats& s : profile.phases) total_ns += s.nanoseconds;
+
+    const std::ios_base::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    out << "Environment::step profile: " << profile.steps << " steps\n";
+    out << std::left << std::setw(24) << "phase" << std::right << std::setw(14) << "calls"
+        << std::setw(14) << "total ms" << std::setw(12) << "ns/call" << std::setw(8) << "share" << "\n";
+    out << std::fixed;
+    for (int p = 0; p < kNumStepPhases; ++p) {
+        const StepPhaseStats& s = profile.phases[p];
+        out << std::left << std::setw(24) << step_phase_name(static_cast<StepPhase>(p)) << std::right
+            << std::setw(14) << s.calls
+            << std::setw(14) << std::setprecision(3) << s.nanoseconds / 1e6
+            << std::setw(12) << std::setprecision(1) << (s.calls > 0 ? s.nanoseconds / s.calls : 0.0)
+            << std::setw(7) << std::setprecision(1) << (total_ns > 0.0 ? 100.0 * s.nanoseconds / total_ns : 0.0)
+            << "%\n";
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
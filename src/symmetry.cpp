@@ -0,0 +1,53 @@
+#include "symmetry.h"
+
+int transform_cell(int N, int t, int index) {
+    int r = index / N;
+    int c = index % N;
+    if (t & 4) {
+        c = N - 1 - c;
+    }
+    for (int k = 0; k < (t & 3); ++k) {
+        // Clockwise quarter turn: (r, c) -> (c, N-1-r)
+        const int nr = c;
+        c = N - 1 - r;
+        r = nr;
+    }
+    return r * N + c;
+}
+
+std::vector<int> symmetry_permutation(int N, int t) {
+    std::vector<int> perm(N * N);
+    for (int i = 0; i < N * N; ++i) {
+        perm[i] = transform_cell(N, t, i);
+    }
+    return perm;
+}
+
+int canonical_symmetry(const BoardState& state) {
+    const int N = state.N;
+    std::vector<int> best(state.cells);
+    std::vector<int> candidate(state.cells.size());
+    int best_t = 0;
+    for (int t = 1; t < kNumSymmetries; ++t) {
+        apply_symmetry(state.cells.data(), candidate.data(), N, t);
+        if (candidate < best) {
+            best.swap(candidate);
+            best_t = t;
+        }
+    }
+    return best_t;
+}
+
+uint64_t hash_cells(const std::vector<int>& cells) {
+    // FNV-1a over the cell values followed by a splitmix finalizer
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (int cell : cells) {
+        h ^= static_cast<uint64_t>(cell + 1);
+        h *= 0x100000001b3ULL;
+    }
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
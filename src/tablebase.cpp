@@ -0,0 +1,379 @@
+#include "tablebase.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint32_t kMagic = 0x42545454;  // 'TTTB'
+constexpr uint32_t kVersion = 1;
+
+constexpr uint8_t kReachable = static_cast<uint8_t>(TablebaseOutcome::Draw);
+constexpr uint8_t kUnreachable = static_cast<uint8_t>(TablebaseOutcome::Unreachable);
+
+uint8_t pack(TablebaseOutcome outcome, int distance) {
+    return static_cast<uint8_t>(static_cast<int>(outcome) | (distance << 2));
+}
+
+// Every run of K cells along a row, column or diagonal, as cell masks
+std::vector<uint64_t> line_masks(int N, int K) {
+    std::vector<uint64_t> lines;
+    const int directions[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    for (int r = 0; r < N; ++r) {
+        for (int c = 0; c < N; ++c) {
+            for (const auto& d : directions) {
+                const int end_r = r + (K - 1) * d[0];
+                const int end_c = c + (K - 1) * d[1];
+                if (end_r < 0 || end_r >= N || end_c < 0 || end_c >= N) continue;
+                uint64_t mask = 0;
+                for (int k = 0; k < K; ++k) {
+                    mask |= 1ull << ((r + k * d[0]) * N + c + k * d[1]);
+                }
+                lines.push_back(mask);
+            }
+        }
+    }
+    return lines;
+}
+
+bool has_line(uint64_t stones, const std::vector<uint64_t>& lines) {
+    for (uint64_t line : lines) {
+        if ((stones & line) == line) return true;
+    }
+    return false;
+}
+
+// Runs fn(begin, end) over [begin, end) in chunks handed out to num_threads threads
+void parallel_for(uint64_t begin, uint64_t end, int num_threads,
+                  const std::function<void(uint64_t, uint64_t)>& fn) {
+    constexpr uint64_t kChunk = 4096;
+    const uint64_t chunks = (end - begin + kChunk - 1) / kChunk;
+    const int threads = static_cast<int>(std::min<uint64_t>(num_threads, std::max<uint64_t>(chunks, 1)));
+    std::atomic<uint64_t> next{0};
+    auto worker = [&] {
+        for (uint64_t chunk = next.fetch_add(1); chunk < chunks; chunk = next.fetch_add(1)) {
+            const uint64_t lo = begin + chunk * kChunk;
+            fn(lo, std::min(end, lo + kChunk));
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& t : pool) {
+        t.join();
+    }
+}
+
+}  // namespace
+
+PositionIndexer::PositionIndexer(int N) : N(N), cells(N * N) {
+    if (N <= 0 || N * N > kTablebaseMaxCells) {
+        throw std::invalid_argument("Tablebase board size must be between 1 and 6");
+    }
+    for (int n = 0; n <= kTablebaseMaxCells; ++n) {
+        for (int k = 0; k <= kTablebaseMaxCells; ++k) {
+            binomial[n][k] = k == 0 ? 1 : n == 0 ? 0 : binomial[n - 1][k - 1] + binomial[n - 1][k];
+        }
+    }
+    layer_offset.assign(cells + 2, 0);
+    for (int s = 0; s <= cells; ++s) {
+        const int x = (s + 1) / 2;
+        const int o = s / 2;
+        layer_offset[s + 1] = layer_offset[s] + binomial[cells][x] * binomial[cells - x][o];
+    }
+}
+
+uint64_t PositionIndexer::rank(uint64_t set) const {
+    uint64_t r = 0;
+    for (int j = 1; set != 0; ++j, set &= set - 1) {
+        r += binomial[__builtin_ctzll(set)][j];
+    }
+    return r;
+}
+
+uint64_t PositionIndexer::unrank(uint64_t r, int k) const {
+    uint64_t set = 0;
+    int c = cells;
+    for (int j = k; j > 0; --j) {
+        do {
+            --c;
+        } while (binomial[c][j] > r);
+        set |= 1ull << c;
+        r -= binomial[c][j];
+    }
+    return set;
+}
+
+uint64_t PositionIndexer::index(uint64_t x, uint64_t o) const {
+    const int xs = __builtin_popcountll(x);
+    const int os = __builtin_popcountll(o);
+    // O cells renumbered over the cells X leaves free
+    uint64_t o_free = 0;
+    for (uint64_t rest = o; rest != 0; rest &= rest - 1) {
+        const int c = __builtin_ctzll(rest);
+        o_free |= 1ull << (c - __builtin_popcountll(x & ((1ull << c) - 1)));
+    }
+    return layer_offset[xs + os] + rank(x) * binomial[cells - xs][os] + rank(o_free);
+}
+
+void PositionIndexer::position(uint64_t index, uint64_t& x, uint64_t& o) const {
+    const int s = static_cast<int>(std::upper_bound(layer_offset.begin(), layer_offset.end(), index)
+                                   - layer_offset.begin()) - 1;
+    const int xs = (s + 1) / 2;
+    const int os = s / 2;
+    const uint64_t o_count = binomial[cells - xs][os];
+    const uint64_t local = index - layer_offset[s];
+    x = unrank(local / o_count, xs);
+    const uint64_t o_free = unrank(local % o_count, os);
+    // Spread the free-cell numbering back over the board
+    o = 0;
+    int free_slot = 0;
+    for (int c = 0; c < cells; ++c) {
+        if (x & (1ull << c)) continue;
+        if (o_free & (1ull << free_slot)) o |= 1ull << c;
+        free_slot++;
+    }
+}
+
+uint64_t PositionIndexer::index(const int* board) const {
+    uint64_t x = 0;
+    uint64_t o = 0;
+    for (int c = 0; c < cells; ++c) {
+        if (board[c] == 1) x |= 1ull << c;
+        else if (board[c] == -1) o |= 1ull << c;
+    }
+    const int xs = __builtin_popcountll(x);
+    const int os = __builtin_popcountll(o);
+    if (xs != os && xs != os + 1) {
+        throw std::invalid_argument("Stone counts cannot occur with X moving first");
+    }
+    return index(x, o);
+}
+
+Tablebase Tablebase::build(const TablebaseConfig& config) {
+    const int N = config.N;
+    const int K = config.K == 0 ? N : config.K;
+    if (K <= 0 || K > N) {
+        throw std::invalid_argument("Win length must be between 1 and N");
+    }
+    Tablebase table(N, K);
+    const PositionIndexer& indexer = table.indexer;
+    if (indexer.size() > config.max_positions) {
+        throw std::invalid_argument("Board has " + std::to_string(indexer.size()) +
+                                    " positions, more than the tablebase limit");
+    }
+    const int num_threads = config.num_threads > 0 ? config.num_threads
+                                                   : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    const int cells = N * N;
+    const std::vector<uint64_t> lines = line_masks(N, K);
+    std::vector<TablebaseEntry>& entries = table.entries;
+    entries.assign(indexer.size(), TablebaseEntry{kUnreachable, TablebaseEntry::kNoMove});
+
+    // Forward: a position is reachable if the side to move has no line yet and taking
+    // back one of the last mover's stones gives a reachable position. Each slot reads
+    // only the finished layer below, so threads never write the same slot.
+    entries[0].packed = kReachable;
+    for (int s = 1; s <= cells; ++s) {
+        parallel_for(indexer.layer_begin(s), indexer.layer_end(s), num_threads, [&](uint64_t lo, uint64_t hi) {
+            for (uint64_t i = lo; i < hi; ++i) {
+                uint64_t x, o;
+                indexer.position(i, x, o);
+                const bool x_moved = s % 2 == 1;
+                const uint64_t last = x_moved ? x : o;
+                if (has_line(x_moved ? o : x, lines)) continue;
+                for (uint64_t rest = last; rest != 0; rest &= rest - 1) {
+                    const uint64_t without = last ^ (rest & -rest);
+                    const uint64_t parent = x_moved ? indexer.index(without, o) : indexer.index(x, without);
+                    if (entries[parent].packed != kUnreachable) {
+                        entries[i].packed = kReachable;
+                        break;
+                    }
+                }
+            }
+        });
+    }
+
+    // Backward: solve each layer from the one above it, full board first
+    for (int s = cells; s >= 0; --s) {
+        parallel_for(indexer.layer_begin(s), indexer.layer_end(s), num_threads, [&](uint64_t lo, uint64_t hi) {
+            for (uint64_t i = lo; i < hi; ++i) {
+                TablebaseEntry& entry = entries[i];
+                if (entry.packed == kUnreachable) continue;
+                uint64_t x, o;
+                indexer.position(i, x, o);
+                const bool x_to_move = s % 2 == 0;
+                if (has_line(x_to_move ? o : x, lines)) {
+                    entry.packed = pack(TablebaseOutcome::Loss, 0);
+                    continue;
+                }
+                if (s == cells) {
+                    entry.packed = pack(TablebaseOutcome::Draw, 0);
+                    continue;
+                }
+                // Win fastest, else draw, else lose slowest; lowest cell among equals
+                int best_score = -1000;
+                const uint64_t occupied = x | o;
+                for (int c = 0; c < cells; ++c) {
+                    if (occupied & (1ull << c)) continue;
+                    const uint64_t child = x_to_move ? indexer.index(x | (1ull << c), o)
+                                                     : indexer.index(x, o | (1ull << c));
+                    const TablebaseEntry reply = entries[child];
+                    const int d = reply.distance() + 1;
+                    int score;
+                    TablebaseOutcome outcome;
+                    if (reply.outcome() == TablebaseOutcome::Loss) {
+                        score = 100 - d;
+                        outcome = TablebaseOutcome::Win;
+                    } else if (reply.outcome() == TablebaseOutcome::Win) {
+                        score = -100 + d;
+                        outcome = TablebaseOutcome::Loss;
+                    } else {
+                        score = 0;
+                        outcome = TablebaseOutcome::Draw;
+                    }
+                    if (score > best_score) {
+                        best_score = score;
+                        entry.packed = pack(outcome, d);
+                        entry.move = static_cast<uint8_t>(c);
+                    }
+                }
+            }
+        });
+    }
+
+    uint64_t reachable = 0;
+    for (const TablebaseEntry& entry : entries) {
+        reachable += entry.packed != kUnreachable;
+    }
+    table.num_reachable = reachable;
+    return table;
+}
+
+const TablebaseEntry& Tablebase::probe(const BoardState& state) const {
+    if (state.N != indexer.board_size() || static_cast<int>(state.cells.size()) != state.N * state.N) {
+        throw std::invalid_argument("Board size does not match the tablebase");
+    }
+    return entries[indexer.index(state.cells.data())];
+}
+
+namespace {
+
+// Header of a mapped file, checked before the indexer is built from it
+const TablebaseHeader* checked_header(const void* base, size_t size, const std::string& path) {
+    const TablebaseHeader* header = static_cast<const TablebaseHeader*>(base);
+    if (size < sizeof(TablebaseHeader) || header->magic != kMagic) {
+        throw std::runtime_error("Not a tablebase file: " + path);
+    }
+    if (header->version != kVersion) {
+        throw std::runtime_error("Unsupported tablebase file version: " + path);
+    }
+    if (header->N == 0 || header->N * header->N > kTablebaseMaxCells || header->K == 0 || header->K > header->N ||
+        header->num_positions != (size - sizeof(TablebaseHeader)) / sizeof(TablebaseEntry)) {
+        throw std::runtime_error("Corrupt tablebase file header: " + path);
+    }
+    return header;
+}
+
+}  // namespace
+
+MappedTablebase::Mapping::Mapping(const std::string& path) : data(nullptr), size(0) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open tablebase file: " + path + ": " + std::strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        throw std::runtime_error("Not a tablebase file: " + path);
+    }
+    size = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        throw std::runtime_error("mmap failed for " + path + ": " + std::strerror(errno));
+    }
+    // Lookups jump around the table; readahead would only pull in pages nobody asked for
+    madvise(mapped, size, MADV_RANDOM);
+    data = static_cast<const uint8_t*>(mapped);
+}
+
+MappedTablebase::Mapping::~Mapping() {
+    munmap(const_cast<uint8_t*>(data), size);
+}
+
+MappedTablebase::MappedTablebase(const std::string& path)
+    : mapping(path),
+      header(checked_header(mapping.data, mapping.size, path)),
+      indexer(static_cast<int>(header->N)),
+      entries(reinterpret_cast<const TablebaseEntry*>(mapping.data + sizeof(TablebaseHeader))) {
+    if (indexer.size() != header->num_positions) {
+        throw std::runtime_error("Corrupt tablebase file header: " + path);
+    }
+}
+
+TablebaseEntry MappedTablebase::probe(const BoardState& state) const {
+    if (state.N != indexer.board_size() || static_cast<int>(state.cells.size()) != state.N * state.N) {
+        throw std::invalid_argument("Board size does not match the tablebase");
+    }
+    return entries[indexer.index(state.cells.data())];
+}
+
+void Tablebase::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Cannot open tablebase file for writing: " + path);
+    }
+    TablebaseHeader header{};
+    header.magic = kMagic;
+    header.version = kVersion;
+    header.N = static_cast<uint32_t>(indexer.board_size());
+    header.K = static_cast<uint32_t>(K);
+    header.num_positions = entries.size();
+    header.num_reachable = num_reachable;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(TablebaseEntry));
+    if (!out) {
+        throw std::runtime_error("Failed writing tablebase file: " + path);
+    }
+}
+
+Tablebase Tablebase::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Cannot open tablebase file: " + path);
+    }
+    TablebaseHeader header{};
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in || header.magic != kMagic) {
+        throw std::runtime_error("Not a tablebase file: " + path);
+    }
+    if (header.version != kVersion) {
+        throw std::runtime_error("Unsupported tablebase file version: " + path);
+    }
+    if (header.N == 0 || header.N * header.N > kTablebaseMaxCells || header.K == 0 || header.K > header.N) {
+        throw std::runtime_error("Corrupt tablebase file header: " + path);
+    }
+    Tablebase table(static_cast<int>(header.N), static_cast<int>(header.K));
+    if (header.num_positions != table.indexer.size()) {
+        throw std::runtime_error("Corrupt tablebase file header: " + path);
+    }
+    table.num_reachable = header.num_reachable;
+    table.entries.resize(header.num_positions);
+    in.read(reinterpret_cast<char*>(table.entries.data()), header.num_positions * sizeof(TablebaseEntry));
+    if (!in) {
+        throw std::runtime_error("Truncated tablebase file: " + path);
+    }
+    return table;
+}
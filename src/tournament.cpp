@@ -0,0 +1,221 @@
+#include "tournament.h"
+#include "batched_environment.h"
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <numeric>
+#include <thread>
+
+namespace {
+
+const double kEloPerNat = 400.0 / std::log(10.0);
+
+}  // namespace
+
+std::vector<double> fit_elo(const std::vector<double>& score, const std::vector<double>& games, int n,
+                            std::vector<double>& ci95) {
+    // Minorization-maximization for Bradley-Terry strengths. One virtual draw per pair
+    // keeps strengths finite for agents that won or lost everything.
+    std::vector<double> gamma(n, 1.0);
+    std::vector<double> wins(n, 0.0);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            if (i != j) wins[i] += score[i * n + j] + 0.5;
+        }
+    }
+    for (int iter = 0; iter < 10000; ++iter) {
+        double change = 0.0;
+        for (int i = 0; i < n; ++i) {
+            double denom = 0.0;
+            for (int j = 0; j < n; ++j) {
+                if (i != j) denom += (games[i * n + j] + 1.0) / (gamma[i] + gamma[j]);
+            }
+            const double updated = wins[i] / denom;
+            change = std::max(change, std::fabs(std::log(updated / gamma[i])));
+            gamma[i] = updated;
+        }
+        if (change < 1e-10) break;
+    }
+
+    std::vector<double> theta(n);
+    for (int i = 0; i < n; ++i) theta[i] = std::log(gamma[i]);
+    const double mean = std::accumulate(theta.begin(), theta.end(), 0.0) / n;
+
+    // Interval from the observed Fisher information of each rating (real games only)
+    std::vector<double> elo(n);
+    ci95.assign(n, 0.0);
+    for (int i = 0; i < n; ++i) {
+        elo[i] = 1500.0 + kEloPerNat * (theta[i] - mean);
+        double information = 0.0;
+        for (int j = 0; j < n; ++j) {
+            if (i == j) continue;
+            const double p = gamma[i] / (gamma[i] + gamma[j]);
+            information += games[i * n + j] * p * (1.0 - p);
+        }
+        ci95[i] = information > 0.0 ? 1.96 * kEloPerNat / std::sqrt(information)
+                                    : std::numeric_limits<double>::infinity();
+    }
+    return elo;
+}
+
+Tournament::Tournament(const TournamentConfig& config) : config(config) {
+    if (config.board_sizes.empty() || config.games_per_pairing <= 0 || config.max_rounds <= 0) {
+        throw std::invalid_argument("Tournament needs board sizes, games per pairing and rounds");
+    }
+}
+
+void Tournament::add_agent(const std::string& name, std::shared_ptr<const Agent> agent, std::vector<int> board_sizes) {
+    if (!agent) {
+        throw std::invalid_argument("Tournament agent must not be null");
+    }
+    if (board_sizes.empty()) {
+        board_sizes = config.board_sizes;
+    }
+    entries.push_back(Entry{name, std::move(agent), std::move(board_sizes)});
+}
+
+std::vector<TournamentResult> Tournament::run() {
+    const int sizes = static_cast<int>(config.board_sizes.size());
+    const int total_threads = config.num_threads > 0 ? config.num_threads
+                                                     : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    const int per_event = std::max(1, total_threads / sizes);
+
+    std::vector<TournamentResult> results(sizes);
+    std::vector<std::exception_ptr> errors(sizes);
+    std::vector<std::thread> threads;
+    for (int s = 1; s < sizes; ++s) {
+        threads.emplace_back([&, s] {
+            try {
+                results[s] = run_event(config.board_sizes[s], per_event);
+            } catch (...) {
+                errors[s] = std::current_exception();
+            }
+        });
+    }
+    try {
+        results[0] = run_event(config.board_sizes[0], per_event);
+    } catch (...) {
+        errors[0] = std::current_exception();
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (const auto& e : errors) {
+        if (e) std::rethrow_exception(e);
+    }
+    return results;
+}
+
+TournamentResult Tournament::run_event(int N, int num_threads) const {
+    std::vector<const Entry*> players;
+    for (const Entry& e : entries) {
+        if (std::find(e.board_sizes.begin(), e.board_sizes.end(), N) != e.board_sizes.end()) {
+            players.push_back(&e);
+        }
+    }
+    const int n = static_cast<int>(players.size());
+    TournamentResult result{N, 0, false, {}};
+    if (n < 2) {
+        for (const Entry* p : players) {
+            result.ratings.push_back(Rating{p->name, 1500.0, std::numeric_limits<double>::infinity(), 0, 0.0});
+        }
+        return result;
+    }
+
+    std::vector<std::shared_ptr<const Agent>> agents;
+    for (const Entry* p : players) agents.push_back(p->agent);
+
+    MatchRunnerConfig runner;
+    runner.N = N;
+    runner.num_threads = num_threads;
+    runner.games_per_thread = config.games_per_thread;
+    runner.seed = config.seed ^ (static_cast<uint64_t>(N) * 0x9E3779B97F4A7C15ULL);
+
+    std::vector<double> score(n * n, 0.0);
+    std::vector<double> games(n * n, 0.0);
+    // Per-worker tables so reporting a game never contends with another thread
+    std::vector<std::vector<double>> worker_score(num_threads, std::vector<double>(n * n));
+    std::vector<std::vector<double>> worker_games(num_threads, std::vector<double>(n * n));
+    std::vector<double> elo(n, 1500.0);
+    std::vector<double> ci95(n, std::numeric_limits<double>::infinity());
+    uint64_t played = 0;
+
+    for (int round = 0; round < config.max_rounds; ++round) {
+        // Pairings for this round
+        std::vector<std::pair<int, int>> pairings;
+        if (config.format == TournamentFormat::RoundRobin) {
+            for (int a = 0; a < n; ++a) {
+                for (int b = a + 1; b < n; ++b) pairings.emplace_back(a, b);
+            }
+        } else {
+            std::vector<int> standings(n);
+            std::iota(standings.begin(), standings.end(), 0);
+            std::stable_sort(standings.begin(), standings.end(), [&](int a, int b) { return elo[a] > elo[b]; });
+            std::vector<bool> paired(n, false);
+            for (int k = 0; k < n; ++k) {
+                const int a = standings[k];
+                if (paired[a]) continue;
+                // Nearest unpaired neighbour, preferring opponents met least often
+                int best = -1;
+                for (int m = k + 1; m < n; ++m) {
+                    const int b = standings[m];
+                    if (!paired[b] && (best < 0 || games[a * n + b] < games[a * n + best])) best = b;
+                }
+                if (best < 0) break;  // odd agent out sits this round
+                paired[a] = paired[best] = true;
+                pairings.emplace_back(a, best);
+            }
+        }
+
+        std::vector<Match> matches;
+        for (const auto& p : pairings) {
+            for (int g = 0; g < config.games_per_pairing; ++g) {
+                matches.push_back(g % 2 == 0 ? Match{p.first, p.second} : Match{p.second, p.first});
+            }
+        }
+        runner.game_offset = played;
+        run_matches(agents, matches.size(), runner,
+                    [&](uint64_t game) { return matches[game]; },
+                    [&](int worker, uint64_t, const Match& m, int8_t outcome) {
+                        const double first_points = outcome == OUTCOME_PLAYER1_WIN ? 1.0
+                                                  : outcome == OUTCOME_PLAYER2_WIN ? 0.0 : 0.5;
+                        worker_score[worker][m.first * n + m.second] += first_points;
+                        worker_score[worker][m.second * n + m.first] += 1.0 - first_points;
+                        worker_games[worker][m.first * n + m.second] += 1.0;
+                        worker_games[worker][m.second * n + m.first] += 1.0;
+                    });
+        played += matches.size();
+        for (int w = 0; w < num_threads; ++w) {
+            for (int k = 0; k < n * n; ++k) {
+                score[k] += worker_score[w][k];
+                games[k] += worker_games[w][k];
+            }
+            std::fill(worker_score[w].begin(), worker_score[w].end(), 0.0);
+            std::fill(worker_games[w].begin(), worker_games[w].end(), 0.0);
+        }
+
+        elo = fit_elo(score, games, n, ci95);
+        result.rounds = round + 1;
+        if (result.rounds >= config.min_rounds &&
+            *std::max_element(ci95.begin(), ci95.end()) <= config.target_ci) {
+            result.converged = true;
+            break;
+        }
+    }
+
+    for (int i = 0; i < n; ++i) {
+        double total_games = 0.0;
+        double total_score = 0.0;
+        for (int j = 0; j < n; ++j) {
+            total_games += games[i * n + j];
+            total_score += score[i * n + j];
+        }
+        result.ratings.push_back(Rating{players[i]->name, elo[i], ci95[i], static_cast<uint64_t>(total_games),
+                                        total_games > 0 ? total_score / total_games : 0.0});
+    }
+    std::sort(result.ratings.begin(), result.ratings.end(),
+              [](const Rating& a, const Rating& b) { return a.elo > b.elo; });
+    return result;
+}
@@ -0,0 +1,632 @@
+#include <iostream>
+#include "../include/environment.h"
+#include "../include/batched_environment.h"
+#include "../include/symmetry.h"
+#include <memory>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Batch reward hook that records its calls and pays +1 to the winner's side of each finished game
+class CountingBatchReward : public BatchRewardCallback {
+public:
+    int calls = 0;
+    std::vector<int8_t> last_outcomes;
+    std::vector<int8_t> last_boards;
+
+    void operator()(const int8_t* boards, const int32_t* actions, const int8_t* outcomes,
+                    int num_envs, int N, float* rewards) override {
+        calls++;
+        last_outcomes.assign(outcomes, outcomes + num_envs);
+        last_boards.assign(boards, boards + num_envs * N * N);
+        for (int i = 0; i < num_envs; ++i) {
+            assert(actions[i] >= 0 && actions[i] < N * N);
+            assert(boards[i * N * N + actions[i]] != 0);  // the move is on the board
+            rewards[i] = outcomes[i] == OUTCOME_PLAYER1_WIN ? 1.0f
+                       : outcomes[i] == OUTCOME_PLAYER2_WIN ? -1.0f
+                       : 0.0f;
+        }
+    }
+};
+
+int main() {
+    std::cout << "=== Testing Batched Environment ===" << std::endl;
+    auto reward_fn = std::make_shared<DefaultReward>();
+
+    // Test 1: Buffer-writing accessors match the vector accessors
+    std::cout << "\n1. Testing write_one_hot_state/write_action_mask..." << std::endl;
+    Environment env(4, reward_fn);
+    env.reset();
+    env.step(Action{5});
+    env.step(Action{10});
+    env.step(Action{0});
+    std::vector<float> one_hot = env.get_one_hot_state();
+    std::vector<bool> mask = env.get_action_mask();
+    std::vector<float> written_one_hot(2 * 16, -1.0f);
+    std::vector<uint8_t> written_mask(16, 7);
+    env.write_one_hot_state(written_one_hot.data());
+    env.write_action_mask(written_mask.data());
+    for (int i = 0; i < 32; ++i) assert(written_one_hot[i] == one_hot[i]);
+    for (int i = 0; i < 16; ++i) assert(written_mask[i] == (mask[i] ? 1 : 0));
+    assert(env.get_current_player() == -1);
+    assert(env.get_state().cells[5] == 1 && env.get_state().cells[10] == -1);
+    std::cout << "✓ Buffer writers agree with get_one_hot_state/get_action_mask" << std::endl;
+
+    // Test 2: step_in_place matches step
+    std::cout << "\n2. Testing step_in_place against step..." << std::endl;
+    Environment a(3, reward_fn), b(3, reward_fn);
+    a.reset();
+    b.reset();
+    for (int action : {0, 3, 1, 4, 2}) {
+        StepResult res = a.step(Action{action});
+        float reward;
+        bool done;
+        b.step_in_place(Action{action}, reward, done);
+        assert(res.next_state == b.get_state());
+        assert(res.reward == reward && res.done == done);
+    }
+    assert(b.get_state().cells[2] == 1);
+    std::cout << "✓ step_in_place produces the same transitions" << std::endl;
+
+    // Test 3: Batched stepping matches independent environments
+    std::cout << "\n3. Testing batched step against independent environments..." << std::endl;
+    const int B = 4;
+    const int N = 3;
+    BatchedEnvironment batch(B, N, reward_fn);
+    batch.reset();
+    const float* obs_ptr = batch.get_observations();
+    std::vector<Environment> reference(B, Environment(N, reward_fn));
+    for (auto& e : reference) e.reset();
+
+    std::vector<std::vector<int32_t>> moves = {
+        {0, 4, 8, 2},
+        {1, 0, 5, 6},
+        {2, 1, 4, 3},
+        {3, 2, 0, 7},
+    };
+    for (const auto& actions : moves) {
+        batch.step(actions.data());
+        for (int i = 0; i < B; ++i) {
+            StepResult res = reference[i].step(Action{actions[i]});
+            assert(batch.get_rewards()[i] == res.reward);
+            assert(batch.get_dones()[i] == (res.done ? 1 : 0));
+            std::vector<float> ref_obs = reference[i].get_one_hot_state();
+            std::vector<bool> ref_mask = reference[i].get_action_mask();
+            for (int c = 0; c < 2 * N * N; ++c) {
+                assert(batch.get_observations()[i * 2 * N * N + c] == ref_obs[c]);
+            }
+            for (int c = 0; c < N * N; ++c) {
+                assert(batch.get_action_masks()[i * N * N + c] == (ref_mask[c] ? 1 : 0));
+            }
+        }
+    }
+    assert(batch.get_observations() == obs_ptr);  // buffers never move
+    std::cout << "✓ Batched buffers match per-environment results" << std::endl;
+
+    // Test 4: Finished environments are reset automatically
+    std::cout << "\n4. Testing automatic reset on done..." << std::endl;
+    BatchedEnvironment single(1, 3, reward_fn);
+    single.reset();
+    for (int32_t action : {0, 3, 1, 4}) {
+        single.step(&action);
+        assert(single.get_dones()[0] == 0);
+    }
+    int32_t winning = 2;
+    single.step(&winning);
+    assert(single.get_dones()[0] == 1);
+    for (int c = 0; c < 9; ++c) {
+        assert(single.get_action_masks()[c] == 1);
+        assert(single.get_env(0).get_state().cells[c] == 0);
+    }
+    assert(single.get_env(0).get_current_player() == 1);
+    std::cout << "✓ Done environment reported and reset to an empty board" << std::endl;
+
+    // Test 5: Invalid construction and invalid actions
+    std::cout << "\n5. Testing invalid arguments..." << std::endl;
+    try {
+        BatchedEnvironment empty(0, 3, reward_fn);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    try {
+        int32_t out_of_bounds = 9;
+        single.step(&out_of_bounds);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    {
+        // A bad action anywhere in the row rejects the whole batch before anything moves
+        BatchedEnvironment pair(2, 3, reward_fn);
+        pair.reset();
+        const std::vector<int32_t> draw = {0, 1, 2, 4, 3, 5, 7, 6};  // 8 moves of a drawn game
+        for (int32_t move : draw) {
+            int32_t row[2] = {move, move};
+            pair.step(row);
+        }
+        int32_t bad[2] = {8, 99};
+        try {
+            pair.step(bad);
+            assert(false);
+        } catch (const std::invalid_argument& e) {
+            std::cout << "Caught expected exception: " << e.what() << std::endl;
+        }
+        assert(pair.get_env(0).get_state().cells[8] == 0 && pair.get_dones()[0] == 0);
+        bad[1] = 0;  // occupied
+        try {
+            pair.step(bad);
+            assert(false);
+        } catch (const std::invalid_argument& e) {
+            std::cout << "Caught expected exception: " << e.what() << std::endl;
+        }
+        // Both environments finish the draw together and reset, and keep stepping
+        int32_t last[2] = {8, 8};
+        pair.step(last);
+        assert(pair.get_dones()[0] == 1 && pair.get_dones()[1] == 1);
+        assert(pair.get_outcomes()[0] == OUTCOME_DRAW && pair.get_outcomes()[1] == OUTCOME_DRAW);
+        pair.set_invalid_action_policy(InvalidActionPolicy::Resample, -1.0f, 1);
+        int32_t taken[2] = {4, 4};
+        pair.step(taken);
+        assert(pair.try_step(taken) == 2);
+        for (int i = 0; i < 2; ++i) {
+            const std::vector<int>& cells = pair.get_env(i).get_state().cells;
+            assert(std::count(cells.begin(), cells.end(), 0) == 7);
+        }
+    }
+    {
+        // A throwing batch reward hook still lets finished games reset
+        struct ThrowingReward : BatchRewardCallback {
+            void operator()(const int8_t*, const int32_t*, const int8_t*, int, int, float*) override {
+                throw std::runtime_error("hook failed");
+            }
+        };
+        BatchedEnvironment pair(2, 3, reward_fn);
+        pair.reset();
+        const std::vector<int32_t> win = {0, 3, 1, 4};
+        for (int32_t move : win) {
+            int32_t row[2] = {move, move};
+            pair.step(row);
+        }
+        pair.set_batch_reward(std::make_shared<ThrowingReward>());
+        int32_t finishing[2] = {2, 8};
+        try {
+            pair.step(finishing);
+            assert(false);
+        } catch (const std::runtime_error& e) {
+            std::cout << "Caught expected exception: " << e.what() << std::endl;
+        }
+        assert(pair.get_dones()[0] == 1 && pair.get_env(0).get_move_count() == 0);
+        assert(pair.get_action_masks()[2] == 1);
+        pair.set_batch_reward(nullptr);
+        int32_t next[2] = {2, 2};
+        pair.step(next);
+    }
+    std::cout << "✓ Invalid arguments rejected" << std::endl;
+
+    // Test 6: Batch reward hook is called once per step with terminal boards
+    std::cout << "\n6. Testing batch reward hook..." << std::endl;
+    BatchedEnvironment hooked(2, 3, reward_fn);
+    auto hook = std::make_shared<CountingBatchReward>();
+    hooked.set_batch_reward(hook);
+    hooked.reset();
+    // Env 0: Player 1 wins on the top row. Env 1: Player 2 wins on the middle row.
+    std::vector<std::vector<int32_t>> hooked_moves = {{0, 0}, {3, 3}, {1, 1}, {4, 4}, {2, 6}, {5, 5}};
+    for (size_t t = 0; t < hooked_moves.size(); ++t) {
+        hooked.step(hooked_moves[t].data());
+        assert(hook->calls == static_cast<int>(t) + 1);
+        if (t == 4) {
+            assert(hook->last_outcomes[0] == OUTCOME_PLAYER1_WIN);
+            assert(hook->last_outcomes[1] == OUTCOME_ONGOING);
+            assert(hooked.get_rewards()[0] == 1.0f && hooked.get_dones()[0] == 1);
+            // The hook saw the terminal board even though env 0 has been reset since
+            assert(hook->last_boards[0] == 1 && hook->last_boards[1] == 1 && hook->last_boards[2] == 1);
+            assert(hooked.get_env(0).get_state().cells[0] == 0);
+        }
+    }
+    assert(hook->last_outcomes[1] == OUTCOME_PLAYER2_WIN);
+    assert(hooked.get_rewards()[1] == -1.0f);
+    assert(hooked.get_outcomes()[1] == OUTCOME_PLAYER2_WIN);
+    hooked.set_batch_reward(nullptr);
+    int32_t next[2] = {0, 0};
+    hooked.step(next);
+    assert(hook->calls == static_cast<int>(hooked_moves.size()));
+    std::cout << "✓ Hook called once per batch with terminal boards and outcomes" << std::endl;
+
+    // Test 7: Environment::try_step reports instead of throwing
+    std::cout << "\n7. Testing Environment::try_step status codes..." << std::endl;
+    Environment probe(3, reward_fn);
+    probe.reset();
+    float reward = 5.0f;
+    bool done = true;
+    assert(probe.try_step(Action{9}, reward, done) == StepStatus::OutOfBounds);
+    assert(probe.try_step(Action{-1}, reward, done) == StepStatus::OutOfBounds);
+    assert(reward == 5.0f && done);  // outputs untouched
+    assert(probe.try_step(Action{4}, reward, done) == StepStatus::Ok);
+    assert(!done && probe.get_current_player() == -1);
+    BoardState before = probe.get_state();
+    assert(probe.try_step(Action{4}, reward, done) == StepStatus::Occupied);
+    assert(probe.get_state() == before && probe.get_current_player() == -1);
+    std::cout << "✓ Invalid actions leave the environment unchanged" << std::endl;
+
+    // Test 8: Reject and penalize-and-end policies
+    std::cout << "\n8. Testing try_step with reject and penalize policies..." << std::endl;
+    BatchedEnvironment lenient(3, 3, reward_fn);
+    lenient.reset();
+    int32_t opening[3] = {4, 4, 4};
+    assert(lenient.try_step(opening) == 0);
+    for (int i = 0; i < 3; ++i) assert(lenient.get_statuses()[i] == static_cast<uint8_t>(StepStatus::Ok));
+    int32_t mixed[3] = {0, 4, 12};  // valid, occupied, out of bounds
+    assert(lenient.try_step(mixed) == 2);
+    assert(lenient.get_statuses()[0] == static_cast<uint8_t>(StepStatus::Ok));
+    assert(lenient.get_statuses()[1] == static_cast<uint8_t>(StepStatus::Occupied));
+    assert(lenient.get_statuses()[2] == static_cast<uint8_t>(StepStatus::OutOfBounds));
+    for (int i = 1; i < 3; ++i) {
+        assert(lenient.get_rewards()[i] == 0.0f && !lenient.get_dones()[i]);
+        assert(lenient.get_outcomes()[i] == OUTCOME_ONGOING);
+        assert(lenient.get_env(i).get_current_player() == -1);  // still Player 2's move
+        assert(lenient.get_boards()[i * 9 + 4] == 1);
+    }
+    assert(lenient.get_env(0).get_current_player() == 1);
+    // Only the move that was played is reported as applied
+    assert(lenient.get_actions()[0] == 0 && lenient.get_actions()[1] == kNoAction && lenient.get_actions()[2] == kNoAction);
+
+    lenient.set_invalid_action_policy(InvalidActionPolicy::PenalizeAndEnd, -2.5f);
+    int32_t penalized[3] = {1, 4, 1};  // env 0 is Player 1 to move, envs 1 and 2 Player 2
+    assert(lenient.try_step(penalized) == 1);
+    assert(lenient.get_rewards()[1] == -2.5f && lenient.get_dones()[1] == 1);
+    assert(lenient.get_outcomes()[1] == OUTCOME_PLAYER1_WIN);  // Player 2 made the bad move
+    assert(lenient.get_boards()[9 + 4] == 1 && lenient.get_boards()[9 + 1] == 0);
+    assert(lenient.get_env(1).get_state().cells[4] == 0);     // reset for the next episode
+    assert(!lenient.get_dones()[0] && !lenient.get_dones()[2]);
+    assert(lenient.get_actions()[1] == kNoAction && lenient.get_actions()[2] == 1);
+    std::cout << "✓ Statuses reported; rejected moves skipped, penalized ones end the episode" << std::endl;
+
+    // Test 9: Resample policy plays a reproducible legal move
+    std::cout << "\n9. Testing try_step with the resample policy..." << std::endl;
+    auto resampled_actions = [&](uint64_t seed) {
+        BatchedEnvironment env(16, 3, reward_fn);
+        env.set_invalid_action_policy(InvalidActionPolicy::Resample, -1.0f, seed);
+        env.reset();
+        std::vector<int32_t> first(16, 4);
+        env.try_step(first.data());
+        std::vector<int32_t> invalid(16, 4);
+        assert(env.try_step(invalid.data()) == 16);
+        std::vector<int32_t> chosen(env.get_actions(), env.get_actions() + 16);
+        for (int i = 0; i < 16; ++i) {
+            assert(env.get_statuses()[i] == static_cast<uint8_t>(StepStatus::Occupied));
+            assert(chosen[i] != 4 && chosen[i] >= 0 && chosen[i] < 9);
+            assert(env.get_boards()[i * 9 + chosen[i]] == -1);
+            assert(env.get_env(i).get_current_player() == 1);
+        }
+        return chosen;
+    };
+    std::vector<int32_t> draw_a = resampled_actions(7);
+    assert(draw_a == resampled_actions(7));
+    bool varied = false;
+    for (int i = 1; i < 16; ++i) varied |= draw_a[i] != draw_a[0];
+    assert(varied);
+    {
+        // A full board with no result (only reachable through a snapshot) has nothing to
+        // resample, so the action is rejected
+        BatchedEnvironment full(1, 3, reward_fn);
+        full.reset();
+        full.set_invalid_action_policy(InvalidActionPolicy::Resample, -1.0f, 2);
+        std::vector<uint8_t> snapshot = full.save_snapshot();
+        const int8_t drawn[9] = {1, -1, 1, 1, -1, -1, -1, 1, 1};
+        std::memcpy(snapshot.data() + 64 + Environment::kSnapshotHeaderBytes, drawn, 9);
+        full.load_snapshot(snapshot.data(), snapshot.size());
+        int32_t taken = 4;
+        assert(full.try_step(&taken) == 1);
+        assert(full.get_statuses()[0] == static_cast<uint8_t>(StepStatus::Occupied) && full.get_dones()[0] == 0);
+        assert(full.get_env(0).get_state().cells[4] == -1);
+    }
+    std::cout << "✓ Invalid actions replaced by seeded random legal moves" << std::endl;
+
+    // Test 10: Mixed board sizes step together in one padded layout
+    std::cout << "\n10. Testing mixed board sizes..." << std::endl;
+    const int M = 10;
+    const int32_t mix[6] = {3, 5, 10, 3, 5, 10};
+    MixedBatchedEnvironment curriculum(6, M, reward_fn);
+    curriculum.set_board_sizes(mix);
+    curriculum.reset();
+    std::vector<std::unique_ptr<Environment>> singles;
+    for (int i = 0; i < 6; ++i) {
+        singles.push_back(std::make_unique<Environment>(mix[i], reward_fn));
+        singles[i]->reset();
+        assert(curriculum.get_board_sizes()[i] == mix[i]);
+    }
+    const float* observations_before = curriculum.get_observations();
+    uint32_t lcg = 12345;
+    int finished = 0;
+    for (int t = 0; t < 400; ++t) {
+        std::vector<int32_t> padded(6);
+        for (int i = 0; i < 6; ++i) {
+            const int n = mix[i];
+            const uint8_t* mask = curriculum.get_action_masks() + i * M * M;
+            const uint8_t* valid = curriculum.get_cell_masks() + i * M * M;
+            for (int c = 0; c < M * M; ++c) {
+                const bool on_board = c / M < n && c % M < n;
+                assert(valid[c] == (on_board ? 1 : 0));
+                if (!on_board) {
+                    assert(mask[c] == 0);
+                    assert(curriculum.get_observations()[i * 2 * M * M + c] == 0.0f);
+                    assert(curriculum.get_observations()[i * 2 * M * M + M * M + c] == 0.0f);
+                }
+            }
+            do {
+                lcg = lcg * 1664525u + 1013904223u;
+                padded[i] = static_cast<int32_t>((lcg >> 8) % (M * M));
+            } while (!mask[padded[i]]);
+        }
+        curriculum.step(padded.data());
+        for (int i = 0; i < 6; ++i) {
+            const int n = mix[i];
+            StepResult expected = singles[i]->step(Action{(padded[i] / M) * n + padded[i] % M});
+            assert(curriculum.get_rewards()[i] == expected.reward);
+            assert(curriculum.get_dones()[i] == (expected.done ? 1 : 0));
+            for (int c = 0; c < n * n; ++c) {
+                assert(curriculum.get_boards()[i * M * M + (c / n) * M + c % n] == expected.next_state.cells[c]);
+            }
+            if (expected.done) {
+                singles[i]->reset();
+                finished++;
+            }
+            assert(curriculum.get_env(i).get_state() == singles[i]->get_state());
+        }
+    }
+    assert(curriculum.get_observations() == observations_before);
+    std::cout << "✓ Sizes 3, 5 and 10 match single environments over " << finished
+              << " episodes; padding stays masked" << std::endl;
+
+    // Test 11: Changing the mix between iterations
+    std::cout << "\n11. Testing curriculum size changes..." << std::endl;
+    MixedBatchedEnvironment schedule(2, 5, reward_fn);
+    schedule.reset();
+    const float* buffer = schedule.get_observations();
+    int32_t opening_moves[2] = {0, 0};
+    schedule.step(opening_moves);
+    const int32_t smaller[2] = {3, 4};
+    schedule.set_board_sizes(smaller);
+    assert(schedule.get_board_sizes()[0] == 5 && schedule.get_board_sizes()[1] == 5);  // mid-episode
+    // Env 0 finishes (Player 1 takes the first column after Player 2 misses) and switches to 3x3
+    std::vector<std::vector<int32_t>> column = {{1, 1}, {5, 6}, {2, 2}, {10, 11}, {3, 3}, {15, 16}, {4, 4}, {20, 21}};
+    for (const std::vector<int32_t>& moves : column) {
+        std::vector<int32_t> step_moves = moves;
+        schedule.step(step_moves.data());
+        if (schedule.get_dones()[0]) break;
+    }
+    assert(schedule.get_dones()[0] == 1 && schedule.get_outcomes()[0] == OUTCOME_PLAYER1_WIN);
+    assert(schedule.get_boards()[0] == 1 && schedule.get_boards()[4 * 5] == 1);  // terminal 5x5 board
+    assert(schedule.get_board_sizes()[0] == 3 && schedule.get_board_sizes()[1] == 5);
+    assert(schedule.get_action_masks()[3] == 0 && schedule.get_action_masks()[2] == 1);
+    schedule.reset();
+    assert(schedule.get_board_sizes()[1] == 4 && schedule.get_cell_masks()[5 * 5 + 4 * 5] == 0);
+    assert(schedule.get_observations() == buffer);
+    try {
+        int32_t off_board[2] = {3, 0};  // column 3 is padding on the 3x3 board
+        schedule.step(off_board);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    assert(schedule.get_env(1).get_state().cells[0] == 0);  // no environment was stepped
+    schedule.step(opening_moves);
+    try {
+        int32_t taken[2] = {1, 0};  // env 1 already holds cell 0
+        schedule.step(taken);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    assert(schedule.get_env(0).get_state().cells[1] == 0);  // env 0 was not stepped either
+    int32_t after_taken[2] = {1, 1};
+    schedule.step(after_taken);
+    assert(schedule.get_env(0).get_state().cells[1] == -1 && schedule.get_env(1).get_state().cells[1] == -1);
+    try {
+        const int32_t too_big[2] = {3, 6};
+        schedule.set_board_sizes(too_big);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    std::cout << "✓ New sizes applied at episode boundaries without moving the buffers" << std::endl;
+
+    // Test 12: Symmetry augmentation while writing observations
+    std::cout << "\n12. Testing symmetry augmentation..." << std::endl;
+    auto augmented_run = [&](uint64_t seed, std::vector<uint8_t>& drawn) {
+        BatchedEnvironment env(8, 4, reward_fn);
+        env.set_symmetry_augmentation(true, seed);
+        env.reset();
+        std::vector<float> policy(8 * 16);
+        std::vector<float> target(8 * 16);
+        std::vector<float> restored(8 * 16);
+        std::vector<int32_t> chosen(8);
+        std::vector<int32_t> applied(8);
+        uint32_t state = 99;
+        for (int t = 0; t < 60; ++t) {
+            for (int i = 0; i < 8; ++i) {
+                const int sym = env.get_symmetries()[i];
+                drawn.push_back(static_cast<uint8_t>(sym));
+                std::vector<float> plain = env.get_env(i).get_one_hot_state();
+                std::vector<bool> plain_mask = env.get_env(i).get_action_mask();
+                for (int c = 0; c < 16; ++c) {
+                    const int d = transform_cell(4, sym, c);
+                    assert(env.get_observations()[i * 32 + d] == plain[c]);
+                    assert(env.get_observations()[i * 32 + 16 + d] == plain[16 + c]);
+                    assert(env.get_action_masks()[i * 16 + d] == (plain_mask[c] ? 1 : 0));
+                    policy[i * 16 + c] = static_cast<float>(i * 16 + c);
+                }
+                // Pick a legal cell on the augmented mask
+                const uint8_t* mask = env.get_action_masks() + i * 16;
+                do {
+                    state = state * 1664525u + 1013904223u;
+                    chosen[i] = static_cast<int32_t>((state >> 8) % 16);
+                } while (!mask[chosen[i]]);
+            }
+            env.transform_policies(policy.data(), target.data());
+            env.inverse_transform_policies(target.data(), restored.data());
+            assert(restored == policy);
+            for (int i = 0; i < 8; ++i) {
+                const int sym = env.get_symmetries()[i];
+                for (int c = 0; c < 16; ++c) assert(target[i * 16 + transform_cell(4, sym, c)] == policy[i * 16 + c]);
+            }
+            env.inverse_transform_actions(chosen.data(), applied.data());
+            for (int i = 0; i < 8; ++i) {
+                assert(transform_cell(4, env.get_symmetries()[i], applied[i]) == chosen[i]);
+            }
+            env.step(applied.data());  // legal in every environment's own frame
+        }
+        env.set_symmetry_augmentation(false);
+        env.reset();
+        for (int i = 0; i < 8; ++i) assert(env.get_symmetries()[i] == 0);
+    };
+    std::vector<uint8_t> drawn_a, drawn_b;
+    augmented_run(5, drawn_a);
+    augmented_run(5, drawn_b);
+    assert(drawn_a == drawn_b);
+    std::vector<int> symmetry_counts(kNumSymmetries, 0);
+    for (uint8_t t : drawn_a) symmetry_counts[t]++;
+    for (int t = 0; t < kNumSymmetries; ++t) assert(symmetry_counts[t] > 0);
+    std::cout << "✓ Observations and masks match transformed boards; policies and actions map back exactly" << std::endl;
+
+    // Test 13: Checkpoint and restore
+    std::cout << "\n13. Testing checkpoint and restore..." << std::endl;
+    {
+        // Environment snapshots carry the player to move and the move history
+        Environment single(3, reward_fn);
+        single.reset();
+        single.step(Action{4});
+        single.step(Action{0});
+        single.step(Action{8});
+        std::vector<uint8_t> bytes(single.snapshot_size());
+        assert(bytes.size() == Environment::kSnapshotHeaderBytes + 9);
+        single.write_snapshot(bytes.data());
+        Environment copy(3, reward_fn);
+        copy.read_snapshot(bytes.data());
+        assert(copy.get_state() == single.get_state() && copy.get_current_player() == -1);
+        assert(copy.get_move_count() == 3 && copy.get_recent_move(0) == 8 && copy.get_recent_move(2) == 4);
+
+        // All buffers of a batch, for comparing runs step by step
+        auto capture = [](const BatchedEnvironment& b) {
+            const size_t B = b.get_num_envs();
+            const size_t cells = static_cast<size_t>(b.get_board_size()) * b.get_board_size();
+            std::vector<uint8_t> out;
+            auto add = [&out](const void* p, size_t bytes) {
+                const uint8_t* u = static_cast<const uint8_t*>(p);
+                out.insert(out.end(), u, u + bytes);
+            };
+            add(b.get_observations(), B * 2 * cells * sizeof(float));
+            add(b.get_action_masks(), B * cells);
+            add(b.get_rewards(), B * sizeof(float));
+            add(b.get_dones(), B);
+            add(b.get_boards(), B * cells);
+            add(b.get_actions(), B * sizeof(int32_t));
+            add(b.get_outcomes(), B);
+            add(b.get_statuses(), B);
+            add(b.get_symmetries(), B);
+            add(b.get_features(), B * b.get_num_feature_planes() * cells * sizeof(float));
+            return out;
+        };
+        // try_step with some occupied and out-of-range cells, from a fixed stream
+        uint32_t state = 99;
+        auto next_actions = [&state](std::vector<int32_t>& actions) {
+            for (int32_t& a : actions) {
+                state = state * 1664525u + 1013904223u;
+                a = static_cast<int32_t>((state >> 8) % 18);
+            }
+        };
+
+        const int B = 16;
+        BatchedEnvironment original(B, 4, reward_fn);
+        original.set_symmetry_augmentation(true, 3);
+        original.set_invalid_action_policy(InvalidActionPolicy::Resample, -1.0f, 9);
+        FeatureConfig config;
+        config.history = 3;
+        original.set_feature_config(config);
+        original.reset();
+        std::vector<int32_t> actions(B);
+        for (int t = 0; t < 10; ++t) {
+            next_actions(actions);
+            original.try_step(actions.data());
+        }
+        const std::vector<uint8_t> snapshot = original.save_snapshot();
+        const std::string path = "test_batched_checkpoint.bin";
+        original.save_checkpoint(path);
+        const std::vector<uint8_t> at_snapshot = capture(original);
+        const uint32_t stream_at_snapshot = state;
+
+        std::vector<std::vector<uint8_t>> expected;
+        for (int t = 0; t < 20; ++t) {
+            next_actions(actions);
+            original.try_step(actions.data());
+            expected.push_back(capture(original));
+        }
+
+        // A fresh batch with default settings picks everything up from the file
+        BatchedEnvironment resumed(B, 4, reward_fn);
+        resumed.reset();
+        const float* observations = resumed.get_observations();
+        auto start = std::chrono::steady_clock::now();
+        resumed.load_checkpoint(path);
+        const double load_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        assert(resumed.get_observations() == observations);
+        assert(resumed.get_symmetry_augmentation());
+        assert(resumed.get_invalid_action_policy() == InvalidActionPolicy::Resample);
+        assert(resumed.get_num_feature_planes() == original.get_num_feature_planes());
+        assert(capture(resumed) == at_snapshot);
+        state = stream_at_snapshot;
+        for (int t = 0; t < 20; ++t) {
+            next_actions(actions);
+            resumed.try_step(actions.data());
+            assert(capture(resumed) == expected[t]);
+        }
+        // In-memory snapshots are the same bytes
+        BatchedEnvironment from_memory(B, 4, reward_fn);
+        from_memory.load_snapshot(snapshot.data(), snapshot.size());
+        assert(from_memory.save_snapshot() == snapshot);
+        std::cout << "  " << snapshot.size() << " bytes for " << B << " 4x4 environments, loaded in " << load_ms
+                  << " ms" << std::endl;
+
+        // Mismatched and damaged snapshots are rejected and leave the batch unchanged
+        const std::vector<uint8_t> before = capture(resumed);
+        try {
+            BatchedEnvironment other(B + 1, 4, reward_fn);
+            other.load_snapshot(snapshot.data(), snapshot.size());
+            assert(false);
+        } catch (const std::invalid_argument& e) {
+            std::cout << "Caught expected exception: " << e.what() << std::endl;
+        }
+        std::vector<uint8_t> damaged = snapshot;
+        damaged[64 + 5 * (Environment::kSnapshotHeaderBytes + 16) + Environment::kSnapshotHeaderBytes + 7] = 5;  // a cell of env 5
+        try {
+            resumed.load_snapshot(damaged.data(), damaged.size());
+            assert(false);
+        } catch (const std::runtime_error& e) {
+            std::cout << "Caught expected exception: " << e.what() << std::endl;
+        }
+        try {
+            resumed.load_snapshot(snapshot.data(), snapshot.size() - 1);
+            assert(false);
+        } catch (const std::runtime_error& e) {
+            std::cout << "Caught expected exception: " << e.what() << std::endl;
+        }
+        assert(capture(resumed) == before);
+        std::remove(path.c_str());
+        try {
+            resumed.load_checkpoint(path);
+            assert(false);
+        } catch (const std::runtime_error& e) {
+            std::cout << "Caught expected exception: " << e.what() << std::endl;
+        }
+    }
+    std::cout << "✓ A restored batch continues bit-identically; bad snapshots are rejected" << std::endl;
+
+    std::cout << "\n=== ALL BATCHED ENVIRONMENT TESTS PASSED! ===" << std::endl;
+    return 0;
+}
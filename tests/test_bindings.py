@@ -0,0 +1,115 @@
+"""Smoke test for the pybind11 module (src/bindings.cpp).
+
+Run from the build directory, where the tictactoe_env module is built:
+    PYTHONPATH=. python3 ../tests/test_bindings.py
+"""
+
+import numpy as np
+
+import tictactoe_env
+
+
+def main():
+    print("=== Testing Python Bindings ===")
+
+    # Test 1: reset/step return views on the C++ buffers
+    print("\n1. Testing reset and step views...")
+    B, N = 4, 3
+    env = tictactoe_env.BatchedEnvironment(num_envs=B, N=N)
+    obs, masks = env.reset()
+    assert obs.shape == (B, 2, N, N) and obs.dtype == np.float32
+    assert masks.shape == (B, N * N) and masks.dtype == np.uint8
+    assert obs is env.observations and masks is env.action_masks
+    assert not obs.flags.writeable
+    assert masks.all() and not obs.any()
+
+    # Player 1 takes the top row in env 0; env 1..3 keep playing
+    script = [[0, 8, 8, 8], [3, 0, 0, 0], [1, 7, 7, 7], [4, 6, 6, 6], [2, 2, 2, 2]]
+    for t, row in enumerate(script):
+        obs, masks, rewards, dones = env.step(np.array(row, dtype=np.int32))
+        assert obs is env.observations and rewards is env.rewards and dones is env.dones
+        if t < len(script) - 1:
+            assert not dones.any()
+    assert list(dones) == [1, 0, 0, 0] and env.outcomes[0] == 1
+    assert list(env.boards[0].ravel()) == [1, 1, 1, -1, -1, 0, 0, 0, 0]
+    assert masks[0].all()  # env 0 was reset for its next game
+    assert env.boards[1, 2, 2] == 1 and env.boards[1, 0, 0] == -1
+    print("✓ Views track the C++ buffers and finished games reset")
+
+    # Test 2: step raises on an invalid action without moving any environment
+    print("\n2. Testing invalid actions...")
+    before = env.boards.copy()
+    try:
+        env.step(np.array([0, 8, 5, 5], dtype=np.int32))  # cell 8 is taken in env 1
+        assert False
+    except ValueError as e:
+        print("Caught expected exception:", e)
+    obs, masks, rewards, dones = env.step(np.array([5, 5, 5, 5], dtype=np.int32))
+    assert env.boards[2, 1, 2] == -1 and before[2, 1, 2] == 0
+    try:
+        env.step(np.zeros(B + 1, dtype=np.int32))
+        assert False
+    except ValueError as e:
+        print("Caught expected exception:", e)
+
+    env.set_invalid_action_policy("reject")
+    occupied = int(np.flatnonzero(env.boards[3].ravel())[0])
+    obs, masks, rewards, dones, statuses = env.try_step(np.array([4, 1, 99, occupied], dtype=np.int32))
+    assert statuses is env.statuses
+    assert list(statuses) == [0, 0, 1, 2]
+    assert rewards[2] == 0.0 and dones[2] == 0 and dones[3] == 0
+    print("✓ step raises and try_step reports statuses")
+
+    # Test 3: a Python reward function sees the batch after each step
+    print("\n3. Testing the batch reward hook...")
+    calls = []
+
+    def reward_fn(boards, actions, outcomes):
+        calls.append((boards.shape, actions.copy(), outcomes.copy()))
+        return actions.astype(np.float32) * 0.5
+
+    hooked = tictactoe_env.BatchedEnvironment(num_envs=2, N=3)
+    hooked.reset()
+    hooked.set_reward_fn(reward_fn)
+    _, _, rewards, _ = hooked.step(np.array([4, 6], dtype=np.int32))
+    assert len(calls) == 1 and calls[0][0] == (2, 3, 3)
+    assert list(calls[0][1]) == [4, 6]
+    assert list(rewards) == [2.0, 3.0]
+
+    hooked.set_reward_fn(lambda boards, actions, outcomes: np.zeros(3, dtype=np.float32))
+    try:
+        hooked.step(np.array([0, 0], dtype=np.int32))
+        assert False
+    except ValueError as e:
+        print("Caught expected exception:", e)
+    hooked.set_reward_fn(None)
+    hooked.step(np.array([1, 1], dtype=np.int32))
+    print("✓ Rewards come from the hook; a bad return value raises")
+
+    # Test 4: snapshots round-trip
+    print("\n4. Testing snapshot round-trips...")
+    snapshot = env.save_snapshot()
+    assert isinstance(snapshot, bytes)
+    saved_boards = env.boards.copy()
+    saved_obs = env.observations.copy()
+    follow_up = np.array([int(np.flatnonzero(env.action_masks[i])[0]) for i in range(B)], dtype=np.int32)
+    env.step(follow_up)
+    first = (env.boards.copy(), env.rewards.copy(), env.dones.copy())
+    env.load_snapshot(snapshot)
+    assert (env.boards == saved_boards).all() and (env.observations == saved_obs).all()
+    env.step(follow_up)
+    assert (env.boards == first[0]).all() and (env.rewards == first[1]).all() and (env.dones == first[2]).all()
+
+    other = tictactoe_env.BatchedEnvironment(num_envs=B + 1, N=N)
+    try:
+        other.load_snapshot(snapshot)
+        assert False
+    except ValueError as e:
+        print("Caught expected exception:", e)
+    print("✓ A restored batch continues identically; mismatched snapshots raise")
+
+    print("\n=== ALL PYTHON BINDING TESTS PASSED! ===")
+
+
+if __name__ == "__main__":
+    main()
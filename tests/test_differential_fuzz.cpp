@@ -0,0 +1,245 @@
+#include <iostream>
+#include "../include/environment.h"
+#include "../include/differential_fuzz.h"
+#include <cassert>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+// Engines with planted bugs, to check that the harness finds and shrinks them
+enum class Bug {
+    AntiDiagonal,         // anti-diagonal wins are not reported as done
+    SecondEpisodeReward,  // rewards are negated in a slot's second game
+    ThrowInThirdEpisode   // throws when the 4th move of a slot's third game is cell 8
+};
+
+bool line_complete(const std::vector<int>& cells, int start, int stride, int N, int player) {
+    for (int k = 0; k < N; ++k) {
+        if (cells[start + k * stride] != player) return false;
+    }
+    return true;
+}
+
+// True if the winner's only complete line is the anti-diagonal
+bool only_anti_diagonal(const Environment& env) {
+    const std::vector<int>& cells = env.get_state().cells;
+    const int N = env.get_state().N;
+    const int w = env.get_winner();
+    if (w == 0 || !line_complete(cells, N - 1, N - 1, N, w)) return false;
+    for (int k = 0; k < N; ++k) {
+        if (line_complete(cells, k * N, 1, N, w) || line_complete(cells, k, N, N, w)) return false;
+    }
+    return !line_complete(cells, 0, N + 1, N, w);
+}
+
+class BuggyEngine : public FuzzEngine {
+public:
+    BuggyEngine(int num_games, int N, std::shared_ptr<RewardCallback> reward_fn, Bug bug)
+        : N(N), bug(bug), board_buf(num_games * N * N), done_buf(num_games), reward_buf(num_games),
+          mask_buf(num_games * N * N), episodes(num_games), moves(num_games) {
+        for (int i = 0; i < num_games; ++i) envs.emplace_back(N, reward_fn);
+    }
+
+    void reset() override {
+        for (size_t i = 0; i < envs.size(); ++i) {
+            envs[i].reset_in_place();
+            envs[i].write_action_mask(mask_buf.data() + i * N * N);
+        }
+        std::fill(board_buf.begin(), board_buf.end(), 0);
+        std::fill(done_buf.begin(), done_buf.end(), 0);
+        std::fill(reward_buf.begin(), reward_buf.end(), 0.0f);
+        std::fill(episodes.begin(), episodes.end(), 0);
+        std::fill(moves.begin(), moves.end(), 0);
+    }
+
+    void step(const int32_t* actions) override {
+        for (size_t i = 0; i < envs.size(); ++i) {
+            if (bug == Bug::ThrowInThirdEpisode && episodes[i] == 2 && moves[i] == 3 && actions[i] == 8) {
+                throw std::runtime_error("corner move rejected");
+            }
+            float reward;
+            bool done;
+            envs[i].step_in_place(Action{actions[i]}, reward, done);
+            moves[i]++;
+            if (bug == Bug::AntiDiagonal && done && only_anti_diagonal(envs[i])) done = false;
+            if (bug == Bug::SecondEpisodeReward && episodes[i] == 1) reward = -reward;
+            const std::vector<int>& cells = envs[i].get_state().cells;
+            for (int c = 0; c < N * N; ++c) board_buf[i * N * N + c] = static_cast<int8_t>(cells[c]);
+            done_buf[i] = done ? 1 : 0;
+            reward_buf[i] = reward;
+            if (done) {
+                envs[i].reset_in_place();
+                episodes[i]++;
+                moves[i] = 0;
+            }
+            envs[i].write_action_mask(mask_buf.data() + i * N * N);
+        }
+    }
+
+    const int8_t* boards() const override { return board_buf.data(); }
+    const uint8_t* dones() const override { return done_buf.data(); }
+    const float* rewards() const override { return reward_buf.data(); }
+    const uint8_t* masks() const override { return mask_buf.data(); }
+
+private:
+    int N;
+    Bug bug;
+    std::vector<Environment> envs;
+    std::vector<int8_t> board_buf;
+    std::vector<uint8_t> done_buf;
+    std::vector<float> reward_buf;
+    std::vector<uint8_t> mask_buf;
+    std::vector<int> episodes;
+    std::vector<int> moves;
+};
+
+FuzzTarget buggy_target(Bug bug) {
+    return {"BuggyEngine", [bug](int num_games, int N, std::shared_ptr<RewardCallback> reward_fn)
+                               -> std::unique_ptr<FuzzEngine> {
+                return std::make_unique<BuggyEngine>(num_games, N, std::move(reward_fn), bug);
+            }};
+}
+
+// Number of games the reference finishes along a replayed sequence
+int count_games(int N, const std::vector<int32_t>& actions) {
+    auto reference = make_reference_engine(1, N, std::make_shared<FuzzReward>());
+    reference->reset();
+    int games = 0;
+    for (int32_t a : actions) {
+        reference->step(&a);
+        games += reference->dones()[0];
+    }
+    return games;
+}
+
+int main() {
+    std::cout << "=== Testing Differential Fuzzing ===" << std::endl;
+
+    // Test 1: Every built-in engine agrees with the reference
+    std::cout << "\n1. Testing the built-in engines..." << std::endl;
+    {
+        DiffFuzzConfig config;
+        config.board_sizes = {3, 4, 5};
+        config.num_games = 128;
+        config.steps_per_round = 200;
+        config.rounds = 3;
+        config.seed = 1;
+        DifferentialFuzzer fuzzer(config);
+        fuzzer.add_builtin_targets();
+        assert(fuzzer.get_num_targets() == static_cast<int>(builtin_fuzz_targets().size()));
+        DiffFuzzReport report = fuzzer.run();
+        for (const Divergence& d : report.divergences) std::cout << d.describe() << std::endl;
+        assert(report.divergences.empty());
+        assert(report.steps == static_cast<uint64_t>(fuzzer.get_num_targets()) * 128 * 200 * 3);
+        assert(report.games > 0);
+        std::cout << "✓ " << fuzzer.get_num_targets() << " engines matched the reference over " << report.games
+                  << " games (" << report.steps_per_second() / 1e6 << "M compared steps/s)" << std::endl;
+    }
+
+    // Test 2: A missed win is found and shrunk to one short game
+    std::cout << "\n2. Testing a missed anti-diagonal win..." << std::endl;
+    {
+        DiffFuzzConfig config;
+        config.board_sizes = {3};
+        config.num_games = 64;
+        config.steps_per_round = 100;
+        config.rounds = 2;
+        DifferentialFuzzer fuzzer(config);
+        fuzzer.add_target(buggy_target(Bug::AntiDiagonal));
+        DiffFuzzReport report = fuzzer.run();
+        assert(report.divergences.size() == 1);
+        const Divergence& d = report.divergences[0];
+        std::cout << d.describe() << std::endl;
+        assert(d.field == "done" && d.expected == "1" && d.actual == "0");
+        assert(d.actions.size() >= 5 && static_cast<int>(d.actions.size()) <= d.original_length);
+        const int last = d.actions.back();
+        assert(last == 2 || last == 4 || last == 6);
+        assert(count_games(3, d.actions) == 1);  // only the diverging game is left
+        std::optional<Divergence> again = fuzzer.replay(buggy_target(Bug::AntiDiagonal), 3, d.actions);
+        assert(again && again->field == "done" && again->actions == d.actions);
+
+        // A won game in front of the diverging one is cut away
+        std::vector<int32_t> padded = {0, 3, 1, 4, 2, 4, 0, 2, 1, 6};
+        std::optional<Divergence> long_form = fuzzer.replay(buggy_target(Bug::AntiDiagonal), 3, padded);
+        assert(long_form && long_form->actions.size() == 10);
+        Divergence shrunk = fuzzer.minimize(buggy_target(Bug::AntiDiagonal), *long_form);
+        std::cout << shrunk.describe() << std::endl;
+        assert((shrunk.actions == std::vector<int32_t>{4, 0, 2, 1, 6}) && shrunk.original_length == 10);
+    }
+    std::cout << "✓ Divergence reproduced by the minimized sequence" << std::endl;
+
+    // Test 3: Bugs that need earlier games keep them
+    std::cout << "\n3. Testing a divergence spanning episodes..." << std::endl;
+    {
+        DiffFuzzConfig config;
+        config.board_sizes = {3};
+        config.num_games = 32;
+        config.steps_per_round = 64;
+        config.rounds = 1;
+        DifferentialFuzzer fuzzer(config);
+        fuzzer.add_target(buggy_target(Bug::SecondEpisodeReward));
+        DiffFuzzReport report = fuzzer.run();
+        assert(report.divergences.size() == 1);
+        const Divergence& d = report.divergences[0];
+        std::cout << d.describe() << std::endl;
+        assert(d.field == "reward");
+        assert(count_games(3, d.actions) == 1 && d.actions.size() >= 6);
+    }
+    std::cout << "✓ The earlier game is kept, shrunk alongside the diverging move" << std::endl;
+
+    // Test 4: Exceptions are traced back to their game
+    std::cout << "\n4. Testing engine exceptions..." << std::endl;
+    {
+        DiffFuzzConfig config;
+        config.board_sizes = {3};
+        config.num_games = 64;
+        config.steps_per_round = 100;
+        config.rounds = 1;
+        DifferentialFuzzer fuzzer(config);
+        fuzzer.add_target(buggy_target(Bug::ThrowInThirdEpisode));
+        fuzzer.add_builtin_targets();
+        DiffFuzzReport report = fuzzer.run();
+        assert(report.divergences.size() == 1);
+        const Divergence& d = report.divergences[0];
+        std::cout << d.describe() << std::endl;
+        assert(d.engine == "BuggyEngine" && d.field == "exception" && d.actual == "corner move rejected");
+        assert(d.actions.back() == 8 && count_games(3, d.actions) == 2);
+        assert(static_cast<int>(d.actions.size()) <= d.original_length);
+        // The other engines kept running
+        assert(report.steps > static_cast<uint64_t>(builtin_fuzz_targets().size()) * 64 * 99);
+    }
+    std::cout << "✓ The throwing game is found and minimized; the other engines keep running" << std::endl;
+
+    // Test 5: Invalid input
+    std::cout << "\n5. Testing invalid input..." << std::endl;
+    {
+        DifferentialFuzzer fuzzer;
+        try {
+            fuzzer.replay(builtin_fuzz_targets()[0], 3, {4, 4});
+            assert(false);
+        } catch (const std::invalid_argument& e) {
+            std::cout << "Caught expected exception: " << e.what() << std::endl;
+        }
+        assert(!fuzzer.replay(builtin_fuzz_targets()[0], 3, {4, 0, 8, 2, 6}));
+    }
+    try {
+        DiffFuzzConfig config;
+        config.board_sizes = {};
+        DifferentialFuzzer fuzzer(config);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    try {
+        DiffFuzzConfig config;
+        config.num_games = 0;
+        DifferentialFuzzer fuzzer(config);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    std::cout << "✓ Illegal replays and invalid configurations rejected" << std::endl;
+
+    std::cout << "\n=== ALL DIFFERENTIAL FUZZING TESTS PASSED! ===" << std::endl;
+    return 0;
+}
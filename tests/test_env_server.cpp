@@ -0,0 +1,222 @@
+#include <iostream>
+#include "../include/environment.h"
+#include "../include/batched_environment.h"
+#include "../include/env_server.h"
+#include <memory>
+#include <cassert>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Client-side check: drives a channel with a fixed move schedule and compares every
+// response with a local BatchedEnvironment. Returns 0 on success.
+int run_client(const std::string& name, int channel, int B, int N, int steps) {
+    EnvClient client(name, channel);
+    if (client.get_num_envs() != B || client.get_board_size() != N) return 1;
+
+    BatchedEnvironment local(B, N, std::make_shared<DefaultReward>());
+    local.reset();
+    EnvStepView view = client.reset();
+    if (std::memcmp(view.observations, local.get_observations(), B * 2 * N * N * sizeof(float)) != 0) return 2;
+
+    std::vector<int32_t> actions(B);
+    for (int t = 0; t < steps; ++t) {
+        // First legal cell after an offset that depends on env, step and channel
+        for (int i = 0; i < B; ++i) {
+            const uint8_t* mask = local.get_action_masks() + i * N * N;
+            int start = (i * 7 + t * 5 + channel) % (N * N);
+            for (int k = 0; k < N * N; ++k) {
+                int cell = (start + k) % (N * N);
+                if (mask[cell]) { actions[i] = cell; break; }
+            }
+        }
+        local.step(actions.data());
+        view = client.step(actions.data());
+        if (std::memcmp(view.observations, local.get_observations(), B * 2 * N * N * sizeof(float)) != 0) return 3;
+        if (std::memcmp(view.action_masks, local.get_action_masks(), B * N * N) != 0) return 4;
+        if (std::memcmp(view.rewards, local.get_rewards(), B * sizeof(float)) != 0) return 5;
+        if (std::memcmp(view.dones, local.get_dones(), B) != 0) return 6;
+    }
+    return 0;
+}
+
+int main() {
+    std::cout << "=== Testing Shared-Memory Environment Server ===" << std::endl;
+    const std::string name = "tictactoe_test_env_server_" + std::to_string(getpid());
+    const int channels = 2, B = 8, N = 3;
+
+    // Test 1: Two client processes step their channels against one server process
+    std::cout << "\n1. Testing multi-process clients..." << std::endl;
+    {
+        EnvServer server(name, channels, B, N, 2);
+        // Fork before starting any thread in this process
+        std::vector<pid_t> children;
+        for (int c = 0; c < channels; ++c) {
+            pid_t pid = fork();
+            assert(pid >= 0);
+            if (pid == 0) {
+                _exit(run_client(name, c, B, N, 200));
+            }
+            children.push_back(pid);
+        }
+        std::thread server_thread([&server] { server.serve(); });
+        for (pid_t pid : children) {
+            int status = 0;
+            waitpid(pid, &status, 0);
+            assert(WIFEXITED(status));
+            std::cout << "Client exit code: " << WEXITSTATUS(status) << std::endl;
+            assert(WEXITSTATUS(status) == 0);
+        }
+        server.stop();
+        server_thread.join();
+    }
+    std::cout << "✓ Every response matched a local BatchedEnvironment" << std::endl;
+
+    // Test 2: Pipelined requests fill the ring before waiting
+    std::cout << "\n2. Testing pipelined requests..." << std::endl;
+    {
+        EnvServer server(name, 1, 2, 3, 3);
+        std::thread server_thread([&server] { server.serve(); });
+        EnvClient client(name, 0);
+        client.reset();
+        int32_t a0[2] = {0, 8};
+        int32_t a1[2] = {1, 7};
+        int32_t a2[2] = {2, 6};
+        uint32_t t0 = client.submit_step(a0);
+        uint32_t t1 = client.submit_step(a1);
+        uint32_t t2 = client.submit_step(a2);
+        EnvStepView v0 = client.wait(t0);
+        EnvStepView v2 = client.wait(t2);
+        client.wait(t1);
+        assert(v0.action_masks[0] == 0 && v0.action_masks[1] == 1);  // after first step
+        assert(v2.action_masks[0] == 0 && v2.action_masks[1] == 0 && v2.action_masks[2] == 0);
+        assert(v2.dones[0] == 0);
+
+        // A rejected request fails only its own wait(), even once its slot is reused
+        client.reset();
+        int32_t bad[2] = {0, 9};
+        int32_t opening[2] = {4, 4};
+        uint32_t rejected = client.submit_step(bad);
+        uint32_t next = client.submit_step(opening);
+        try {
+            client.wait(rejected);
+            assert(false);
+        } catch (const std::invalid_argument& e) {
+            std::cout << "Caught expected exception: " << e.what() << std::endl;
+        }
+        client.wait(next);
+        int32_t taken[2] = {4, 4};
+        int32_t moves[3][2] = {{0, 0}, {8, 8}, {1, 1}};
+        client.submit_step(taken);
+        for (const auto& row : moves) next = client.submit_step(row);  // the last one reuses taken's slot
+        EnvStepView last = client.wait(next);
+        for (int i = 0; i < 2; ++i) {
+            const uint8_t* mask = last.action_masks + i * 9;
+            assert(mask[0] == 0 && mask[1] == 0 && mask[4] == 0 && mask[8] == 0 && mask[2] == 1);
+        }
+        server.stop();
+        server_thread.join();
+    }
+    std::cout << "✓ Results of in-flight requests stay in their own slots" << std::endl;
+
+    // Test 3: Errors are reported to the client, not fatal to the server
+    std::cout << "\n3. Testing error handling..." << std::endl;
+    {
+        EnvServer server(name, 1, 1, 3, 2);
+        std::thread server_thread([&server] { server.serve(); });
+        EnvClient client(name, 0);
+        try {
+            EnvClient second(name, 0);
+            assert(false);
+        } catch (const std::runtime_error& e) {
+            std::cout << "Caught expected exception: " << e.what() << std::endl;
+        }
+        try {
+            EnvServer second(name, 1, 1, 3, 2);
+            assert(false);
+        } catch (const std::runtime_error& e) {
+            std::cout << "Caught expected exception: " << e.what() << std::endl;
+        }
+        client.reset();
+        int32_t bad = 9;
+        try {
+            client.step(&bad);
+            assert(false);
+        } catch (const std::invalid_argument& e) {
+            std::cout << "Caught expected exception: " << e.what() << std::endl;
+        }
+        int32_t good = 4;
+        EnvStepView view = client.step(&good);
+        assert(view.action_masks[4] == 0);
+        server.stop();
+        server_thread.join();
+    }
+    {
+        // An invalid action in the middle of a row rejects the whole request; the channel
+        // then keeps stepping exactly like an untouched batch
+        EnvServer server(name, 1, 4, 3, 2);
+        std::thread server_thread([&server] { server.serve(); });
+        EnvClient client(name, 0);
+        BatchedEnvironment reference(4, 3, std::make_shared<DefaultReward>());
+        client.reset();
+        reference.reset();
+        const int32_t opening[4] = {0, 1, 2, 3};
+        client.step(opening);
+        reference.step(opening);
+        const int32_t bad[4] = {4, 4, 2, 4};  // env 2 plays its occupied cell
+        try {
+            client.step(bad);
+            assert(false);
+        } catch (const std::invalid_argument& e) {
+            std::cout << "Caught expected exception: " << e.what() << std::endl;
+        }
+        const int32_t moves[3][4] = {{4, 4, 4, 4}, {8, 8, 8, 0}, {3, 0, 0, 8}};
+        for (const auto& row : moves) {
+            EnvStepView view = client.step(row);
+            reference.step(row);
+            assert(std::memcmp(view.observations, reference.get_observations(), 4 * 2 * 9 * sizeof(float)) == 0);
+            assert(std::memcmp(view.action_masks, reference.get_action_masks(), 4 * 9) == 0);
+            assert(std::memcmp(view.dones, reference.get_dones(), 4) == 0);
+        }
+        server.stop();
+        server_thread.join();
+    }
+    try {
+        EnvClient orphan(name, 0);
+        assert(false);
+    } catch (const std::runtime_error& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    {
+        // A server that dies without its destructor leaves the segment behind; only an
+        // explicit force replaces it
+        pid_t pid = fork();
+        assert(pid >= 0);
+        if (pid == 0) {
+            new EnvServer(name, 1, 1, 3, 2);
+            _exit(0);
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        try {
+            EnvServer server(name, 1, 1, 3, 2);
+            assert(false);
+        } catch (const std::runtime_error& e) {
+            std::cout << "Caught expected exception: " << e.what() << std::endl;
+        }
+        EnvServer server(name, 1, 1, 3, 2, true);
+        std::thread server_thread([&server] { server.serve(); });
+        EnvClient client(name, 0);
+        EnvStepView view = client.reset();
+        assert(view.action_masks[0] == 1);
+        server.stop();
+        server_thread.join();
+    }
+    std::cout << "✓ Invalid actions, busy/missing channels and taken segment names reported" << std::endl;
+
+    std::cout << "\n=== ALL ENVIRONMENT SERVER TESTS PASSED! ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,321 @@
+#include <iostream>
+#include "../include/environment.h"
+#include "../include/batched_environment.h"
+#include "../include/arena.h"
+#include "../include/episode.h"
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// Reward that encodes the action, so recorded rewards can be traced back to moves
+class ActionReward : public RewardCallback {
+public:
+    float operator()(const BoardState&, const Action& action) override {
+        return 0.5f * action.index;
+    }
+};
+
+int main() {
+    std::cout << "=== Testing Episode Recorder ===" << std::endl;
+
+    // Test 1: Arena
+    std::cout << "\n1. Testing bump-pointer arena..." << std::endl;
+    Arena arena(256);
+    char* c = arena.allocate_array<char>(3);
+    double* d = arena.allocate_array<double>(4);
+    void* aligned = arena.allocate(10, 64);
+    assert(reinterpret_cast<uintptr_t>(d) % alignof(double) == 0);
+    assert(reinterpret_cast<uintptr_t>(aligned) % 64 == 0);
+    assert(reinterpret_cast<char*>(d) > c);
+    void* big = arena.allocate(1000);  // larger than a block
+    std::memset(big, 0xAB, 1000);
+    assert(arena.bytes_used() == 3 + 32 + 10 + 1000);
+    const size_t reserved = arena.bytes_reserved();
+    arena.reset();
+    assert(arena.bytes_used() == 0);
+    assert(arena.allocate_array<char>(3) == c);  // the first block is reused
+    arena.allocate(1000);
+    assert(arena.bytes_reserved() == reserved);
+    std::cout << "✓ Aligned bump allocation; reset reuses blocks" << std::endl;
+
+    // Test 2: Recorded episodes replay to the environment's boards
+    std::cout << "\n2. Testing lazy replay against a batched environment..." << std::endl;
+    const int B = 8;
+    const int N = 4;
+    BatchedEnvironment batch(B, N, std::make_shared<ActionReward>());
+    batch.reset();
+    EpisodeRecorder recorder(B, N, 1024);
+    std::vector<std::vector<std::vector<int8_t>>> boards(B);  // per env, boards of the episode in progress
+    std::vector<std::vector<std::vector<int8_t>>> finished_boards;
+    std::vector<int32_t> actions(B);
+    for (int t = 0; t < 200; ++t) {
+        for (int i = 0; i < B; ++i) {
+            const uint8_t* mask = batch.get_action_masks() + i * N * N;
+            int start = (i * 7 + t * 5) % (N * N);
+            for (int k = 0; k < N * N; ++k) {
+                if (mask[(start + k) % (N * N)]) {
+                    actions[i] = (start + k) % (N * N);
+                    break;
+                }
+            }
+        }
+        batch.step(actions.data());
+        recorder.record_batch(actions.data(), batch.get_rewards(), batch.get_dones());
+        for (int i = 0; i < B; ++i) {
+            boards[i].emplace_back(batch.get_boards() + i * N * N, batch.get_boards() + (i + 1) * N * N);
+            if (batch.get_dones()[i]) {
+                finished_boards.push_back(boards[i]);
+                boards[i].clear();
+            }
+        }
+    }
+    const std::vector<Episode>& episodes = recorder.get_episodes();
+    assert(episodes.size() == finished_boards.size() && !episodes.empty());
+    for (size_t e = 0; e < episodes.size(); ++e) {
+        const Episode& ep = episodes[e];
+        assert(ep.finished && ep.length == static_cast<int>(finished_boards[e].size()));
+        BoardState start = ep.state_at(0);
+        for (int v : start.cells) assert(v == 0);
+        for (int t = 0; t < ep.length; ++t) {
+            StepResult step = ep.step_at(t);
+            for (int k = 0; k < N * N; ++k) assert(step.next_state.cells[k] == finished_boards[e][t][k]);
+            assert(step.reward == 0.5f * ep.moves[t]);
+            assert(step.done == (t == ep.length - 1));
+        }
+    }
+    std::cout << "✓ " << episodes.size() << " episodes replay to the recorded boards" << std::endl;
+
+    // Test 3: Observation iterator and bulk writer
+    std::cout << "\n3. Testing observation iterator and bulk writer..." << std::endl;
+    for (const Episode& ep : episodes) {
+        Environment reference(N, std::make_shared<DefaultReward>());
+        reference.reset();
+        std::vector<float> bulk(static_cast<size_t>(ep.length) * 2 * N * N);
+        ep.write_observations(bulk.data());
+        for (ObservationIterator it(ep); !it.at_end(); it.next()) {
+            std::vector<float> expected = reference.get_one_hot_state();
+            std::vector<bool> mask = reference.get_action_mask();
+            for (int k = 0; k < 2 * N * N; ++k) {
+                assert(it.observation()[k] == expected[k]);
+                assert(bulk[it.step() * 2 * N * N + k] == expected[k]);
+            }
+            for (int k = 0; k < N * N; ++k) assert(it.action_mask()[k] == (mask[k] ? 1 : 0));
+            reference.step(Action{it.action()});
+        }
+    }
+    std::cout << "✓ Incremental observations match get_one_hot_state at every step" << std::endl;
+
+    // Test 4: Unfinished episodes and memory footprint
+    std::cout << "\n4. Testing flush, reset and footprint..." << std::endl;
+    const size_t completed = episodes.size();
+    int in_progress = 0;
+    for (int i = 0; i < B; ++i) in_progress += !boards[i].empty();
+    recorder.flush();
+    assert(recorder.get_episodes().size() == completed + in_progress);
+    assert(!recorder.get_episodes().back().finished);
+    recorder.reset();
+    assert(recorder.get_episodes().empty() && recorder.get_arena_bytes() == 0);
+
+    // A game cut by a batch boundary continues from its board in the next batch
+    {
+        EpisodeRecorder cut(1, 3);
+        Environment game(3, std::make_shared<DefaultReward>());
+        game.reset();
+        const int sequence[] = {0, 4, 1, 3, 2};
+        for (int k = 0; k < 5; ++k) {
+            float reward;
+            bool game_done;
+            game.step_in_place(Action{sequence[k]}, reward, game_done);
+            cut.record(0, sequence[k], reward, game_done);
+            if (k == 1) {
+                cut.flush();
+                assert(cut.get_episodes().size() == 1 && cut.get_episodes()[0].offset == 0);
+                cut.reset();
+            }
+        }
+        assert(cut.get_episodes().size() == 1);
+        const Episode& rest = cut.get_episodes()[0];
+        assert(rest.finished && rest.length == 3 && rest.offset == 2);
+        assert(rest.moves[0] == 1 && rest.history[1] == 4);
+        assert((rest.state_at(0).cells == std::vector<int>{1, 0, 0, 0, -1, 0, 0, 0, 0}));
+        assert(rest.state_at(rest.length) == game.get_state());
+        assert(rest.step_at(2).done && !rest.step_at(1).done);
+
+        std::vector<float> bulk(rest.length * 2 * 9);
+        rest.write_observations(bulk.data());
+        ObservationIterator it(rest);
+        assert(it.observation()[0] == 1.0f && it.observation()[9 + 4] == 1.0f && bulk[9 + 4] == 1.0f);
+        assert(it.action_mask()[0] == 0 && it.action_mask()[4] == 0 && it.action_mask()[1] == 1);
+
+        // clear() drops the game in progress as well
+        cut.record(0, 4, 0.0f, false);
+        cut.flush();
+        cut.clear();
+        cut.record(0, 0, 0.0f, false);
+        cut.flush();
+        assert(cut.get_episodes().size() == 1 && cut.get_episodes()[0].offset == 0);
+    }
+
+    EpisodeRecorder big_board(1, 10);
+    Environment env10(10, std::make_shared<DefaultReward>());
+    env10.reset();
+    int moves = 0;
+    bool done = false;
+    while (!done) {
+        // Fill the board row by row in a pattern that avoids early lines
+        int cell = (moves * 13) % 100;
+        while (env10.get_state().cells[cell] != 0) cell = (cell + 1) % 100;
+        float reward;
+        env10.step_in_place(Action{cell}, reward, done);
+        big_board.record(0, cell, reward, done);
+        moves++;
+    }
+    const Episode& ten = big_board.get_episodes().front();
+    assert(ten.length == moves);
+    assert(big_board.get_arena_bytes() == static_cast<size_t>(moves) * (sizeof(uint16_t) + sizeof(float)));
+    assert(ten.state_at(moves) == env10.get_state());
+    const size_t board_copies = static_cast<size_t>(moves) * (sizeof(BoardState) + 100 * sizeof(int));
+    std::cout << "✓ 10x10 episode of " << moves << " moves: " << big_board.get_arena_bytes()
+              << " bytes vs " << board_copies << " bytes of BoardState copies" << std::endl;
+
+    // Test 5: Checkpointing alongside the batch
+    std::cout << "\n5. Testing recorder snapshots..." << std::endl;
+    {
+        auto pick = [N](const BatchedEnvironment& env, int t, std::vector<int32_t>& out) {
+            for (int i = 0; i < env.get_num_envs(); ++i) {
+                const uint8_t* mask = env.get_action_masks() + i * N * N;
+                const int start = (i * 3 + t * 7) % (N * N);
+                for (int k = 0; k < N * N; ++k) {
+                    if (mask[(start + k) % (N * N)]) {
+                        out[i] = (start + k) % (N * N);
+                        break;
+                    }
+                }
+            }
+        };
+        // Runs steps [from, to), flushing and resetting the recorder every 5 steps
+        auto play = [&](BatchedEnvironment& env, EpisodeRecorder& rec, int from, int to) {
+            for (int t = from; t < to; ++t) {
+                pick(env, t, actions);
+                env.step(actions.data());
+                rec.record_batch(actions.data(), env.get_rewards(), env.get_dones());
+                if (t % 5 == 4 && t + 1 < to) {
+                    rec.flush();
+                    rec.reset();
+                }
+            }
+        };
+        auto same = [](const Episode& a, const Episode& b) {
+            return a.length == b.length && a.offset == b.offset && a.finished == b.finished &&
+                   std::memcmp(a.history, b.history, a.offset * sizeof(uint16_t)) == 0 &&
+                   std::memcmp(a.moves, b.moves, a.length * sizeof(uint16_t)) == 0 &&
+                   std::memcmp(a.rewards, b.rewards, a.length * sizeof(float)) == 0;
+        };
+
+        BatchedEnvironment env(B, N, std::make_shared<ActionReward>());
+        EpisodeRecorder rec(B, N, 256);
+        env.reset();
+        play(env, rec, 0, 23);
+        const std::vector<uint8_t> env_snapshot = env.save_snapshot();
+        const std::vector<uint8_t> rec_snapshot = rec.save_snapshot();
+        play(env, rec, 23, 29);
+        rec.flush();
+
+        BatchedEnvironment resumed_env(B, N, std::make_shared<ActionReward>());
+        EpisodeRecorder resumed(B, N);
+        resumed_env.load_snapshot(env_snapshot.data(), env_snapshot.size());
+        resumed.load_snapshot(rec_snapshot.data(), rec_snapshot.size());
+        play(resumed_env, resumed, 23, 29);
+        resumed.flush();
+        assert(resumed.get_episodes().size() == rec.get_episodes().size());
+        int continued = 0;
+        for (size_t e = 0; e < rec.get_episodes().size(); ++e) {
+            assert(same(resumed.get_episodes()[e], rec.get_episodes()[e]));
+            continued += rec.get_episodes()[e].offset > 0;
+        }
+        assert(continued > 0);
+
+        // A round trip reproduces the episodes exactly
+        EpisodeRecorder copy(B, N);
+        const std::vector<uint8_t> full = rec.save_snapshot();
+        copy.load_snapshot(full.data(), full.size());
+        assert(copy.save_snapshot() == full);
+
+        try {
+            EpisodeRecorder other(B + 1, N);
+            other.load_snapshot(full.data(), full.size());
+            assert(false);
+        } catch (const std::invalid_argument& e) {
+            std::cout << "Caught expected exception: " << e.what() << std::endl;
+        }
+        std::vector<uint8_t> damaged = full;
+        damaged.pop_back();
+        try {
+            copy.load_snapshot(damaged.data(), damaged.size());
+            assert(false);
+        } catch (const std::runtime_error& e) {
+            std::cout << "Caught expected exception: " << e.what() << std::endl;
+        }
+        assert(copy.save_snapshot() == full);  // the failed load changed nothing
+        std::cout << "✓ " << rec.get_episodes().size() << " episodes (" << continued
+                  << " continued from an earlier batch) match after restoring mid-game" << std::endl;
+    }
+
+    // Test 6: Rows where try_step played no move
+    std::cout << "\n6. Testing try_step batches with invalid actions..." << std::endl;
+    {
+        BatchedEnvironment lenient(3, 3, std::make_shared<ActionReward>());
+        EpisodeRecorder rec(3, 3);
+        lenient.reset();
+        auto play = [&](std::vector<int32_t> row) {
+            lenient.try_step(row.data());
+            rec.record_batch(lenient.get_actions(), lenient.get_rewards(), lenient.get_dones());
+        };
+        play({4, 4, 4});
+        play({0, 4, 99});  // env 1 occupied, env 2 out of bounds: rejected
+        play({8, 0, 0});
+        rec.flush();
+        const std::vector<Episode>& cut = rec.get_episodes();
+        assert(cut.size() == 3);
+        assert(cut[0].length == 3 && cut[0].moves[1] == 0 && cut[0].moves[2] == 8);
+        for (int i = 1; i < 3; ++i) {
+            assert(cut[i].length == 2 && cut[i].moves[0] == 4 && cut[i].moves[1] == 0);
+            assert(cut[i].state_at(2) == lenient.get_env(i).get_state());
+        }
+
+        // A penalized move ends the game without a step; the next game starts afresh
+        rec.reset();
+        lenient.set_invalid_action_policy(InvalidActionPolicy::PenalizeAndEnd, -1.0f);
+        play({1, 1, 4});  // env 2 forfeits right after the flush
+        play({2, 4, 4});  // env 1 forfeits after one more move; env 2 opens a new game
+        assert(lenient.get_dones()[1] == 1 && lenient.get_actions()[1] == kNoAction);
+        rec.flush();
+        const std::vector<Episode>& after = rec.get_episodes();
+        assert(after.size() == 3);
+        assert(!after[0].finished && after[0].offset == 2 && after[0].length == 1 && after[0].moves[0] == 1);
+        assert(after[1].offset == 3 && after[1].length == 2 && after[1].state_at(2) == lenient.get_env(0).get_state());
+        assert(after[2].offset == 0 && after[2].length == 1 && after[2].moves[0] == 4);
+        assert(after[2].state_at(1) == lenient.get_env(2).get_state());
+    }
+    std::cout << "✓ Rejected and penalized actions are not recorded as moves" << std::endl;
+
+    // Test 7: Invalid input
+    std::cout << "\n7. Testing invalid arguments..." << std::endl;
+    try {
+        recorder.record(B, 0, 0.0f, false);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    try {
+        ten.state_at(ten.length + 1);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    std::cout << "✓ Invalid arguments rejected" << std::endl;
+
+    std::cout << "\n=== ALL EPISODE RECORDER TESTS PASSED! ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,181 @@
+#include <iostream>
+#include "../include/environment.h"
+#include "../include/inference.h"
+#include "../include/eval_broker.h"
+#include "test_helpers.h"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+struct Position {
+    std::vector<float> observation;
+    std::vector<uint8_t> mask;
+    std::vector<float> logits;  // expected, from an unbatched forward pass
+    float value;
+};
+
+// Random mid-game positions with their single-position network outputs
+std::vector<Position> make_positions(PolicyNetwork& network, int count, std::mt19937& rng) {
+    const int N = network.board_size();
+    auto reward_fn = std::make_shared<DefaultReward>();
+    std::vector<Position> positions(count);
+    for (Position& p : positions) {
+        Environment env(N, reward_fn);
+        env.reset();
+        const int moves = static_cast<int>(rng() % (N * N / 2));
+        for (int m = 0; m < moves; ++m) {
+            std::vector<bool> legal = env.get_action_mask();
+            int a;
+            do {
+                a = static_cast<int>(rng() % (N * N));
+            } while (!legal[a]);
+            if (env.step(Action{a}).done) break;
+        }
+        p.observation = env.get_one_hot_state();
+        p.mask.resize(N * N);
+        env.write_action_mask(p.mask.data());
+        p.logits.resize(N * N);
+        network.forward(p.observation.data(), p.mask.data(), 1, p.logits.data(), &p.value);
+    }
+    return positions;
+}
+
+bool matches(const Position& p, const std::vector<float>& logits, float value) {
+    if (!close(value, p.value, 1e-5f)) return false;
+    for (size_t c = 0; c < logits.size(); ++c) {
+        if (!close(logits[c], p.logits[c], 1e-5f)) return false;
+    }
+    return true;
+}
+
+int main() {
+    std::cout << "=== Testing Evaluation Broker ===" << std::endl;
+    std::mt19937 rng(11);
+    const int N = 5;
+    std::vector<Layer> trunk = {make_layer(LayerType::Conv3x3, Activation::ReLU, 2, 8, rng),
+                                make_layer(LayerType::Dense, Activation::ReLU, 8 * N * N, 32, rng)};
+    PolicyNetwork network(N, trunk, make_layer(LayerType::Dense, Activation::None, 32, N * N, rng),
+                          make_layer(LayerType::Dense, Activation::None, 32, 1, rng));
+    std::vector<Position> positions = make_positions(network, 64, rng);
+
+    // Test 1: Blocking evaluation from one caller
+    std::cout << "\n1. Testing blocking evaluation..." << std::endl;
+    {
+        EvalBrokerConfig config;
+        config.max_batch = 16;
+        config.deadline_us = 100;
+        EvaluationBroker broker(network, config);
+        std::vector<float> logits(N * N);
+        for (const Position& p : positions) {
+            const float value = broker.evaluate(p.observation.data(), p.mask.data(), logits.data());
+            assert(matches(p, logits, value));
+            // Without a mask, legality is read off the observation
+            const float derived = broker.evaluate(p.observation.data(), nullptr, logits.data());
+            assert(matches(p, logits, derived));
+        }
+        EvalBrokerStats stats = broker.get_stats();
+        assert(stats.requests == 128 && stats.batches == 128 && stats.full_batches == 0);
+    }
+    std::cout << "✓ Results match unbatched forward passes; a lone caller is served by the deadline" << std::endl;
+
+    // Test 2: Many search threads share batches
+    std::cout << "\n2. Testing batching across threads..." << std::endl;
+    {
+        EvalBrokerConfig config;
+        config.max_batch = 8;
+        config.deadline_us = 20000;
+        EvaluationBroker broker(network, config);
+        const int threads = 16;
+        const int per_thread = 100;
+        std::atomic<int> wrong{0};
+        std::vector<std::thread> pool;
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < threads; ++t) {
+            pool.emplace_back([&, t] {
+                std::vector<float> logits(N * N);
+                for (int k = 0; k < per_thread; ++k) {
+                    const Position& p = positions[(t * 7 + k) % positions.size()];
+                    const float value = broker.evaluate(p.observation.data(), p.mask.data(), logits.data());
+                    if (!matches(p, logits, value)) wrong++;
+                }
+            });
+        }
+        for (std::thread& t : pool) t.join();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        EvalBrokerStats stats = broker.get_stats();
+        assert(wrong == 0);
+        assert(stats.requests == static_cast<uint64_t>(threads * per_thread));
+        assert(stats.mean_batch() > 4.0 && stats.full_batches > 0);
+        std::cout << "✓ " << stats.requests << " evaluations in " << stats.batches << " batches (mean "
+                  << stats.mean_batch() << ", " << stats.full_batches << " full) in " << seconds * 1000.0 << " ms"
+                  << std::endl;
+    }
+
+    // Test 3: Asynchronous submissions with completion callbacks
+    std::cout << "\n3. Testing asynchronous submissions..." << std::endl;
+    {
+        EvalBrokerConfig config;
+        config.max_batch = 10;
+        config.deadline_us = 50000;
+        std::vector<std::vector<float>> logits(positions.size(), std::vector<float>(N * N));
+        std::vector<float> values(positions.size());
+        std::atomic<int> completed{0};
+        {
+            EvaluationBroker broker(network, config);
+            for (size_t i = 0; i < positions.size(); ++i) {
+                broker.submit(positions[i].observation.data(), positions[i].mask.data(), logits[i].data(),
+                              &values[i], [&] { completed++; });
+            }
+            while (completed < 60) std::this_thread::yield();
+            EvalBrokerStats stats = broker.get_stats();
+            assert(stats.full_batches == 6 && stats.requests == 60);
+            // The last 4 requests wait for their deadline, or for the destructor
+        }
+        assert(completed == static_cast<int>(positions.size()));
+        for (size_t i = 0; i < positions.size(); ++i) assert(matches(positions[i], logits[i], values[i]));
+    }
+    std::cout << "✓ Callbacks fire per full batch; pending requests are drained on destruction" << std::endl;
+
+    // Test 4: Deadline
+    std::cout << "\n4. Testing the batching deadline..." << std::endl;
+    {
+        EvalBrokerConfig config;
+        config.max_batch = 64;
+        config.deadline_us = 5000;
+        EvaluationBroker broker(network, config);
+        std::vector<float> logits(N * N);
+        auto start = std::chrono::steady_clock::now();
+        broker.evaluate(positions[0].observation.data(), positions[0].mask.data(), logits.data());
+        const double waited = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        assert(waited >= 0.005 && waited < 1.0);
+        std::cout << "✓ A partial batch fired after " << waited * 1000.0 << " ms (deadline 5 ms)" << std::endl;
+    }
+
+    // Test 5: Invalid configurations
+    std::cout << "\n5. Testing invalid configurations..." << std::endl;
+    try {
+        EvalBrokerConfig config;
+        config.max_batch = 0;
+        EvaluationBroker broker(network, config);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    try {
+        EvalBrokerConfig config;
+        config.deadline_us = -1;
+        EvaluationBroker broker(network, config);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    std::cout << "✓ Invalid configurations rejected" << std::endl;
+
+    std::cout << "\n=== ALL EVALUATION BROKER TESTS PASSED! ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,153 @@
+#include <iostream>
+#include "../include/environment.h"
+#include "../include/batched_environment.h"
+#include "../include/feature_planes.h"
+#include "../include/symmetry.h"
+#include <cassert>
+#include <memory>
+#include <vector>
+
+// Planes for a single environment
+std::vector<float> planes_of(const Environment& env, const FeatureConfig& config) {
+    std::vector<float> out(num_feature_planes(config) * env.get_state().cells.size(), -1.0f);
+    write_feature_planes(env, config, out.data());
+    return out;
+}
+
+int main() {
+    std::cout << "=== Testing Feature Planes ===" << std::endl;
+    auto reward_fn = std::make_shared<DefaultReward>();
+
+    // Test 1: Recent-move ring buffer
+    std::cout << "\n1. Testing the recent-move ring buffer..." << std::endl;
+    Environment env(4, reward_fn);
+    env.reset();
+    assert(env.get_move_count() == 0 && env.get_recent_move(0) == -1);
+    const int moves[11] = {5, 0, 10, 1, 15, 2, 3, 4, 6, 7, 8};
+    for (int m = 0; m < 11; ++m) {
+        env.step(Action{moves[m]});
+        assert(env.get_move_count() == m + 1);
+        for (int k = 0; k < Environment::kMoveHistory; ++k) {
+            assert(env.get_recent_move(k) == (k <= m ? moves[m - k] : -1));
+        }
+    }
+    assert(env.get_recent_move(Environment::kMoveHistory) == -1 && env.get_recent_move(-1) == -1);
+    Environment copy = env;
+    assert(copy.get_recent_move(0) == 8 && copy.get_recent_move(7) == 1);
+    env.reset();
+    assert(env.get_move_count() == 0 && env.get_recent_move(0) == -1);
+    // The in-place reset leaves the same state as a fresh environment, ring included
+    copy.reset_in_place();
+    std::vector<uint8_t> reused(copy.snapshot_size()), fresh(env.snapshot_size());
+    copy.write_snapshot(reused.data());
+    env.write_snapshot(fresh.data());
+    assert(reused == fresh);
+    std::cout << "✓ Last " << Environment::kMoveHistory << " moves kept across wrap-around; reset clears them" << std::endl;
+
+    // Test 2: Stone, side-to-move and legal planes
+    std::cout << "\n2. Testing stone, side-to-move and legal planes..." << std::endl;
+    FeatureConfig basic;
+    assert(num_feature_planes(basic) == 4);
+    Environment three(3, reward_fn);
+    three.reset();
+    three.step(Action{4});  // X in the centre, O to move
+    std::vector<float> p = planes_of(three, basic);
+    assert(p[4] == 0.0f && p[9 + 4] == 1.0f);  // the centre is the opponent's from O's view
+    for (int c = 0; c < 9; ++c) {
+        assert(p[18 + c] == 0.0f);                       // Player 2 to move
+        assert(p[27 + c] == (c == 4 ? 0.0f : 1.0f));     // legal moves
+    }
+    three.step(Action{0});  // X to move
+    p = planes_of(three, basic);
+    assert(p[4] == 1.0f && p[9 + 0] == 1.0f && p[0] == 0.0f && p[18] == 1.0f);
+    FeatureConfig stones_only;
+    stones_only.side_to_move = false;
+    stones_only.legal_moves = false;
+    assert(num_feature_planes(stones_only) == 2);
+    std::vector<float> two = planes_of(three, stones_only);
+    assert(two.size() == 18 && two[4] == 1.0f && two[9] == 1.0f);
+    std::cout << "✓ Planes are relative to the player to move; side-to-move and legal planes match" << std::endl;
+
+    // Test 3: Last-k-move planes
+    std::cout << "\n3. Testing history planes..." << std::endl;
+    FeatureConfig history;
+    history.history = 3;
+    assert(num_feature_planes(history) == 7);
+    three.reset();
+    three.step(Action{4});
+    three.step(Action{8});
+    p = planes_of(three, history);
+    for (int c = 0; c < 9; ++c) {
+        assert(p[27 + c] == (c == 8 ? 1.0f : 0.0f));  // last move
+        assert(p[36 + c] == (c == 4 ? 1.0f : 0.0f));  // the one before
+        assert(p[45 + c] == 0.0f);                    // not played yet
+    }
+    std::cout << "✓ Plane k marks the (k+1)-th most recent move; missing moves leave it empty" << std::endl;
+
+    // Test 4: Batched feature tensors
+    std::cout << "\n4. Testing batched feature tensors..." << std::endl;
+    const int B = 5;
+    const int N = 4;
+    FeatureConfig full;
+    full.history = 4;
+    const int P = num_feature_planes(full);
+    for (bool augment : {false, true}) {
+        BatchedEnvironment batch(B, N, reward_fn);
+        batch.set_symmetry_augmentation(augment, 3);
+        batch.reset();
+        batch.set_feature_config(full);
+        assert(batch.get_num_feature_planes() == P);
+        const float* buffer = batch.get_features();
+        uint32_t lcg = 7;
+        int finished = 0;
+        for (int t = 0; t < 120; ++t) {
+            for (int i = 0; i < B; ++i) {
+                std::vector<float> expected = planes_of(batch.get_env(i), full);
+                const int sym = batch.get_symmetries()[i];
+                const float* row = batch.get_features() + i * P * N * N;
+                for (int plane = 0; plane < P; ++plane) {
+                    for (int c = 0; c < N * N; ++c) {
+                        assert(row[plane * N * N + transform_cell(N, sym, c)] == expected[plane * N * N + c]);
+                    }
+                }
+            }
+            std::vector<int32_t> actions(B);
+            for (int i = 0; i < B; ++i) {
+                const std::vector<int>& cells = batch.get_env(i).get_state().cells;
+                do {
+                    lcg = lcg * 1664525u + 1013904223u;
+                    actions[i] = static_cast<int32_t>((lcg >> 8) % (N * N));
+                } while (cells[actions[i]] != 0);
+            }
+            batch.step(actions.data());
+            for (int i = 0; i < B; ++i) finished += batch.get_dones()[i];
+        }
+        assert(batch.get_features() == buffer);
+        std::cout << "✓ " << (augment ? "Augmented" : "Plain") << " [" << B << ", " << P << ", " << N << ", " << N
+                  << "] tensors match per-environment planes over " << finished << " finished episodes" << std::endl;
+    }
+
+    // Test 5: Invalid configurations
+    std::cout << "\n5. Testing invalid configurations..." << std::endl;
+    try {
+        FeatureConfig too_long;
+        too_long.history = Environment::kMoveHistory + 1;
+        num_feature_planes(too_long);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    try {
+        FeatureConfig negative;
+        negative.history = -1;
+        BatchedEnvironment batch(2, 3, reward_fn);
+        batch.set_feature_config(negative);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    std::cout << "✓ Invalid configurations rejected" << std::endl;
+
+    std::cout << "\n=== ALL FEATURE PLANE TESTS PASSED! ===" << std::endl;
+    return 0;
+}
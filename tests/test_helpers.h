@@ -0,0 +1,61 @@
+#pragma once
+
+// Fixtures shared by several test executables
+
+#include "../include/environment.h"
+#include "../include/agent.h"
+#include "../include/match_runner.h"
+#include "../include/inference.h"
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Deterministic pseudo-random layer for tests
+inline Layer make_layer(LayerType type, Activation activation, int in, int out, std::mt19937& rng) {
+    std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+    Layer layer{type, activation, in, out, {}, {}};
+    size_t count = static_cast<size_t>(in) * out * (type == LayerType::Conv3x3 ? 9 : 1);
+    layer.weights.resize(count);
+    layer.bias.resize(out);
+    for (float& w : layer.weights) w = dist(rng);
+    for (float& b : layer.bias) b = dist(rng);
+    return layer;
+}
+
+// Relative comparison of network outputs; equal infinities (masked logits) match
+inline bool close(float a, float b, float tolerance = 1e-3f) {
+    return (std::isinf(a) && a == b) || std::fabs(a - b) <= tolerance * (1.0f + std::fabs(b));
+}
+
+// Plays a fixed move sequence and returns the environment
+inline Environment position(int N, const std::vector<int>& moves) {
+    Environment env(N, std::make_shared<DefaultReward>());
+    env.reset();
+    for (int m : moves) env.step(Action{m});
+    return env;
+}
+
+// Outcome counts of `first` (as X) and `second` (as O) over many games
+struct Tally {
+    int first_wins = 0;
+    int second_wins = 0;
+    int draws = 0;
+};
+
+inline Tally play(std::shared_ptr<const Agent> first, std::shared_ptr<const Agent> second, int N, int games,
+                  int games_per_thread = 16) {
+    Tally tally;
+    MatchRunnerConfig config;
+    config.N = N;
+    config.num_threads = 2;
+    config.games_per_thread = games_per_thread;
+    run_matches({first, second}, games, config, [](uint64_t) { return Match{0, 1}; },
+                [&](int, uint64_t, const Match&, int8_t outcome) {
+                    if (outcome == OUTCOME_PLAYER1_WIN) tally.first_wins++;
+                    else if (outcome == OUTCOME_PLAYER2_WIN) tally.second_wins++;
+                    else tally.draws++;
+                });
+    return tally;
+}
@@ -0,0 +1,218 @@
+#include <iostream>
+#include "../include/environment.h"
+#include "../include/agent.h"
+#include "../include/match_runner.h"
+#include "../include/league.h"
+#include <memory>
+#include <cassert>
+#include <vector>
+
+// Always plays the lowest empty cell
+class FirstCellAgent : public Agent {
+public:
+    void act(const Environment* const* envs, RngStream*, int count, int32_t* actions) override {
+        for (int i = 0; i < count; ++i) {
+            const std::vector<int>& cells = envs[i]->get_state().cells;
+            int c = 0;
+            while (cells[c] != 0) ++c;
+            actions[i] = c;
+        }
+    }
+    std::unique_ptr<Agent> clone() const override { return std::make_unique<FirstCellAgent>(); }
+};
+
+// Wins when it can, blocks when it must, otherwise plays randomly (3x3 only)
+class TacticalAgent : public Agent {
+public:
+    void act(const Environment* const* envs, RngStream* rngs, int count, int32_t* actions) override {
+        RandomAgent fallback;
+        for (int i = 0; i < count; ++i) {
+            const std::vector<int>& cells = envs[i]->get_state().cells;
+            const int me = envs[i]->get_current_player();
+            int move = find_completion(cells, me);
+            if (move < 0) move = find_completion(cells, -me);
+            if (move < 0) fallback.act(&envs[i], &rngs[i], 1, &move);
+            actions[i] = move;
+        }
+    }
+    std::unique_ptr<Agent> clone() const override { return std::make_unique<TacticalAgent>(); }
+
+private:
+    static int find_completion(const std::vector<int>& cells, int player) {
+        static const int lines[8][3] = {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}, {0, 3, 6},
+                                        {1, 4, 7}, {2, 5, 8}, {0, 4, 8}, {2, 4, 6}};
+        for (const auto& line : lines) {
+            int mine = 0, empty = -1;
+            for (int c : line) {
+                if (cells[c] == player) mine++;
+                else if (cells[c] == 0) empty = c;
+            }
+            if (mine == 2 && empty >= 0) return empty;
+        }
+        return -1;
+    }
+};
+
+int main() {
+    std::cout << "=== Testing Self-Play League ===" << std::endl;
+    auto reward_fn = std::make_shared<DefaultReward>();
+
+    // Test 1: RandomAgent plays legal, reproducible moves
+    std::cout << "\n1. Testing RandomAgent..." << std::endl;
+    Environment env(3, reward_fn);
+    env.reset();
+    env.step(Action{4});
+    CounterRng rng(11);
+    RandomAgent random_agent;
+    const Environment* env_ptr = &env;
+    std::vector<int> counts(9, 0);
+    for (uint32_t g = 0; g < 800; ++g) {
+        RngStream a(rng, g, 0), b(rng, g, 0);
+        int32_t first, second;
+        random_agent.act(&env_ptr, &a, 1, &first);
+        random_agent.act(&env_ptr, &b, 1, &second);
+        assert(first == second);
+        assert(first != 4 && first >= 0 && first < 9);
+        counts[first]++;
+    }
+    for (int c = 0; c < 9; ++c) {
+        if (c != 4) assert(counts[c] > 60);
+    }
+    std::cout << "✓ Moves are legal, roughly uniform and reproducible" << std::endl;
+
+    // Test 2: PolicyAgent picks the best legal move when greedy
+    std::cout << "\n2. Testing PolicyAgent..." << std::endl;
+    Layer policy{LayerType::Dense, Activation::None, 18, 9, std::vector<float>(9 * 18, 0.0f), std::vector<float>(9, 0.0f)};
+    Layer value{LayerType::Dense, Activation::None, 18, 1, std::vector<float>(18, 0.0f), std::vector<float>(1, 0.0f)};
+    policy.bias[4] = 5.0f;
+    policy.bias[8] = 3.0f;
+    auto network = std::make_shared<const PolicyNetwork>(3, std::vector<Layer>{}, policy, value);
+    PolicyAgent greedy(network, true);
+    Environment fresh(3, reward_fn);
+    fresh.reset();
+    const Environment* both[2] = {&fresh, &env};  // the second has cell 4 taken
+    RngStream streams[2] = {RngStream(rng, 0, 0), RngStream(rng, 1, 0)};
+    int32_t chosen[2];
+    greedy.act(both, streams, 2, chosen);
+    assert(chosen[0] == 4 && chosen[1] == 8);
+    std::unique_ptr<Agent> sampler = PolicyAgent(network, false).clone();
+    int picked_center = 0;
+    for (uint32_t g = 0; g < 500; ++g) {
+        RngStream s(rng, g, 1);
+        int32_t a;
+        const Environment* f = &fresh;
+        sampler->act(&f, &s, 1, &a);
+        picked_center += a == 4;
+    }
+    assert(picked_center > 380);  // softmax puts ~0.85 on the centre
+    std::cout << "✓ Greedy follows the logits; sampling favours the centre (" << picked_center << "/500)" << std::endl;
+
+    // Test 3: Parallel results do not depend on the thread count
+    std::cout << "\n3. Testing run_matches determinism across thread counts..." << std::endl;
+    std::vector<std::shared_ptr<const Agent>> agents = {std::make_shared<RandomAgent>(), std::make_shared<TacticalAgent>()};
+    auto play = [&](int threads, int slots) {
+        std::vector<int8_t> outcomes(3000, 0);
+        MatchRunnerConfig config;
+        config.num_threads = threads;
+        config.games_per_thread = slots;
+        config.seed = 5;
+        run_matches(agents, outcomes.size(), config,
+                    [](uint64_t game) { return Match{static_cast<int>(game % 2), static_cast<int>(1 - game % 2)}; },
+                    [&](int, uint64_t game, const Match&, int8_t outcome) { outcomes[game] = outcome; });
+        return outcomes;
+    };
+    std::vector<int8_t> serial = play(1, 1);
+    std::vector<int8_t> parallel = play(4, 64);
+    assert(serial == parallel);
+    for (int8_t o : serial) assert(o != OUTCOME_ONGOING);
+    std::cout << "✓ 3000 games give identical outcomes on 1 and 4 threads" << std::endl;
+
+    // Test 4: League aggregates per-pair results consistently
+    std::cout << "\n4. Testing league result aggregation..." << std::endl;
+    LeagueConfig config;
+    config.num_threads = 4;
+    config.games_per_thread = 128;
+    config.seed = 1;
+    League league(config);
+    int learner = league.add_snapshot(std::make_shared<RandomAgent>(), "random");
+    int weak = league.add_snapshot(std::make_shared<FirstCellAgent>(), "first-cell");
+    int strong = league.add_snapshot(std::make_shared<TacticalAgent>(), "tactical");
+    league.run(learner, 4000);
+    assert(league.get_total_games() == 4000);
+    PairRecord vs_weak = league.get_record(learner, weak);
+    PairRecord vs_strong = league.get_record(learner, strong);
+    assert(vs_weak.games() + vs_strong.games() == 4000);
+    assert(league.get_record(weak, learner).wins == vs_weak.losses);
+    assert(league.get_record(strong, learner).losses == vs_strong.wins);
+    assert(vs_strong.score() < vs_weak.score());
+    assert(league.get_name(strong) == "tactical");
+    std::cout << "✓ Random scores " << vs_weak.score() << " vs first-cell, " << vs_strong.score() << " vs tactical" << std::endl;
+
+    // Test 5: Opponent sampling schemes
+    std::cout << "\n5. Testing opponent sampling schemes..." << std::endl;
+    std::vector<double> uniform = league.opponent_distribution(learner);
+    assert(uniform[learner] == 0.0 && uniform[weak] == 0.5 && uniform[strong] == 0.5);
+    config.sampling = OpponentSampling::PrioritizedHard;
+    League pfsp(config);
+    pfsp.add_snapshot(std::make_shared<RandomAgent>(), "random");
+    pfsp.add_snapshot(std::make_shared<FirstCellAgent>(), "first-cell");
+    pfsp.add_snapshot(std::make_shared<TacticalAgent>(), "tactical");
+    pfsp.run(learner, 2000);
+    std::vector<double> hard = pfsp.opponent_distribution(learner);
+    assert(hard[strong] > hard[weak]);
+    pfsp.run(learner, 2000);
+    // The harder opponent ends up with the larger share of the games
+    assert(pfsp.get_record(learner, strong).games() > pfsp.get_record(learner, weak).games());
+    std::cout << "✓ Prioritized sampling weights: first-cell " << hard[weak] << ", tactical " << hard[strong] << std::endl;
+
+    // Prioritized runs are reproducible whatever the thread count
+    auto prioritized = [&](int threads) {
+        LeagueConfig c = config;
+        c.num_threads = threads;
+        c.games_per_thread = threads == 1 ? 1 : 32;
+        League l(c);
+        l.add_snapshot(std::make_shared<RandomAgent>(), "random");
+        l.add_snapshot(std::make_shared<FirstCellAgent>(), "first-cell");
+        l.add_snapshot(std::make_shared<TacticalAgent>(), "tactical");
+        for (int chunk = 0; chunk < 3; ++chunk) l.run(learner, 500);
+        std::vector<uint64_t> table;
+        for (int a = 0; a < 3; ++a) {
+            for (int b = 0; b < 3; ++b) {
+                PairRecord r = l.get_record(a, b);
+                table.insert(table.end(), {r.wins, r.losses, r.draws});
+            }
+        }
+        return table;
+    };
+    assert(prioritized(1) == prioritized(4));
+    std::cout << "✓ Prioritized league results are identical on 1 and 4 threads" << std::endl;
+
+    // Test 6: A pool of one plays mirror games
+    std::cout << "\n6. Testing single-snapshot self-play and errors..." << std::endl;
+    League solo(config);
+    int only = solo.add_snapshot(std::make_shared<RandomAgent>(), "solo");
+    solo.run(only, 500);
+    PairRecord mirror = solo.get_record(only, only);
+    assert(mirror.games() == 500 + mirror.wins);  // every decisive game is one win and one loss
+    assert(mirror.wins == mirror.losses);
+    try {
+        solo.run(3, 10);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    LeagueConfig tiny;
+    tiny.max_snapshots = 1;
+    League full(tiny);
+    full.add_snapshot(std::make_shared<RandomAgent>(), "a");
+    try {
+        full.add_snapshot(std::make_shared<RandomAgent>(), "b");
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    std::cout << "✓ Mirror games recorded; bad learner and full pool rejected" << std::endl;
+
+    std::cout << "\n=== ALL LEAGUE TESTS PASSED! ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,230 @@
+#include <iostream>
+#include "../include/environment.h"
+#include "../include/batched_environment.h"
+#include "../include/line_evaluator.h"
+#include "../include/rng.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+// Full rescan of every K-run: open-line score for `player` and the histogram of lines
+// open for `player` by stone count
+int rescan(const std::vector<int>& board, int N, int K, int player, std::vector<int>* histogram = nullptr) {
+    const int directions[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    if (histogram) histogram->assign(K + 1, 0);
+    int score = 0;
+    for (int r = 0; r < N; ++r) {
+        for (int c = 0; c < N; ++c) {
+            for (const auto& d : directions) {
+                const int end_r = r + (K - 1) * d[0];
+                const int end_c = c + (K - 1) * d[1];
+                if (end_r < 0 || end_r >= N || end_c < 0 || end_c >= N) continue;
+                int mine = 0;
+                int theirs = 0;
+                for (int k = 0; k < K; ++k) {
+                    const int v = board[(r + k * d[0]) * N + c + k * d[1]];
+                    mine += v == player;
+                    theirs += v == -player;
+                }
+                if (theirs == 0) score += mine * mine;
+                if (mine == 0) score -= theirs * theirs;
+                if (histogram && theirs == 0) (*histogram)[mine]++;
+            }
+        }
+    }
+    return score;
+}
+
+bool matches(const LineEvaluator& e, const std::vector<int>& board) {
+    const int N = e.get_board_size();
+    const int K = e.get_win_length();
+    for (int player : {1, -1}) {
+        std::vector<int> histogram;
+        if (rescan(board, N, K, player, &histogram) != e.score(player)) return false;
+        for (int s = 0; s <= K; ++s) {
+            if (histogram[s] != e.open_lines(player, s)) return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    std::cout << "=== Testing Line Evaluator ===" << std::endl;
+
+    // Test 1: Line enumeration
+    std::cout << "\n1. Testing line enumeration..." << std::endl;
+    LineEvaluator three(3);
+    assert(three.get_num_lines() == 8 && three.get_win_length() == 3);
+    assert(three.open_lines(1, 0) == 8 && three.score(1) == 0);
+    LineEvaluator ten(10, 5);
+    assert(ten.get_num_lines() == 2 * 10 * 6 + 2 * 6 * 6);  // rows, columns, both diagonals
+    for (int l = 0; l < ten.get_num_lines(); ++l) {
+        const int* cells = ten.line_cells(l);
+        const int step = cells[1] - cells[0];
+        for (int k = 1; k < 5; ++k) assert(cells[k] - cells[k - 1] == step);
+    }
+    std::cout << "✓ 3x3 has 8 lines; 10x10 five-in-a-row has " << ten.get_num_lines() << std::endl;
+
+    // Test 2: Random games against a full rescan, forwards and undone
+    std::cout << "\n2. Testing random 10x10 games against a full rescan..." << std::endl;
+    RngStream rng(CounterRng(42), 0, 0);
+    int checked = 0;
+    for (int K : {5, 10, 3}) {
+        LineEvaluator e(10, K);
+        for (int game = 0; game < 4; ++game) {
+            std::vector<int> board(100, 0);
+            std::vector<int> order(100);
+            std::iota(order.begin(), order.end(), 0);
+            for (int i = 99; i > 0; --i) std::swap(order[i], order[rng.next_below(i + 1)]);
+            e.reset();
+            int player = 1;
+            for (int m : order) {
+                board[m] = player;
+                e.place(m, player);
+                assert(matches(e, board));
+                player = -player;
+                checked++;
+            }
+            for (int t = 99; t >= 50; --t) {
+                const int m = order[t];
+                e.remove(m, board[m]);
+                board[m] = 0;
+                assert(matches(e, board));
+            }
+            LineEvaluator fresh(10, K);
+            BoardState state{board, 10};
+            fresh.sync(state);
+            assert(matches(fresh, board) && fresh.score(1) == e.score(1));
+        }
+    }
+    std::cout << "✓ " << checked << " positions match after every move and every undo" << std::endl;
+
+    // Test 3: Threats and wins with K < N
+    std::cout << "\n3. Testing threats and completed lines..." << std::endl;
+    LineEvaluator five(10, 5);
+    for (int c = 22; c < 26; ++c) five.place(c, 1);  // four in a row, open at both ends
+    assert(five.threats(1) == 2 && !five.has_line(1) && five.threats(-1) == 0);
+    five.place(21, -1);
+    assert(five.threats(1) == 1);
+    five.place(26, 1);
+    assert(five.has_line(1) && five.open_lines(1, 5) == 1);
+    five.remove(26, 1);
+    assert(!five.has_line(1) && five.threats(1) == 1);
+    std::cout << "✓ Open fours and five-in-a-row counted; blocking closes a threat" << std::endl;
+
+    // Test 4: Incremental updates against rescanning
+    std::cout << "\n4. Testing update cost against a rescan..." << std::endl;
+    std::vector<int> board(100, 0);
+    LineEvaluator timed(10, 5);
+    std::vector<int> moves(100);
+    std::iota(moves.begin(), moves.end(), 0);
+    for (int i = 99; i > 0; --i) std::swap(moves[i], moves[rng.next_below(i + 1)]);
+    const int rounds = 200;
+    long long sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        timed.reset();
+        int player = 1;
+        for (int m : moves) {
+            timed.place(m, player);
+            sink += timed.score(player);
+            player = -player;
+        }
+    }
+    const double incremental = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        std::fill(board.begin(), board.end(), 0);
+        int player = 1;
+        for (int m : moves) {
+            board[m] = player;
+            sink -= rescan(board, 10, 5, player);
+            player = -player;
+        }
+    }
+    const double full = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    assert(sink == 0);
+    std::cout << "✓ " << rounds * 100 << " moves: " << incremental * 1000.0 << " ms incremental vs "
+              << full * 1000.0 << " ms rescanning (" << full / std::max(incremental, 1e-9) << "x)" << std::endl;
+
+    // Test 5: Shaped rewards in a batch
+    std::cout << "\n5. Testing LineShapingReward..." << std::endl;
+    const int B = 6;
+    const int N = 5;
+    const float scale = 0.01f;
+    auto reward_fn = std::make_shared<DefaultReward>();
+    BatchedEnvironment plain(B, N, reward_fn);
+    BatchedEnvironment shaped(B, N, reward_fn);
+    auto shaping = std::make_shared<LineShapingReward>(B, N, scale);
+    shaped.set_batch_reward(shaping);
+    plain.reset();
+    shaped.reset();
+    std::vector<int32_t> actions(B);
+    int finished = 0;
+    for (int t = 0; t < 300; ++t) {
+        std::vector<std::vector<int>> before(B);
+        for (int i = 0; i < B; ++i) {
+            before[i] = shaped.get_env(i).get_state().cells;
+            const uint8_t* mask = shaped.get_action_masks() + i * N * N;
+            do {
+                actions[i] = static_cast<int32_t>(rng.next_below(N * N));
+            } while (!mask[actions[i]]);
+        }
+        plain.step(actions.data());
+        shaped.step(actions.data());
+        for (int i = 0; i < B; ++i) {
+            const int8_t* row = shaped.get_boards() + i * N * N;
+            const std::vector<int> after(row, row + N * N);
+            const int mover = after[actions[i]];
+            const float expected = plain.get_rewards()[i] +
+                scale * (rescan(after, N, N, mover) - rescan(before[i], N, N, mover));
+            assert(std::fabs(shaped.get_rewards()[i] - expected) < 1e-5f);
+            finished += shaped.get_dones()[i];
+        }
+    }
+    // A rejected action leaves the board and the shaping alone
+    shaped.set_invalid_action_policy(InvalidActionPolicy::Reject);
+    std::fill(actions.begin(), actions.end(), N * N);
+    assert(shaped.try_step(actions.data()) == B);
+    for (int i = 0; i < B; ++i) assert(shaped.get_rewards()[i] == 0.0f);
+    try {
+        LineShapingReward wrong(B + 1, N, scale);
+        std::vector<float> rewards(B, 0.0f);
+        wrong(shaped.get_boards(), actions.data(), shaped.get_outcomes(), B, N, rewards.data());
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    std::cout << "✓ Rewards equal base reward + scale * rescan delta over " << finished
+              << " finished episodes" << std::endl;
+
+    // Test 6: Invalid arguments
+    std::cout << "\n6. Testing invalid arguments..." << std::endl;
+    try {
+        LineEvaluator bad(0);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    try {
+        LineEvaluator bad(4, 5);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    try {
+        LineEvaluator small(3);
+        small.sync(BoardState{std::vector<int>(16, 0), 4});
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    std::cout << "✓ Invalid arguments rejected" << std::endl;
+
+    std::cout << "\n=== ALL LINE EVALUATOR TESTS PASSED! ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,315 @@
+#include <iostream>
+#include "../include/environment.h"
+#include "../include/symmetry.h"
+#include "../include/llm_connector.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Local stand-in for an LLM service. Each POST carries a batch of positions; the reply
+// suggests the first empty cell of each one (or nonsense, if `garbage` is set).
+class MockLLMServer {
+public:
+    std::atomic<int> http_requests{0};
+    std::atomic<int> positions{0};
+    std::atomic<int> active{0};
+    std::atomic<int> max_active{0};
+    int delay_ms = 0;
+    bool garbage = false;
+
+    MockLLMServer() {
+        listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        socklen_t len = sizeof(addr);
+        getsockname(listen_fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        port = ntohs(addr.sin_port);
+        listen(listen_fd, 64);
+        acceptor = std::thread([this] { accept_loop(); });
+    }
+
+    ~MockLLMServer() {
+        shutdown(listen_fd, SHUT_RDWR);
+        close(listen_fd);
+        acceptor.join();
+        for (auto& t : handlers) t.join();
+    }
+
+    std::string endpoint() const { return "http://127.0.0.1:" + std::to_string(port) + "/llm"; }
+
+private:
+    int listen_fd;
+    int port;
+    std::thread acceptor;
+    std::vector<std::thread> handlers;
+
+    void accept_loop() {
+        while (true) {
+            int fd = accept(listen_fd, nullptr, nullptr);
+            if (fd < 0) return;
+            handlers.emplace_back([this, fd] { handle(fd); });
+        }
+    }
+
+    void handle(int fd) {
+        int now = ++active;
+        int prev = max_active.load();
+        while (now > prev && !max_active.compare_exchange_weak(prev, now)) {}
+
+        std::string request;
+        char buf[4096];
+        size_t body_start = std::string::npos;
+        size_t length = 0;
+        while (body_start == std::string::npos || request.size() < body_start + length) {
+            ssize_t n = recv(fd, buf, sizeof(buf), 0);
+            if (n <= 0) break;
+            request.append(buf, n);
+            if (body_start == std::string::npos && request.find("\r\n\r\n") != std::string::npos) {
+                body_start = request.find("\r\n\r\n") + 4;
+                length = std::stoul(request.substr(request.find("Content-Length:") + 15));
+            }
+        }
+        http_requests++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+
+        std::string body = "{\"responses\": [";
+        size_t pos = 0;
+        int count = 0;
+        while ((pos = request.find("\"cells\": [", pos)) != std::string::npos) {
+            pos += 10;
+            size_t end = request.find(']', pos);
+            std::string cells = request.substr(pos, end - pos);
+            int index = 0;
+            int empty = -1;
+            size_t start = 0;
+            while (start <= cells.size()) {
+                size_t comma = cells.find(',', start);
+                if (comma == std::string::npos) comma = cells.size();
+                if (empty < 0 && std::stoi(cells.substr(start, comma - start)) == 0) empty = index;
+                index++;
+                start = comma + 1;
+            }
+            if (count++ > 0) body += ", ";
+            body += garbage ? "\"no idea\"" : "\"I would play cell " + std::to_string(empty) + ".\"";
+        }
+        body += "]}";
+        positions += count;
+        active--;
+
+        std::string response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: " +
+                               std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+        send(fd, response.data(), response.size(), MSG_NOSIGNAL);
+        close(fd);
+    }
+};
+
+// Distinct (up to symmetry) 4x4 positions with one stone per player
+std::vector<BoardState> distinct_positions(int count) {
+    std::vector<BoardState> out;
+    std::vector<std::vector<int>> seen;
+    for (int x = 0; x < 16 && static_cast<int>(out.size()) < count; ++x) {
+        for (int o = 0; o < 16 && static_cast<int>(out.size()) < count; ++o) {
+            if (x == o) continue;
+            BoardState s{std::vector<int>(16, 0), 4};
+            s.cells[x] = 1;
+            s.cells[o] = -1;
+            std::vector<int> canonical(16);
+            apply_symmetry(s.cells.data(), canonical.data(), 4, canonical_symmetry(s));
+            if (std::find(seen.begin(), seen.end(), canonical) != seen.end()) continue;
+            seen.push_back(canonical);
+            out.push_back(s);
+        }
+    }
+    return out;
+}
+
+// The move the mock server's policy makes, seen from the caller's board
+int expected_move(const BoardState& s) {
+    int t = canonical_symmetry(s);
+    std::vector<int> canonical(s.cells.size());
+    apply_symmetry(s.cells.data(), canonical.data(), s.N, t);
+    int first_empty = static_cast<int>(std::find(canonical.begin(), canonical.end(), 0) - canonical.begin());
+    return transform_cell(s.N, inverse_symmetry(t), first_empty);
+}
+
+int main() {
+    std::cout << "=== Testing LLM Integration ===" << std::endl;
+
+    // Test 1: Board symmetries
+    std::cout << "\n1. Testing board symmetries..." << std::endl;
+    for (int N : {3, 4, 5}) {
+        for (int t = 0; t < kNumSymmetries; ++t) {
+            std::vector<int> perm = symmetry_permutation(N, t);
+            std::vector<int> sorted(perm);
+            std::sort(sorted.begin(), sorted.end());
+            for (int i = 0; i < N * N; ++i) {
+                assert(sorted[i] == i);  // a permutation
+                assert(transform_cell(N, inverse_symmetry(t), perm[i]) == i);
+            }
+        }
+    }
+    assert(transform_cell(3, 1, 0) == 2);  // quarter turn moves the top-left corner to top-right
+    assert(transform_cell(3, 4, 0) == 2);  // so does the horizontal flip
+    BoardState corner{{1, 0, 0, 0, -1, 0, 0, 0, 0}, 3};
+    for (int t = 0; t < kNumSymmetries; ++t) {
+        BoardState moved{std::vector<int>(9), 3};
+        apply_symmetry(corner.cells.data(), moved.cells.data(), 3, t);
+        std::vector<int> a(9), b(9);
+        apply_symmetry(corner.cells.data(), a.data(), 3, canonical_symmetry(corner));
+        apply_symmetry(moved.cells.data(), b.data(), 3, canonical_symmetry(moved));
+        assert(a == b && hash_cells(a) == hash_cells(b));
+    }
+    std::cout << "✓ Transforms are invertible permutations with a shared canonical form" << std::endl;
+
+    // Test 2: Latency histogram
+    std::cout << "\n2. Testing latency histogram..." << std::endl;
+    LatencyHistogram hist;
+    for (int i = 0; i < 90; ++i) hist.record(std::chrono::microseconds(100));
+    for (int i = 0; i < 10; ++i) hist.record(std::chrono::microseconds(5000));
+    assert(hist.count() == 100);
+    assert(hist.percentile(0.5) == 128);
+    assert(hist.percentile(0.99) == 8192);
+    std::cout << "✓ p50=" << hist.percentile(0.5) << "us p99=" << hist.percentile(0.99) << "us" << std::endl;
+
+    // Test 3: Single query against the mock server
+    std::cout << "\n3. Testing query_llm against a mock server..." << std::endl;
+    {
+        MockLLMServer server;
+        LLMConnectorConfig config;
+        config.endpoint = server.endpoint();
+        config.max_batch_delay_ms = 1;
+        AsyncLLMConnector connector(config);
+        BoardState s{{1, 0, 0, 0, -1, 0, 0, 0, 0}, 3};
+        Action a = connector.query_llm(s);
+        assert(a.index == expected_move(s));
+        assert(s.cells[a.index] == 0);
+        assert(server.http_requests == 1);
+        assert(connector.get_request_latency().count() == 1);
+        assert(connector.get_http_latency().count() == 1);
+        std::cout << "✓ Suggested cell " << a.index << " mapped back from the canonical board" << std::endl;
+    }
+
+    // Test 4: Batching and caching
+    std::cout << "\n4. Testing request coalescing and the symmetry-aware cache..." << std::endl;
+    {
+        MockLLMServer server;
+        LLMConnectorConfig config;
+        config.endpoint = server.endpoint();
+        config.max_batch_size = 8;
+        config.max_batch_delay_ms = 200;
+        config.max_in_flight = 1;
+        AsyncLLMConnector connector(config);
+        std::vector<BoardState> states = distinct_positions(8);
+        std::vector<std::future<Action>> futures;
+        for (const auto& s : states) futures.push_back(connector.suggest_move(s));
+        futures.push_back(connector.suggest_move(states[0]));  // joins the pending request
+        for (size_t i = 0; i < states.size(); ++i) {
+            assert(futures[i].get().index == expected_move(states[i]));
+        }
+        assert(futures.back().get().index == expected_move(states[0]));
+        assert(server.http_requests == 1);
+        assert(server.positions == 8);
+
+        // Rotated and reflected copies are answered from the cache
+        for (int t = 1; t < kNumSymmetries; ++t) {
+            for (const auto& s : states) {
+                BoardState moved{std::vector<int>(16), 4};
+                apply_symmetry(s.cells.data(), moved.cells.data(), 4, t);
+                std::future<Action> f = connector.suggest_move(moved);
+                assert(f.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+                assert(f.get().index == expected_move(moved));
+            }
+        }
+        LLMConnectorStats stats = connector.get_stats();
+        assert(stats.requests == 9 + 7 * 8);
+        assert(stats.cache_hits == 1 + 7 * 8);
+        assert(stats.batches_sent == 1 && stats.errors == 0);
+        assert(server.http_requests == 1);
+        std::cout << "✓ " << stats.requests << " requests served by " << stats.batches_sent << " HTTP call" << std::endl;
+    }
+
+    // Test 5: Bounded in-flight window
+    std::cout << "\n5. Testing in-flight window..." << std::endl;
+    {
+        MockLLMServer server;
+        server.delay_ms = 30;
+        LLMConnectorConfig config;
+        config.endpoint = server.endpoint();
+        config.max_batch_size = 1;
+        config.max_in_flight = 2;
+        AsyncLLMConnector connector(config);
+        std::vector<BoardState> states = distinct_positions(6);
+        std::vector<std::future<Action>> futures;
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& s : states) futures.push_back(connector.suggest_move(s));
+        // Submitting never blocks on the network
+        assert(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(30));
+        for (size_t i = 0; i < states.size(); ++i) {
+            assert(futures[i].get().index == expected_move(states[i]));
+        }
+        assert(server.http_requests == 6);
+        assert(server.max_active <= 2);
+        std::cout << "✓ At most " << server.max_active << " requests in flight" << std::endl;
+    }
+
+    // Test 6: Failures fall back to a legal move
+    std::cout << "\n6. Testing failure handling..." << std::endl;
+    {
+        MockLLMServer server;
+        server.garbage = true;
+        LLMConnectorConfig config;
+        config.endpoint = server.endpoint();
+        config.max_batch_delay_ms = 1;
+        AsyncLLMConnector connector(config);
+        BoardState s{{1, 0, 0, 0, 0, 0, 0, 0, 0}, 3};
+        assert(connector.query_llm(s).index == 1);
+        assert(connector.get_stats().errors == 1);
+        // Unusable answers are not cached
+        assert(connector.query_llm(s).index == 1);
+        assert(server.http_requests == 2);
+    }
+    {
+        // A port nobody listens on
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        socklen_t len = sizeof(addr);
+        getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        close(fd);
+        LLMConnectorConfig config;
+        config.endpoint = "http://127.0.0.1:" + std::to_string(ntohs(addr.sin_port)) + "/llm";
+        config.max_batch_delay_ms = 1;
+        AsyncLLMConnector connector(config);
+        BoardState s{{1, -1, 0, 0, 0, 0, 0, 0, 0}, 3};
+        assert(connector.query_llm(s).index == 2);
+        assert(connector.get_stats().errors == 1);
+    }
+    try {
+        LLMConnectorConfig config;
+        config.endpoint = "https://example.com/llm";
+        AsyncLLMConnector connector(config);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    std::cout << "✓ Failures return the first legal move and are counted" << std::endl;
+
+    std::cout << "\n=== ALL LLM INTEGRATION TESTS PASSED! ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include <iostream>
+#include "../include/environment.h"
+#include "../include/rng.h"
+#include "../include/sampling.h"
+#include <memory>
+#include <cassert>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+// Plays a batch of random games where every move is drawn from rng at (env, step),
+// splitting the environments over num_threads threads. Returns all moves in order.
+std::vector<int> play_random_games(const CounterRng& rng, int num_envs, int N, int num_threads) {
+    std::vector<int> moves(static_cast<size_t>(num_envs) * N * N, -1);
+    auto worker = [&](int begin, int end) {
+        auto reward_fn = std::make_shared<DefaultReward>();
+        for (int e = begin; e < end; ++e) {
+            Environment env(N, reward_fn);
+            env.reset();
+            for (int step = 0; step < N * N; ++step) {
+                std::vector<bool> mask = env.get_action_mask();
+                std::vector<int> legal;
+                for (int i = 0; i < N * N; ++i) if (mask[i]) legal.push_back(i);
+                int action = legal[rng.below(static_cast<uint32_t>(legal.size()), e, step)];
+                moves[static_cast<size_t>(e) * N * N + step] = action;
+                if (env.step(Action{action}).done) break;
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    int per_thread = (num_envs + num_threads - 1) / num_threads;
+    for (int t = 0; t < num_threads; ++t) {
+        int begin = t * per_thread;
+        int end = std::min(num_envs, begin + per_thread);
+        threads.emplace_back(worker, begin, end);
+    }
+    for (auto& t : threads) t.join();
+    return moves;
+}
+
+int main() {
+    std::cout << "=== Testing Counter-Based RNG ===" << std::endl;
+
+    // Test 1: Philox4x32-10 known-answer vectors (Random123)
+    std::cout << "\n1. Testing Philox4x32-10 known-answer vectors..." << std::endl;
+    PhiloxBlock zero = philox4x32({0, 0, 0, 0}, {0, 0});
+    assert((zero == PhiloxBlock{0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u}));
+    PhiloxBlock ones = philox4x32({0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu}, {0xffffffffu, 0xffffffffu});
+    assert((ones == PhiloxBlock{0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu}));
+    PhiloxBlock pi = philox4x32({0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u}, {0xa4093822u, 0x299f31d0u});
+    assert((pi == PhiloxBlock{0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u}));
+    std::cout << "✓ Philox output matches reference vectors" << std::endl;
+
+    // Test 2: Vectorized batch generation matches scalar draws
+    std::cout << "\n2. Testing batched generation against scalar draws..." << std::endl;
+    CounterRng rng(0x123456789abcdefULL);
+    const int count = 1003;  // not a multiple of the lane width
+    std::vector<float> uniforms(count);
+    std::vector<uint32_t> blocks(4 * count);
+    rng.fill_uniform(17, count, 99, 3, uniforms.data());
+    rng.fill_blocks(17, count, 99, 3, blocks.data());
+    for (int i = 0; i < count; ++i) {
+        assert(uniforms[i] == rng.uniform(17 + i, 99, 3));
+        PhiloxBlock b = rng.block(17 + i, 99, 3);
+        for (int w = 0; w < 4; ++w) assert(blocks[4 * i + w] == b[w]);
+        assert(uniforms[i] >= 0.0f && uniforms[i] < 1.0f);
+    }
+    std::cout << "✓ Batched uniforms and blocks equal scalar draws" << std::endl;
+
+    // Test 3: Streams keyed by seed, env and step are distinct
+    std::cout << "\n3. Testing stream independence..." << std::endl;
+    assert(rng.block(0, 0) != rng.block(1, 0));
+    assert(rng.block(0, 0) != rng.block(0, 1));
+    assert(rng.block(0, 0) != rng.block(0, 0, 1));
+    assert(rng.block(0, 0) != CounterRng(1).block(0, 0));
+    assert(rng.block(5, 7) == CounterRng(rng.get_seed()).block(5, 7));
+    std::cout << "✓ Different keys give different blocks; same key is repeatable" << std::endl;
+
+    // Test 4: Uniformity of bounded integers
+    std::cout << "\n4. Testing bounded integer uniformity..." << std::endl;
+    std::vector<int> buckets(9, 0);
+    const int draws = 90000;
+    for (int i = 0; i < draws; ++i) {
+        uint32_t v = rng.below(9, i, 0);
+        assert(v < 9);
+        buckets[v]++;
+    }
+    for (int c : buckets) {
+        assert(std::abs(c - draws / 9) < 400);
+    }
+    RngStream stream(rng, 3, 4);
+    RngStream replay(rng, 3, 4);
+    for (int i = 0; i < 10; ++i) {
+        assert(stream.next_u32() == replay.next_u32());
+    }
+    // Streams start above the reserved single-draw indices
+    RngStream first(rng, 3, 4);
+    assert(first.next_u32() == rng.block(3, 4, kFirstStreamDraw)[0]);
+    for (uint32_t d : {kSamplerDraw, kResampleDraw, kSymmetryDraw, kFuzzDraw}) {
+        assert(d < kFirstStreamDraw);
+        assert(rng.block(3, 4, d)[0] != rng.block(3, 4, kFirstStreamDraw)[0]);
+    }
+    std::cout << "✓ below() is uniform and RngStream is repeatable, above the reserved draws" << std::endl;
+
+    // Test 5: Rollouts are bitwise identical regardless of thread count
+    std::cout << "\n5. Testing rollout reproducibility across thread counts..." << std::endl;
+    std::vector<int> one_thread = play_random_games(rng, 64, 3, 1);
+    std::vector<int> three_threads = play_random_games(rng, 64, 3, 3);
+    std::vector<int> eight_threads = play_random_games(rng, 64, 3, 8);
+    assert(one_thread == three_threads);
+    assert(one_thread == eight_threads);
+    std::cout << "✓ 1, 3 and 8 threads produce identical games" << std::endl;
+
+    // Test 6: Counter-based sampler is independent of batch splitting
+    std::cout << "\n6. Testing counter-based sampler across batch splits..." << std::endl;
+    const int B = 100, A = 9;
+    std::vector<float> logits(B * A);
+    for (int i = 0; i < B * A; ++i) logits[i] = rng.uniform(i, 0, 7);
+    std::vector<int32_t> whole(B), split(B);
+    sample_masked_categorical(logits.data(), nullptr, B, A, rng, 0, 42, whole.data(), nullptr, nullptr);
+    sample_masked_categorical(logits.data(), nullptr, 30, A, rng, 0, 42, split.data(), nullptr, nullptr);
+    sample_masked_categorical(logits.data() + 30 * A, nullptr, B - 30, A, rng, 30, 42, split.data() + 30, nullptr, nullptr);
+    assert(whole == split);
+    std::cout << "✓ Sampling two halves equals sampling the whole batch" << std::endl;
+
+    std::cout << "\n=== ALL RNG TESTS PASSED! ===" << std::endl;
+    return 0;
+}
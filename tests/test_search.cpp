@@ -0,0 +1,151 @@
+#include <iostream>
+#include "../include/environment.h"
+#include "../include/agent.h"
+#include "../include/match_runner.h"
+#include "../include/search.h"
+#include "../include/tablebase.h"
+#include "test_helpers.h"
+#include <cassert>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+int main() {
+    std::cout << "=== Testing Alpha-Beta Search ===" << std::endl;
+    SearchLimits deep;
+    deep.max_depth = 16;
+
+    // Test 1: Tactics
+    std::cout << "\n1. Testing wins, blocks and double threats..." << std::endl;
+    AlphaBetaEngine engine;
+    SearchResult win = engine.search(position(4, {0, 4, 1, 5, 2, 6}), deep);
+    assert(win.move == 3 && win.score == kSearchWinScore - 1);
+    SearchResult block = engine.search(position(4, {0, 4, 1, 5, 2}), deep);
+    assert(block.move == 3);
+    // X to move faces O threats at cells 7 and 13 with no threat of its own
+    SearchResult lost = engine.search(position(4, {0, 4, 2, 5, 8, 6, 10, 1, 15, 9}), deep);
+    assert(lost.score == -(kSearchWinScore - 2));
+    std::cout << "✓ Immediate win, forced block and an unstoppable double threat scored exactly" << std::endl;
+
+    // Test 2: Exact values against the 3x3 tablebase
+    std::cout << "\n2. Testing full-depth values against the 3x3 tablebase..." << std::endl;
+    TablebaseConfig tb_config;
+    tb_config.N = 3;
+    Tablebase table = Tablebase::build(tb_config);
+    int checked = 0;
+    for (uint64_t i = 0; i < table.size(); ++i) {
+        const TablebaseEntry& entry = table.at(i);
+        if (entry.outcome() == TablebaseOutcome::Unreachable || entry.move == TablebaseEntry::kNoMove) continue;
+        uint64_t x, o;
+        table.get_indexer().position(i, x, o);
+        BoardState state{std::vector<int>(9, 0), 3};
+        for (int c = 0; c < 9; ++c) state.cells[c] = (x >> c & 1) ? 1 : (o >> c & 1) ? -1 : 0;
+        const int player = __builtin_popcountll(x) == __builtin_popcountll(o) ? 1 : -1;
+        SearchResult r = engine.search(state, player, deep);
+        if (entry.outcome() == TablebaseOutcome::Win) {
+            assert(r.score == kSearchWinScore - entry.distance());
+        } else if (entry.outcome() == TablebaseOutcome::Loss) {
+            assert(r.score == -(kSearchWinScore - entry.distance()));
+        } else {
+            assert(r.score > -(kSearchWinScore - 100) && r.score < kSearchWinScore - 100);
+        }
+        checked++;
+    }
+    SearchConfig k3;
+    k3.K = 3;
+    AlphaBetaEngine three_in_row(k3);
+    SearchResult opening = three_in_row.search(position(4, {}), deep);
+    assert(opening.score == kSearchWinScore - 5);  // the 4x4 three-in-a-row tablebase value
+    std::cout << "✓ " << checked << " positions agree in outcome and distance; 4x4 three-in-a-row is a win in "
+              << kSearchWinScore - opening.score << " plies (depth " << opening.depth << ", "
+              << opening.nodes << " nodes)" << std::endl;
+
+    // Test 3: Iterative deepening under a time budget
+    std::cout << "\n3. Testing time and node budgets..." << std::endl;
+    AlphaBetaEngine big;
+    SearchLimits timed;
+    timed.time_ms = 100;
+    Environment seven = position(7, {24, 16, 18});
+    auto start = std::chrono::steady_clock::now();
+    SearchResult budgeted = big.search(seven, timed);
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    assert(elapsed < 0.5);
+    assert(budgeted.depth >= 2 && budgeted.move >= 0 && seven.get_state().cells[budgeted.move] == 0);
+    SearchLimits counted;
+    counted.max_nodes = 20000;
+    SearchResult limited = big.search(seven, counted);
+    assert(limited.nodes < 30000 && limited.depth >= 1);
+    SearchLimits shallow;
+    shallow.max_depth = 3;
+    assert(big.search(seven, shallow).depth == 3);
+    std::cout << "✓ 7x7 search reached depth " << budgeted.depth << " in " << elapsed * 1000.0
+              << " ms; node limit stopped at " << limited.nodes << " nodes" << std::endl;
+
+    // Test 4: Lazy SMP
+    std::cout << "\n4. Testing Lazy-SMP threads..." << std::endl;
+    SearchConfig smp_config;
+    smp_config.num_threads = 4;
+    AlphaBetaEngine smp(smp_config);
+    for (uint64_t i = 0; i < table.size(); i += 37) {
+        const TablebaseEntry& entry = table.at(i);
+        if (entry.outcome() != TablebaseOutcome::Win || entry.move == TablebaseEntry::kNoMove) continue;
+        uint64_t x, o;
+        table.get_indexer().position(i, x, o);
+        BoardState state{std::vector<int>(9, 0), 3};
+        for (int c = 0; c < 9; ++c) state.cells[c] = (x >> c & 1) ? 1 : (o >> c & 1) ? -1 : 0;
+        const int player = __builtin_popcountll(x) == __builtin_popcountll(o) ? 1 : -1;
+        assert(smp.search(state, player, deep).score == kSearchWinScore - entry.distance());
+    }
+    SearchLimits six_deep;
+    six_deep.max_depth = 4;
+    Environment six = position(6, {14, 15, 21});
+    SearchResult parallel = smp.search(six, six_deep);
+    assert(parallel.depth == 4 && six.get_state().cells[parallel.move] == 0);
+    SearchResult serial = big.search(six, six_deep);
+    assert(parallel.nodes > serial.nodes / 2);  // helpers searched too
+    std::cout << "✓ Forced wins found with 4 threads; " << parallel.nodes << " nodes vs " << serial.nodes
+              << " on one thread" << std::endl;
+
+    // Test 5: As a scripted opponent
+    std::cout << "\n5. Testing AlphaBetaAgent in matches..." << std::endl;
+    SearchLimits rollout;
+    rollout.max_depth = 3;
+    auto searcher = std::make_shared<AlphaBetaAgent>(rollout);
+    auto random = std::make_shared<RandomAgent>();
+    start = std::chrono::steady_clock::now();
+    Tally as_first = play(searcher, random, 5, 40, 8);
+    const double match_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    assert(as_first.second_wins == 0 && as_first.first_wins >= 36);
+    Tally as_second = play(random, searcher, 5, 40, 8);
+    assert(as_second.first_wins == 0 && as_second.second_wins >= 30);
+    Tally vs_solver = play(searcher, std::make_shared<SolverAgent>(), 3, 20, 8);
+    assert(vs_solver.first_wins == 0 && vs_solver.second_wins == 0);
+    std::cout << "✓ Depth-3 agent never loses on 5x5 (40 games as X in " << match_seconds << " s)" << std::endl;
+
+    // Test 6: Invalid arguments
+    std::cout << "\n6. Testing invalid arguments..." << std::endl;
+    try {
+        engine.search(position(3, {0, 3, 1, 4, 2}), deep);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    try {
+        engine.search(position(9, {}), deep);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    try {
+        SearchConfig none;
+        none.num_threads = 0;
+        AlphaBetaEngine bad(none);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    std::cout << "✓ Invalid arguments rejected" << std::endl;
+
+    std::cout << "\n=== ALL SEARCH TESTS PASSED! ===" << std::endl;
+    return 0;
+}
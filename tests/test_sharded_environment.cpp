@@ -0,0 +1,216 @@
+#include <iostream>
+#include "../include/environment.h"
+#include "../include/batched_environment.h"
+#include "../include/sharded_environment.h"
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+bool aligned(const void* p) {
+    return reinterpret_cast<uintptr_t>(p) % kCacheLine == 0;
+}
+
+// A random legal action for every environment of the batch
+template <typename Batch>
+void random_actions(const Batch& batch, std::mt19937& rng, std::vector<int32_t>& actions) {
+    const int cells = batch.get_board_size() * batch.get_board_size();
+    const uint8_t* masks = batch.get_action_masks();
+    for (int i = 0; i < batch.get_num_envs(); ++i) {
+        int a;
+        do {
+            a = static_cast<int>(rng() % cells);
+        } while (!masks[i * cells + a]);
+        actions[i] = a;
+    }
+}
+
+int main() {
+    std::cout << "=== Testing Sharded Batched Environment ===" << std::endl;
+    auto reward_fn = std::make_shared<DefaultReward>();
+
+    // Test 1: Shard layout and alignment
+    std::cout << "\n1. Testing shard layout and alignment..." << std::endl;
+    {
+        ShardedEnvConfig config;
+        config.num_shards = 4;
+        ShardedBatchedEnvironment batch(300, 3, reward_fn, config);
+        assert(batch.get_num_shards() == 4);
+        assert(batch.get_shard_begin(0) == 0 && batch.get_shard_end(3) == 300);
+        for (int s = 0; s < batch.get_num_shards(); ++s) {
+            const int begin = batch.get_shard_begin(s);
+            assert(begin % kShardGranularity == 0 && begin < batch.get_shard_end(s));
+            if (s > 0) assert(begin == batch.get_shard_end(s - 1));
+            // Every shard's slice of every buffer starts on its own cache line
+            assert(aligned(batch.get_observations() + begin * 2 * 9));
+            assert(aligned(batch.get_action_masks() + begin * 9));
+            assert(aligned(batch.get_rewards() + begin));
+            assert(aligned(batch.get_dones() + begin));
+            assert(aligned(batch.get_boards() + begin * 9));
+            assert(aligned(batch.get_outcomes() + begin));
+        }
+
+        // Small batches get fewer shards than requested
+        config.num_shards = 8;
+        ShardedBatchedEnvironment small(100, 3, reward_fn, config);
+        assert(small.get_num_shards() == 2);
+        assert(small.get_shard_end(0) == 64 && small.get_shard_end(1) == 100);
+    }
+    std::cout << "✓ Shards are whole cache lines of every buffer" << std::endl;
+
+    // Test 2: Same results as BatchedEnvironment
+    std::cout << "\n2. Testing equivalence with BatchedEnvironment..." << std::endl;
+    {
+        const int B = 300;
+        const int N = 3;
+        const int cells = N * N;
+        ShardedEnvConfig config;
+        config.num_shards = 4;
+        ShardedBatchedEnvironment sharded(B, N, reward_fn, config);
+        BatchedEnvironment reference(B, N, reward_fn);
+        sharded.reset();
+        reference.reset();
+        std::mt19937 rng(5);
+        std::vector<int32_t> actions(B);
+        int finished = 0;
+        for (int t = 0; t < 200; ++t) {
+            random_actions(reference, rng, actions);
+            sharded.step(actions.data());
+            reference.step(actions.data());
+            assert(std::memcmp(sharded.get_observations(), reference.get_observations(), B * 2 * cells * sizeof(float)) == 0);
+            assert(std::memcmp(sharded.get_action_masks(), reference.get_action_masks(), B * cells) == 0);
+            assert(std::memcmp(sharded.get_rewards(), reference.get_rewards(), B * sizeof(float)) == 0);
+            assert(std::memcmp(sharded.get_dones(), reference.get_dones(), B) == 0);
+            assert(std::memcmp(sharded.get_boards(), reference.get_boards(), B * cells) == 0);
+            assert(std::memcmp(sharded.get_outcomes(), reference.get_outcomes(), B) == 0);
+            for (int i = 0; i < B; ++i) finished += sharded.get_dones()[i];
+        }
+        assert(finished > B);
+        assert(sharded.get_env(299).get_state().cells == reference.get_env(299).get_state().cells);
+        std::cout << "✓ 200 steps of " << B << " games (" << finished << " finished) match bit for bit" << std::endl;
+    }
+
+    // Test 3: Pinning
+    std::cout << "\n3. Testing thread pinning..." << std::endl;
+    {
+        ShardedEnvConfig config;
+        config.num_shards = 2;
+        config.pin_threads = true;
+        ShardedBatchedEnvironment batch(128, 3, reward_fn, config);
+        for (int s = 0; s < batch.get_num_shards(); ++s) {
+            assert(batch.get_shard_cpu(s) >= 0 && batch.get_shard_node(s) >= 0);
+            std::cout << "  shard " << s << ": CPU " << batch.get_shard_cpu(s) << ", node "
+                      << batch.get_shard_node(s) << std::endl;
+        }
+#ifdef __linux__
+        config.cpus = {batch.get_shard_cpu(0), batch.get_shard_cpu(0)};
+        ShardedBatchedEnvironment explicit_cpus(128, 3, reward_fn, config);
+        assert(explicit_cpus.get_shard_cpu(0) == config.cpus[0]);
+        assert(explicit_cpus.get_shard_cpu(1) == config.cpus[1]);
+#endif
+    }
+    std::cout << "✓ Shard workers run on the chosen CPUs" << std::endl;
+
+    // Test 4: Invalid actions and configurations
+    std::cout << "\n4. Testing invalid actions and configurations..." << std::endl;
+    {
+        ShardedEnvConfig config;
+        config.num_shards = 2;
+        ShardedBatchedEnvironment batch(128, 3, reward_fn, config);
+        batch.reset();
+        std::vector<int32_t> actions(128, 4);
+        batch.step(actions.data());
+        actions[100] = 4;  // already taken
+        actions[0] = 0;
+        for (int i = 1; i < 128; ++i) {
+            if (i != 100) actions[i] = 0;
+        }
+        try {
+            batch.step(actions.data());
+            assert(false);
+        } catch (const std::invalid_argument& e) {
+            std::cout << "Caught expected exception: " << e.what() << std::endl;
+        }
+        // No environment was stepped, in either shard, and the batch keeps working
+        assert(batch.get_env(0).get_state().cells[0] == 0);
+        assert(batch.get_env(127).get_state().cells[0] == 0);
+        assert(batch.get_boards()[99 * 9 + 0] == 0 && batch.get_action_masks()[127 * 9 + 0] == 1);
+        actions[100] = 99;
+        try {
+            batch.step(actions.data());
+            assert(false);
+        } catch (const std::invalid_argument& e) {
+            std::cout << "Caught expected exception: " << e.what() << std::endl;
+        }
+        actions[100] = 0;
+        batch.step(actions.data());
+        assert(batch.get_env(100).get_state().cells[0] == -1 && batch.get_boards()[127 * 9 + 0] == -1);
+    }
+    try {
+        ShardedBatchedEnvironment batch(0, 3, reward_fn);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    try {
+        ShardedEnvConfig config;
+        config.num_shards = 2;
+        config.pin_threads = true;
+        config.cpus = {0};
+        ShardedBatchedEnvironment batch(128, 3, reward_fn, config);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+#ifdef __linux__
+    try {
+        ShardedEnvConfig config;
+        config.num_shards = 1;
+        config.pin_threads = true;
+        config.cpus = {CPU_SETSIZE - 1};
+        ShardedBatchedEnvironment batch(64, 3, reward_fn, config);
+        assert(false);
+    } catch (const std::runtime_error& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+#endif
+    std::cout << "✓ Errors from shard workers reach the caller" << std::endl;
+
+    // Test 5: Throughput
+    std::cout << "\n5. Testing throughput..." << std::endl;
+    {
+        const int B = 4096;
+        const int N = 9;
+        const int steps = 50;
+        ShardedBatchedEnvironment sharded(B, N, reward_fn);
+        BatchedEnvironment reference(B, N, reward_fn);
+        sharded.reset();
+        reference.reset();
+        std::mt19937 rng(9);
+        std::vector<int32_t> actions(B);
+        double sharded_s = 0.0;
+        double reference_s = 0.0;
+        for (int t = 0; t < steps; ++t) {
+            random_actions(reference, rng, actions);
+            auto start = std::chrono::steady_clock::now();
+            sharded.step(actions.data());
+            auto mid = std::chrono::steady_clock::now();
+            reference.step(actions.data());
+            auto end = std::chrono::steady_clock::now();
+            sharded_s += std::chrono::duration<double>(mid - start).count();
+            reference_s += std::chrono::duration<double>(end - mid).count();
+        }
+        assert(std::memcmp(sharded.get_boards(), reference.get_boards(), static_cast<size_t>(B) * N * N) == 0);
+        std::cout << "✓ " << sharded.get_num_shards() << " shards: " << B * steps / sharded_s / 1e6
+                  << "M steps/s vs " << B * steps / reference_s / 1e6 << "M steps/s single-threaded" << std::endl;
+    }
+
+    std::cout << "\n=== ALL SHARDED ENVIRONMENT TESTS PASSED! ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include <iostream>
+#include "../include/environment.h"
+#include "../include/step_profiler.h"
+#include <chrono>
+#include <memory>
+#include <cassert>
+#include <sstream>
+#include <thread>
+
+// Reward callback that burns a few microseconds per call
+class SlowReward : public RewardCallback {
+public:
+    float operator()(const BoardState&, const Action&) override {
+        const auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(5);
+        while (std::chrono::steady_clock::now() < until) {}
+        return 0.0f;
+    }
+};
+
+// Plays `games` full games of the top-row opening on a 3x3 board (5 steps each)
+void play_games(std::shared_ptr<RewardCallback> reward_fn, int games) {
+    Environment env(3, reward_fn);
+    for (int g = 0; g < games; ++g) {
+        env.reset();
+        for (int action : {0, 3, 1, 4, 2}) {
+            env.step(Action{action});
+        }
+    }
+}
+
+int main() {
+    std::cout << "=== Testing Step Profiler ===" << std::endl;
+    std::cout << "Profiling " << (step_profiling_enabled() ? "enabled" : "disabled") << " in this build" << std::endl;
+
+    // Test 1: Phase counts match the steps taken
+    std::cout << "\n1. Testing phase call counts..." << std::endl;
+    reset_step_profile();
+    play_games(std::make_shared<DefaultReward>(), 100);
+    StepProfile profile = get_step_profile();
+    if (step_profiling_enabled()) {
+        assert(profile.steps == 500);
+        auto calls = [&](StepPhase p) { return profile.phases[static_cast<int>(p)].calls; };
+        assert(calls(StepPhase::Validation) == 500);
+        assert(calls(StepPhase::Apply) == 500);
+        assert(calls(StepPhase::CheckWinCurrent) == 500);
+        assert(calls(StepPhase::CheckWinOther) == 400);  // skipped on the winning move
+        assert(calls(StepPhase::BoardFull) == 400);
+        assert(calls(StepPhase::RewardCallback) == 500);
+        assert(calls(StepPhase::ResultCopy) == 500);
+        std::cout << "✓ Every phase counted once per step that reached it" << std::endl;
+    } else {
+        assert(profile.steps == 0);
+        for (const StepPhaseStats& s : profile.phases) assert(s.calls == 0 && s.ticks == 0);
+        std::cout << "✓ No counters touched when profiling is compiled out" << std::endl;
+    }
+
+    // Test 2: A slow reward callback shows up as the dominant phase
+    std::cout << "\n2. Testing attribution to the reward callback..." << std::endl;
+    reset_step_profile();
+    play_games(std::make_shared<SlowReward>(), 200);
+    profile = get_step_profile();
+    if (step_profiling_enabled()) {
+        const StepPhaseStats& reward = profile.phases[static_cast<int>(StepPhase::RewardCallback)];
+        double total = 0.0;
+        for (const StepPhaseStats& s : profile.phases) total += s.nanoseconds;
+        assert(reward.nanoseconds > 0.5 * total);
+        assert(reward.nanoseconds / reward.calls > 4000.0);  // at least the 5us spin, give or take
+        std::cout << "✓ Reward callback takes " << 100.0 * reward.nanoseconds / total << "% of step time" << std::endl;
+    } else {
+        assert(profile.steps == 0);
+        std::cout << "✓ Nothing recorded" << std::endl;
+    }
+
+    // Test 3: Counters from other threads, including exited ones, are included
+    std::cout << "\n3. Testing per-thread aggregation..." << std::endl;
+    reset_step_profile();
+    std::thread worker([] { play_games(std::make_shared<DefaultReward>(), 40); });
+    worker.join();
+    play_games(std::make_shared<DefaultReward>(), 10);
+    profile = get_step_profile();
+    assert(profile.steps == (step_profiling_enabled() ? 250u : 0u));
+    std::cout << "✓ Totals cover " << profile.steps << " steps from two threads" << std::endl;
+
+    // Test 4: Dump
+    std::cout << "\n4. Testing dump_step_profile..." << std::endl;
+    std::ostringstream out;
+    dump_step_profile(out);
+    if (step_profiling_enabled()) {
+        for (int p = 0; p < kNumStepPhases; ++p) {
+            assert(out.str().find(step_phase_name(static_cast<StepPhase>(p))) != std::string::npos);
+        }
+    } else {
+        assert(out.str().find("disabled") != std::string::npos);
+    }
+    std::cout << out.str();
+    std::cout << "✓ Report written" << std::endl;
+
+    std::cout << "\n=== ALL STEP PROFILER TESTS PASSED! ===" << std::endl;
+    return 0;
+}
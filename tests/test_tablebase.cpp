@@ -0,0 +1,342 @@
+#include <iostream>
+#include "../include/environment.h"
+#include "../include/agent.h"
+#include "../include/match_runner.h"
+#include "../include/tablebase.h"
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Reference value by memoised recursion over Environment copies: +1 win, 0 draw, -1 loss
+// for the player to move, with the distance the tablebase uses (win fast, lose slow)
+struct Solved {
+    int value;
+    int distance;
+    int score() const { return value == 1 ? 100 - distance : value == -1 ? -100 + distance : 0; }
+};
+
+Solved solve(const Environment& env, std::map<std::vector<int>, Solved>& memo) {
+    auto it = memo.find(env.get_state().cells);
+    if (it != memo.end()) return it->second;
+    Solved best{-2, 0};
+    const std::vector<int>& cells = env.get_state().cells;
+    for (int m = 0; m < static_cast<int>(cells.size()); ++m) {
+        if (cells[m] != 0) continue;
+        Environment child = env;
+        Solved s{0, 1};
+        if (child.step(Action{m}).done) {
+            s.value = child.get_winner() != 0 ? 1 : 0;
+        } else {
+            Solved reply = solve(child, memo);
+            s = Solved{-reply.value, reply.distance + 1};
+        }
+        if (best.value == -2 || s.score() > best.score()) best = s;
+    }
+    memo.emplace(cells, best);
+    return best;
+}
+
+// Every position reachable from env, as boards
+void collect(const Environment& env, std::set<std::vector<int>>& seen) {
+    if (!seen.insert(env.get_state().cells).second) return;
+    for (int m = 0; m < static_cast<int>(env.get_state().cells.size()); ++m) {
+        if (env.get_state().cells[m] != 0) continue;
+        Environment child = env;
+        if (!child.step(Action{m}).done) collect(child, seen);
+        else seen.insert(child.get_state().cells);
+    }
+}
+
+// Tablebase (as X or O) against random moves; returns the tablebase side's results
+int play_vs_random(const Tablebase& table, int N, int games, int& losses) {
+    RandomAgent random;
+    CounterRng rng(21);
+    int wins = 0;
+    losses = 0;
+    for (int g = 0; g < games; ++g) {
+        Environment env(N, std::make_shared<DefaultReward>());
+        env.reset();
+        const int table_player = g % 2 == 0 ? 1 : -1;
+        bool done = false;
+        for (int t = 0; !done; ++t) {
+            int32_t move;
+            if (env.get_current_player() == table_player) {
+                move = table.probe(env.get_state()).move;
+            } else {
+                RngStream s(rng, static_cast<uint32_t>(g), t);
+                const Environment* e = &env;
+                random.act(&e, &s, 1, &move);
+            }
+            done = env.step(Action{move}).done;
+        }
+        wins += env.get_winner() == table_player;
+        losses += env.get_winner() == -table_player;
+    }
+    return wins;
+}
+
+int main() {
+    std::cout << "=== Testing Retrograde Tablebase ===" << std::endl;
+
+    // Test 1: Dense layered index
+    std::cout << "\n1. Testing PositionIndexer..." << std::endl;
+    PositionIndexer three(3);
+    assert(three.size() == 6046);
+    for (uint64_t i = 0; i < three.size(); ++i) {
+        uint64_t x, o;
+        three.position(i, x, o);
+        assert((x & o) == 0);
+        assert(three.index(x, o) == i);
+    }
+    PositionIndexer four(4);
+    assert(four.size() == 10165779);
+    PositionIndexer five(5);
+    assert(five.size() == 161995031226ull);
+    for (uint64_t i = 0; i < five.size(); i += five.size() / 1000 + 7) {
+        uint64_t x, o;
+        five.position(i, x, o);
+        assert(five.index(x, o) == i);
+    }
+    std::vector<int> board = {1, -1, 0, 0, 1, 0, 0, 0, 0};
+    uint64_t x, o;
+    three.position(three.index(board.data()), x, o);
+    assert(x == 0x11 && o == 0x2);
+    try {
+        std::vector<int> two_o = {-1, -1, 0, 0, 0, 0, 0, 0, 0};
+        three.index(two_o.data());
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    std::cout << "✓ Index round-trips; 3x3 " << three.size() << ", 4x4 " << four.size() << ", 5x5 "
+              << five.size() << " slots" << std::endl;
+
+    // Test 2: 3x3 values match a brute-force search at every reachable position
+    std::cout << "\n2. Testing 3x3 values against brute force..." << std::endl;
+    TablebaseConfig config;
+    config.N = 3;
+    config.num_threads = 3;
+    Tablebase t3 = Tablebase::build(config);
+    Environment empty(3, std::make_shared<DefaultReward>());
+    empty.reset();
+    std::set<std::vector<int>> reachable;
+    collect(empty, reachable);
+    std::map<std::vector<int>, Solved> memo;
+    assert(t3.get_num_reachable() == reachable.size() && reachable.size() == 5478);
+    for (const std::vector<int>& cells : reachable) {
+        // Replay a board with the right player to move by placing X and O stones alternately
+        Environment env(3, std::make_shared<DefaultReward>());
+        env.reset();
+        std::vector<int> xs, os;
+        for (int c = 0; c < 9; ++c) {
+            if (cells[c] == 1) xs.push_back(c);
+            if (cells[c] == -1) os.push_back(c);
+        }
+        const TablebaseEntry& entry = t3.at(t3.get_indexer().index(cells.data()));
+        assert(entry.outcome() != TablebaseOutcome::Unreachable);
+        bool terminal = false;
+        for (size_t k = 0; k < xs.size() + os.size(); ++k) {
+            terminal = env.step(Action{k % 2 == 0 ? xs[k / 2] : os[k / 2]}).done;
+        }
+        if (terminal || xs.size() + os.size() == 9) {
+            assert(entry.distance() == 0 && entry.move == TablebaseEntry::kNoMove);
+            assert(entry.outcome() == (env.get_winner() != 0 ? TablebaseOutcome::Loss : TablebaseOutcome::Draw));
+            continue;
+        }
+        Solved expected = solve(env, memo);
+        const TablebaseOutcome outcome = expected.value == 1 ? TablebaseOutcome::Win
+                                       : expected.value == -1 ? TablebaseOutcome::Loss
+                                       : TablebaseOutcome::Draw;
+        assert(entry.outcome() == outcome && entry.distance() == expected.distance);
+        assert(cells[entry.move] == 0);
+    }
+    const TablebaseEntry& root = t3.probe(empty.get_state());
+    assert(root.outcome() == TablebaseOutcome::Draw && root.distance() == 9);
+    std::vector<int> both_lines = {1, 1, 1, -1, -1, -1, 0, 0, 0};
+    assert(t3.at(t3.get_indexer().index(both_lines.data())).outcome() == TablebaseOutcome::Unreachable);
+    std::cout << "✓ " << reachable.size() << " reachable positions with exact values and distances" << std::endl;
+
+    // Test 3: Thread count does not change the table; other win lengths
+    std::cout << "\n3. Testing determinism and K-in-a-row..." << std::endl;
+    config.num_threads = 1;
+    Tablebase serial = Tablebase::build(config);
+    for (uint64_t i = 0; i < t3.size(); ++i) {
+        assert(serial.at(i).packed == t3.at(i).packed && serial.at(i).move == t3.at(i).move);
+    }
+    config.K = 2;
+    Tablebase two_in_row = Tablebase::build(config);
+    assert(two_in_row.get_win_length() == 2);
+    assert(two_in_row.at(0).outcome() == TablebaseOutcome::Win && two_in_row.at(0).distance() == 3);
+    std::cout << "✓ Identical tables on 1 and 3 threads; 2-in-a-row on 3x3 is a win in 3 plies" << std::endl;
+
+    // Test 4: 4x4 perfect play
+    std::cout << "\n4. Testing the 4x4 table..." << std::endl;
+    config.N = 4;
+    config.K = 0;
+    config.num_threads = 0;
+    Tablebase t4 = Tablebase::build(config);
+    assert(t4.at(0).outcome() == TablebaseOutcome::Draw && t4.at(0).distance() == 16);
+    int losses;
+    int wins = play_vs_random(t4, 4, 200, losses);
+    assert(losses == 0 && wins > 120);
+    std::cout << "✓ " << t4.get_num_reachable() << " reachable positions; perfect play wins " << wins
+              << "/200 against random and never loses" << std::endl;
+
+    // Test 5: Save and load
+    std::cout << "\n5. Testing save/load..." << std::endl;
+    const std::string path = "test_tablebase_3x3.bin";
+    t3.save(path);
+    Tablebase loaded = Tablebase::load(path);
+    assert(loaded.get_board_size() == 3 && loaded.get_win_length() == 3);
+    assert(loaded.size() == t3.size() && loaded.get_num_reachable() == t3.get_num_reachable());
+    for (uint64_t i = 0; i < t3.size(); ++i) {
+        assert(loaded.at(i).packed == t3.at(i).packed && loaded.at(i).move == t3.at(i).move);
+    }
+    {
+        std::ofstream truncate(path, std::ios::binary | std::ios::trunc);
+        truncate << "TTTB";
+    }
+    try {
+        Tablebase::load(path);
+        assert(false);
+    } catch (const std::runtime_error& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    std::remove(path.c_str());
+    std::cout << "✓ Table round-trips through the file format" << std::endl;
+
+    // Test 6: Boards too large for the table
+    std::cout << "\n6. Testing invalid arguments..." << std::endl;
+    try {
+        TablebaseConfig big;
+        big.N = 5;
+        big.K = 4;
+        Tablebase::build(big);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    try {
+        TablebaseConfig bad;
+        bad.N = 3;
+        bad.K = 4;
+        Tablebase::build(bad);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    try {
+        BoardState wrong{std::vector<int>(16, 0), 4};
+        t3.probe(wrong);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    std::cout << "✓ Invalid arguments rejected" << std::endl;
+
+    // Test 7: Mapped lookups match the built tables
+    std::cout << "\n7. Testing MappedTablebase lookups..." << std::endl;
+    const std::string path3 = "test_tablebase_map_3x3.bin";
+    const std::string path4 = "test_tablebase_map_4x4.bin";
+    t3.save(path3);
+    t4.save(path4);
+    auto mapped3 = std::make_shared<const MappedTablebase>(path3);
+    auto mapped4 = std::make_shared<const MappedTablebase>(path4);
+    assert(mapped3->get_board_size() == 3 && mapped3->get_win_length() == 3);
+    assert(mapped4->size() == t4.size() && mapped4->get_num_reachable() == t4.get_num_reachable());
+    for (uint64_t i = 0; i < t3.size(); ++i) {
+        assert(mapped3->at(i).packed == t3.at(i).packed && mapped3->at(i).move == t3.at(i).move);
+    }
+    for (const std::vector<int>& cells : reachable) {
+        assert(mapped3->probe(BoardState{cells, 3}).packed == t3.probe(BoardState{cells, 3}).packed);
+    }
+    CounterRng pick(4);
+    for (uint32_t k = 0; k < 100000; ++k) {
+        const uint64_t i = pick.below(static_cast<uint32_t>(t4.size()), k, 0);
+        assert(mapped4->at(i).packed == t4.at(i).packed && mapped4->at(i).move == t4.at(i).move);
+    }
+    try {
+        MappedTablebase missing("no_such_tablebase.bin");
+        assert(false);
+    } catch (const std::runtime_error& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    std::cout << "✓ Every 3x3 slot and 100000 random 4x4 slots agree with the in-memory tables" << std::endl;
+
+    // Test 8: One mapping shared by forked worker processes
+    std::cout << "\n8. Testing lookups from forked processes..." << std::endl;
+    std::vector<pid_t> children;
+    for (int c = 0; c < 2; ++c) {
+        pid_t pid = fork();
+        assert(pid >= 0);
+        if (pid == 0) {
+            // The child reads the parent's mapping; the built table is its private reference
+            int mismatches = 0;
+            for (uint64_t i = c; i < t4.size(); i += 97) {
+                mismatches += mapped4->at(i).packed != t4.at(i).packed;
+            }
+            MappedTablebase own(path4);
+            mismatches += own.probe(BoardState{std::vector<int>(16, 0), 4}).packed != t4.at(0).packed;
+            _exit(mismatches == 0 ? 0 : 1);
+        }
+        children.push_back(pid);
+    }
+    for (pid_t pid : children) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+    std::cout << "✓ Two worker processes read the shared read-only table" << std::endl;
+
+    // Test 9: TablebaseAgent plays perfectly
+    std::cout << "\n9. Testing TablebaseAgent..." << std::endl;
+    auto oracle3 = std::make_shared<TablebaseAgent>(mapped3);
+    auto oracle4 = std::make_shared<TablebaseAgent>(mapped4);
+    auto random = std::make_shared<RandomAgent>();
+    auto count_outcomes = [](std::shared_ptr<const Agent> first, std::shared_ptr<const Agent> second, int N,
+                             int games, int& first_wins, int& second_wins) {
+        first_wins = 0;
+        second_wins = 0;
+        MatchRunnerConfig match_config;
+        match_config.N = N;
+        match_config.num_threads = 2;
+        match_config.games_per_thread = 16;
+        run_matches({first, second}, games, match_config, [](uint64_t) { return Match{0, 1}; },
+                    [&](int, uint64_t, const Match&, int8_t outcome) {
+                        first_wins += outcome == OUTCOME_PLAYER1_WIN;
+                        second_wins += outcome == OUTCOME_PLAYER2_WIN;
+                    });
+    };
+    int first_wins, second_wins;
+    count_outcomes(oracle3, std::make_shared<SolverAgent>(), 3, 50, first_wins, second_wins);
+    assert(first_wins == 0 && second_wins == 0);
+    count_outcomes(random, oracle3, 3, 200, first_wins, second_wins);
+    assert(first_wins == 0 && second_wins > 100);
+    count_outcomes(oracle4, random, 4, 200, first_wins, second_wins);
+    assert(second_wins == 0 && first_wins > 100);
+    count_outcomes(oracle4, oracle4, 4, 20, first_wins, second_wins);
+    assert(first_wins == 0 && second_wins == 0);
+    try {
+        Environment wrong_size(5, std::make_shared<DefaultReward>());
+        wrong_size.reset();
+        const Environment* e = &wrong_size;
+        RngStream s(pick, 0, 0);
+        int32_t move;
+        TablebaseAgent(mapped4).act(&e, &s, 1, &move);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    std::cout << "✓ Draws the exact solver, never loses to random play on 3x3 or 4x4" << std::endl;
+    std::remove(path3.c_str());
+    std::remove(path4.c_str());
+
+    std::cout << "\n=== ALL TABLEBASE TESTS PASSED! ===" << std::endl;
+    return 0;
+}
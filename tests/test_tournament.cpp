@@ -0,0 +1,146 @@
+#include <iostream>
+#include "../include/environment.h"
+#include "../include/agent.h"
+#include "../include/match_runner.h"
+#include "../include/tournament.h"
+#include "test_helpers.h"
+#include <cmath>
+#include <memory>
+#include <cassert>
+#include <vector>
+
+int choose(Agent& agent, const Environment& env, uint32_t stream = 0) {
+    CounterRng rng(3);
+    RngStream s(rng, stream, 0);
+    const Environment* e = &env;
+    int32_t action;
+    agent.act(&e, &s, 1, &action);
+    return action;
+}
+
+int main() {
+    std::cout << "=== Testing Evaluation Tournament ===" << std::endl;
+    auto random = std::make_shared<RandomAgent>();
+    auto solver = std::make_shared<SolverAgent>();
+    auto mcts = std::make_shared<MCTSAgent>(200);
+
+    // Test 1: Solver is perfect on 3x3
+    std::cout << "\n1. Testing SolverAgent..." << std::endl;
+    SolverAgent exact;
+    assert(choose(exact, position(3, {0, 3, 1, 4})) == 2);     // win on the top row
+    assert(choose(exact, position(3, {0, 4, 1})) == 2);        // block the top row
+    SolverAgent shallow(2);
+    assert(choose(shallow, position(5, {0, 5, 1, 6, 2, 7, 3, 8})) == 4);
+    Tally vs_random = play(solver, random, 3, 200);
+    Tally as_second = play(random, solver, 3, 200);
+    Tally mirror = play(solver, solver, 3, 50);
+    assert(vs_random.second_wins == 0 && as_second.first_wins == 0);
+    assert(mirror.draws == 50);
+    std::cout << "✓ Solver never loses (" << vs_random.first_wins << "/200 wins as X, "
+              << as_second.second_wins << "/200 as O) and draws itself" << std::endl;
+
+    // Test 2: MCTS finds tactics and beats random play
+    std::cout << "\n2. Testing MCTSAgent..." << std::endl;
+    MCTSAgent search(400);
+    assert(choose(search, position(3, {0, 3, 1, 4})) == 2);
+    for (uint32_t s = 0; s < 10; ++s) {
+        assert(choose(search, position(3, {0, 4, 1}), s) == 2);
+    }
+    Tally mcts_vs_random = play(mcts, random, 3, 200);
+    assert(mcts_vs_random.first_wins > 150 && mcts_vs_random.second_wins < 10);
+    std::cout << "✓ MCTS wins " << mcts_vs_random.first_wins << "/200 against random" << std::endl;
+
+    // Test 3: Rating fit
+    std::cout << "\n3. Testing Elo fit..." << std::endl;
+    std::vector<double> ci;
+    std::vector<double> elo = fit_elo({0.0, 750.0, 250.0, 0.0}, {0.0, 1000.0, 1000.0, 0.0}, 2, ci);
+    assert(std::fabs((elo[0] + elo[1]) / 2 - 1500.0) < 1e-6);
+    assert(std::fabs(elo[0] - elo[1] - 190.8) < 2.0);  // 75% expected score
+    assert(ci[0] > 15.0 && ci[0] < 30.0 && std::fabs(ci[0] - ci[1]) < 1e-9);
+    std::vector<double> wide_ci;
+    fit_elo({0.0, 75.0, 25.0, 0.0}, {0.0, 100.0, 100.0, 0.0}, 2, wide_ci);
+    assert(wide_ci[0] > 2.5 * ci[0]);  // 10x fewer games, ~3x wider interval
+    std::cout << "✓ 75% score = " << elo[0] - elo[1] << " Elo, +/- " << ci[0] << std::endl;
+
+    // Test 4: Round robin with early stopping
+    std::cout << "\n4. Testing round-robin tournament..." << std::endl;
+    Layer policy{LayerType::Dense, Activation::None, 18, 9, std::vector<float>(9 * 18, 0.0f), std::vector<float>(9, 0.0f)};
+    Layer value{LayerType::Dense, Activation::None, 18, 1, std::vector<float>(18, 0.0f), std::vector<float>(1, 0.0f)};
+    policy.bias = {2, 0, 2, 0, 4, 0, 2, 0, 2};  // centre, then corners
+    auto network = std::make_shared<const PolicyNetwork>(3, std::vector<Layer>{}, policy, value);
+
+    TournamentConfig config;
+    config.board_sizes = {3};
+    config.games_per_pairing = 40;
+    config.max_rounds = 40;
+    config.target_ci = 120.0;
+    config.num_threads = 2;
+    config.seed = 9;
+    Tournament round_robin(config);
+    round_robin.add_agent("random", random);
+    round_robin.add_agent("policy", std::make_shared<PolicyAgent>(network));
+    round_robin.add_agent("mcts", mcts);
+    round_robin.add_agent("solver", solver);
+    std::vector<TournamentResult> results = round_robin.run();
+    assert(results.size() == 1 && results[0].N == 3);
+    const TournamentResult& rr = results[0];
+    assert(rr.converged && rr.rounds < config.max_rounds);
+    assert(rr.ratings.back().name == "random");
+    assert(rr.ratings.front().name == "solver" || rr.ratings.front().name == "mcts");
+    for (const Rating& r : rr.ratings) {
+        assert(r.ci95 <= config.target_ci);
+        assert(r.games == static_cast<uint64_t>(rr.rounds) * 3 * config.games_per_pairing);
+        std::cout << "  " << r.name << ": " << r.elo << " +/- " << r.ci95 << " (score " << r.score << ")" << std::endl;
+    }
+    std::cout << "✓ Converged after " << rr.rounds << " rounds" << std::endl;
+
+    // Test 5: Swiss events on several board sizes at once
+    std::cout << "\n5. Testing Swiss tournament across board sizes..." << std::endl;
+    config.board_sizes = {3, 5, 10};
+    config.format = TournamentFormat::Swiss;
+    config.games_per_pairing = 20;
+    config.max_rounds = 6;
+    config.target_ci = 0.0;  // never converges: play every round
+    Tournament swiss(config);
+    swiss.add_agent("random", random);
+    swiss.add_agent("random-2", random);
+    swiss.add_agent("mcts", std::make_shared<MCTSAgent>(100), {3, 5});
+    swiss.add_agent("solver", solver, {3});
+    swiss.add_agent("lookahead", std::make_shared<SolverAgent>(1), {5, 10});
+    results = swiss.run();
+    assert(results.size() == 3);
+    assert(results[0].N == 3 && results[1].N == 5 && results[2].N == 10);
+    assert(results[0].ratings.size() == 4 && results[1].ratings.size() == 4 && results[2].ratings.size() == 3);
+    for (const TournamentResult& r : results) {
+        assert(r.rounds == 6 && !r.converged);
+        uint64_t games = 0;
+        for (const Rating& rating : r.ratings) games += rating.games;
+        // Two pairings per round with 4 agents, one with 3 (one agent sits out)
+        assert(games == 2 * static_cast<uint64_t>(6) * (r.ratings.size() == 4 ? 2 : 1) * config.games_per_pairing);
+        std::cout << "  N=" << r.N << ": leader " << r.ratings.front().name << " at " << r.ratings.front().elo << std::endl;
+    }
+    assert(results[0].ratings.back().name.compare(0, 6, "random") == 0);
+    std::cout << "✓ Board sizes 3, 5 and 10 rated independently" << std::endl;
+
+    // Test 6: Invalid configuration
+    std::cout << "\n6. Testing invalid arguments..." << std::endl;
+    try {
+        TournamentConfig bad;
+        bad.board_sizes.clear();
+        Tournament t(bad);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    try {
+        Tournament t(TournamentConfig{});
+        t.add_agent("none", nullptr);
+        assert(false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Caught expected exception: " << e.what() << std::endl;
+    }
+    std::cout << "✓ Invalid arguments rejected" << std::endl;
+
+    std::cout << "\n=== ALL TOURNAMENT TESTS PASSED! ===" << std::endl;
+    return 0;
+}
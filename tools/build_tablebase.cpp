@@ -0,0 +1,47 @@
+// Solves every reachable position of a small board and writes the value table.
+//
+//   build_tablebase <N> <output file> [K] [threads]
+//
+// K is the number of stones in a row needed to win (default N, the Environment rule).
+
+#include "tablebase.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv) {
+    if (argc < 3 || argc > 5) {
+        std::cerr << "usage: " << argv[0] << " <N> <output file> [K] [threads]" << std::endl;
+        return 2;
+    }
+    TablebaseConfig config;
+    try {
+        config.N = std::stoi(argv[1]);
+        if (argc > 3) config.K = std::stoi(argv[3]);
+        if (argc > 4) config.num_threads = std::stoi(argv[4]);
+    } catch (const std::exception&) {
+        std::cerr << "N, K and threads must be integers" << std::endl;
+        return 2;
+    }
+
+    try {
+        const auto start = std::chrono::steady_clock::now();
+        Tablebase table = Tablebase::build(config);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        table.save(argv[2]);
+
+        const TablebaseEntry& root = table.at(0);
+        const char* names[] = {"draw", "win", "loss"};
+        std::cout << table.get_board_size() << "x" << table.get_board_size() << ", " << table.get_win_length()
+                  << " in a row: " << table.get_num_reachable() << " reachable of " << table.size()
+                  << " indexed positions, solved in " << seconds << " s" << std::endl;
+        std::cout << "Empty board: " << names[static_cast<int>(root.outcome())] << " for X in "
+                  << root.distance() << " plies, best first move " << static_cast<int>(root.move) << std::endl;
+        std::cout << "Wrote " << argv[2] << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}